@@ -0,0 +1,103 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+struct ArenaBlock {
+    ArenaBlock* next;   // bloc précédent
+    size_t size;        // octets utilisables dans data
+    size_t used;
+    unsigned char* data;
+};
+
+static ArenaBlock* block_new(size_t size) {
+    // l'en-tête et les données dans une seule allocation, données alignées sur ARENA_ALIGN
+    ArenaBlock* block = malloc(sizeof(ArenaBlock) + size + ARENA_ALIGN);
+    if (!block) {
+        printf("Erreur : memoire insuffisante (%zu octets demandes)\n", size);
+        return NULL;
+    }
+    uintptr_t start = (uintptr_t)(block + 1);
+    start = (start + ARENA_ALIGN - 1) & ~(uintptr_t)(ARENA_ALIGN - 1);
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    block->data = (unsigned char*)start;
+    return block;
+}
+
+//découper size octets dans l'arène (alignés sur ARENA_ALIGN), NULL si la mémoire manque
+void* arena_alloc(Arena* arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    ArenaBlock* block = arena->blocks;
+    if (!block || block->size - block->used < size) {
+        size_t minimum = arena->block_size ? arena->block_size : ARENA_DEFAULT_BLOCK;
+        // blocs de taille croissante : peu de blocs même si l'arène grossit beaucoup
+        size_t wanted = block && block->size * 2 > minimum ? block->size * 2 : minimum;
+        block = block_new(size > wanted ? size : wanted);
+        if (!block) {
+            return NULL;
+        }
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+    void* p = block->data + block->used;
+    block->used += size;
+    return p;
+}
+
+void* arena_calloc(Arena* arena, size_t count, size_t size) {
+    void* p = arena_alloc(arena, count * size);
+    if (p) {
+        memset(p, 0, count * size);
+    }
+    return p;
+}
+
+//mémoriser la position courante
+ArenaMark arena_mark(const Arena* arena) {
+    ArenaMark mark = {arena->blocks, arena->blocks ? arena->blocks->used : 0};
+    return mark;
+}
+
+//libérer tout ce qui a été alloué depuis la marque
+void arena_rewind(Arena* arena, ArenaMark mark) {
+    while (arena->blocks && arena->blocks != mark.block) {
+        ArenaBlock* next = arena->blocks->next;
+        free(arena->blocks);
+        arena->blocks = next;
+    }
+    if (arena->blocks) {
+        arena->blocks->used = mark.used;
+    }
+}
+
+//tout libérer en gardant la mémoire : les blocs sont fusionnés en un seul de même capacité totale,
+//pour qu'un niveau de même taille que le précédent tienne sans nouvelle allocation
+void arena_reset(Arena* arena) {
+    if (!arena->blocks) {
+        return;
+    }
+    if (!arena->blocks->next) {
+        arena->blocks->used = 0;
+        return;
+    }
+    size_t total = arena_capacity(arena);
+    arena_free(arena);
+    arena->blocks = block_new(total);
+}
+
+//rendre toute la mémoire de l'arène
+void arena_free(Arena* arena) {
+    arena_rewind(arena, (ArenaMark){NULL, 0});
+}
+
+//capacité totale des blocs de l'arène
+size_t arena_capacity(const Arena* arena) {
+    size_t total = 0;
+    for (const ArenaBlock* block = arena->blocks; block; block = block->next) {
+        total += block->size;
+    }
+    return total;
+}
@@ -0,0 +1,35 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Allocateur par blocs : les allocations sont découpées à la suite dans de grands blocs
+// et libérées toutes ensemble. arena_reset() rend la mémoire réutilisable sans la rendre
+// au système (un seul bloc est gardé, à la taille totale utilisée), arena_free() libère tout.
+// Une arène n'est pas partagée entre threads.
+
+#define ARENA_ALIGN 64           // alignement de chaque allocation (ligne de cache)
+#define ARENA_DEFAULT_BLOCK 4096 // taille minimale d'un bloc
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    ArenaBlock* blocks;   // bloc courant en tête de liste
+    size_t block_size;    // taille minimale des nouveaux blocs (0 : ARENA_DEFAULT_BLOCK)
+} Arena;
+
+// Position dans une arène, pour libérer d'un coup tout ce qui a été alloué ensuite
+typedef struct {
+    ArenaBlock* block;
+    size_t used;
+} ArenaMark;
+
+void* arena_alloc(Arena* arena, size_t size);
+void* arena_calloc(Arena* arena, size_t count, size_t size);
+ArenaMark arena_mark(const Arena* arena);
+void arena_rewind(Arena* arena, ArenaMark mark);
+void arena_reset(Arena* arena);
+void arena_free(Arena* arena);
+size_t arena_capacity(const Arena* arena);
+
+#endif
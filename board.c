@@ -0,0 +1,332 @@
+#include <stdlib.h>
+#include <string.h>
+#include "board.h"
+#include "stats.h"
+#include "trace.h"
+
+size_t tile_memory = TILE_DEFAULT_MEMORY;
+
+//bit d'une case dans les mots d'occupation des petites grilles
+static uint64_t cell_bit(int x, int y) {
+    return (uint64_t)1 << (x * BITBOARD_MAX_SIZE + y);
+}
+
+static int count_bits(uint64_t bits) {
+    int count = 0;
+    for (; bits; bits &= bits - 1) {
+        count++;
+    }
+    return count;
+}
+
+//libérer le niveau courant : la mémoire de l'arène est gardée pour le suivant
+static void release_level(Board* board) {
+    if (board->tiles) {
+        tiles_close(board->tiles);
+        board->tiles = NULL;
+    }
+    arena_reset(&board->arena);
+    free(board->adopted);
+    board->adopted = NULL;
+    board->grid = NULL;
+    board->chain_grid = NULL;
+    board->kinds = NULL;
+    board->occupied = NULL;
+    board->morton = NULL;
+    board->values = NULL;
+    board->chains = NULL;
+    board->bitboard = false;
+}
+
+//couche des chaînes et nombre de cases rangées, pour les parcours complets
+static int* chain_layer(const Board* board, size_t* cells) {
+    if (board->morton) {
+        *cells = board->morton->cells;
+        return board->chains;
+    }
+    *cells = (size_t)board->size * board->size;
+    return board->chain_grid[0];
+}
+
+//grande grille : couches en ordre de Morton, cases des blocs complétés vides
+static void allocate_morton(Board* board, int size, const int* values) {
+    MortonLayout* layout = arena_alloc(&board->arena, sizeof(MortonLayout));
+    morton_init(layout, size, &board->arena);
+    board->morton = layout;
+    board->values = arena_alloc(&board->arena, layout->cells * sizeof(int));
+    board->chains = arena_calloc(&board->arena, layout->cells, sizeof(int));
+    board->kinds = arena_alloc(&board->arena, layout->cells);
+    board->occupied = arena_calloc(&board->arena, layout->cells, 1);
+    memset(board->kinds, -1, layout->cells);
+    for (size_t c = 0; c < layout->cells; c++) {
+        board->values[c] = -1;
+    }
+    for (int x = 0; x < size; x++) {
+        for (int y = 0; y < size; y++) {
+            int value = values[(size_t)x * size + y];
+            uint32_t i = morton_index(layout, x, y);
+            board->values[i] = value;
+            board->kinds[i] = (int8_t)(value > 0 ? 1 : value < 0 ? -1 : 0);
+        }
+    }
+}
+
+//installer une grille dans l'arène du niveau, qui remplace d'un coup le niveau précédent ;
+//les valeurs (ligne par ligne) sont recopiées, ou reprises telles quelles si adopted
+static void install_grids(Board* board, int size, const int* values, int* adopted) {
+    release_level(board);
+    size_t cells = (size_t)size * size;
+    board->size = size;
+    board->scan = board_scan_best();
+    board->required_bits = 0;
+    board->occupied_bits = 0;
+    if (size > BITBOARD_MAX_SIZE && morton_wanted(size)) {
+        allocate_morton(board, size, values);
+        return;
+    }
+    board->grid = arena_alloc(&board->arena, size * sizeof(int*));
+    board->chain_grid = arena_alloc(&board->arena, size * sizeof(int*));
+    int* copy = adopted ? adopted : arena_alloc(&board->arena, cells * sizeof(int));
+    board->adopted = adopted;
+    int* chains = arena_calloc(&board->arena, cells, sizeof(int));
+    board->kinds = arena_alloc(&board->arena, cells);
+    board->occupied = arena_calloc(&board->arena, cells, 1);
+    board->bitboard = size <= BITBOARD_MAX_SIZE;
+
+    if (!adopted) {
+        memcpy(copy, values, cells * sizeof(int));
+    }
+    for (int i = 0; i < size; i++) {
+        board->grid[i] = copy + (size_t)i * size;
+        board->chain_grid[i] = chains + (size_t)i * size;
+    }
+    for (size_t c = 0; c < cells; c++) {
+        board->kinds[c] = (int8_t)(copy[c] > 0 ? 1 : copy[c] < 0 ? -1 : 0);
+        if (board->bitboard && copy[c] > 0) {
+            board->required_bits |= cell_bit((int)c / size, (int)c % size);
+        }
+    }
+}
+
+void allocate_grids(Board* board, int size, const int* values) {
+    install_grids(board, size, values, NULL);
+}
+
+//installer un niveau en reprenant son bloc de valeurs, sans copie ; le niveau est vidé.
+//Les grandes grilles sont rangées en ordre de Morton : le bloc est recopié puis libéré.
+void board_adopt_level(Board* board, Level* level) {
+    if (level->size > BITBOARD_MAX_SIZE && morton_wanted(level->size)) {
+        allocate_grids(board, level->size, level->values);
+        level_free(level);
+        return;
+    }
+    install_grids(board, level->size, level->values, level->values);
+    level->values = NULL;
+    level->size = 0;
+}
+
+//libérer la mémoire allouée pour les grilles
+void free_grids(Board* board) {
+    release_level(board);
+    arena_free(&board->arena);
+}
+
+//installer une copie d'un niveau comme grille de jeu
+void board_from_level(Board* board, const Level* level) {
+    allocate_grids(board, level->size, level->values);
+}
+
+//recopier valeurs et chaînes ligne par ligne (N*N entiers de 32 bits chacune), quel que soit
+//le rangement ; les destinations n'ont pas à être alignées (sauvegardes)
+void board_copy_layers(const Board* board, void* values, void* chains) {
+    int n = board->size;
+    if (!board->morton) {
+        memcpy(values, board->grid[0], (size_t)n * n * sizeof(int32_t));
+        memcpy(chains, board->chain_grid[0], (size_t)n * n * sizeof(int32_t));
+        return;
+    }
+    unsigned char* value_out = values;
+    unsigned char* chain_out = chains;
+    for (int x = 0; x < n; x++) {
+        for (int y = 0; y < n; y++) {
+            uint32_t i = morton_index(board->morton, x, y);
+            size_t at = ((size_t)x * n + y) * sizeof(int32_t);
+            memcpy(value_out + at, &board->values[i], sizeof(int32_t));
+            memcpy(chain_out + at, &board->chains[i], sizeof(int32_t));
+        }
+    }
+}
+
+//ouvrir une grille tuilée depuis un fichier déjà ouvert (dont la grille devient propriétaire)
+bool board_open_tiled(Board* board, FILE* file, size_t memory_cap) {
+    TileStore* tiles = tiles_open_file(file, memory_cap);
+    if (!tiles) {
+        return false;
+    }
+    release_level(board);
+    board->tiles = tiles;
+    board->size = tiles_size(tiles);
+    return true;
+}
+
+//   charger une grille à partir d'un fichier
+bool load_grid(Board* board, const char* filename) {
+    printf("Tentative d'ouverture du fichier: %s\n", filename);
+    STAT_TIMER_START(load_start);
+    TRACE_START(load_trace);
+    if (tiles_is_tiled_file(filename)) {
+        release_level(board); // une grille tuilée garde un fichier ouvert : la fermer avant d'en ouvrir une autre
+        board->tiles = tiles_open(filename, tile_memory);
+        if (!board->tiles) {
+            return false;
+        }
+        board->size = tiles_size(board->tiles);
+        char error[160];
+        if (!tiles_validate(board->tiles, error, sizeof(error))) {
+            printf("Attention : %s\n", error);
+        }
+        STAT_ADD(STAT_LEVELS_LOADED, 1);
+        STAT_TIMER_RECORD(load_start, STAT_LEVEL_LOAD_NS, STAT_LEVEL_LOAD_MAX_NS);
+        TRACE_END(load_trace, TRACE_LEVEL_LOAD);
+        return true;
+    }
+
+    Level level;
+    char error[160];
+    if (!level_load_file(filename, &level, error, sizeof(error))) {
+        printf("%s\n", error);
+        return false;
+    }
+    if (!level_validate(&level, error, sizeof(error))) {
+        printf("Attention : %s\n", error);
+    }
+    board_adopt_level(board, &level);
+    STAT_ADD(STAT_LEVELS_LOADED, 1);
+    STAT_TIMER_RECORD(load_start, STAT_LEVEL_LOAD_NS, STAT_LEVEL_LOAD_MAX_NS);
+    TRACE_END(load_trace, TRACE_LEVEL_LOAD);
+    return true;
+}
+
+//lire la valeur d'une case
+int cell_value(const Board* board, int x, int y) {
+    if (board->morton) {
+        return board->values[morton_index(board->morton, x, y)];
+    }
+    return board->tiles ? tiles_value(board->tiles, x, y) : board->grid[x][y];
+}
+
+//lire le numéro de chaîne d'une case (0 si libre)
+int cell_chain(const Board* board, int x, int y) {
+    if (board->morton) {
+        return board->chains[morton_index(board->morton, x, y)];
+    }
+    return board->tiles ? tiles_chain(board->tiles, x, y) : board->chain_grid[x][y];
+}
+
+//affecter une case à une chaîne (0 pour la libérer)
+void set_cell_chain(Board* board, int x, int y, int chain) {
+    if (board->morton) {
+        uint32_t i = morton_index(board->morton, x, y);
+        board->chains[i] = chain;
+        board->occupied[i] = chain != 0;
+    } else if (board->tiles) {
+        tiles_set_chain(board->tiles, x, y, chain);
+    } else {
+        board->chain_grid[x][y] = chain;
+        board->occupied[(size_t)x * board->size + y] = chain != 0;
+        if (board->bitboard) {
+            board->occupied_bits = chain ? board->occupied_bits | cell_bit(x, y) : board->occupied_bits & ~cell_bit(x, y);
+        }
+    }
+}
+
+//verifier si les coordonnées sont dans les limites de la grille
+bool is_within_bounds(const Board* board, int x, int y) {
+    return x >= 0 && x < board->size && y >= 0 && y < board->size;
+}
+
+//vérifier si un mouvement est valide
+bool is_valid_move(const Board* board, int start_x, int start_y, int dest_x, int dest_y) {
+    TRACE_START(move_trace);
+    MoveCheck check = check_move(board, start_x, start_y, dest_x, dest_y);
+    TRACE_END_ARG(move_trace, TRACE_MOVE_CHECK, check);
+    STAT_ADD(STAT_MOVES_ACCEPTED + check, 1); // compteurs rangés dans l'ordre de MoveCheck
+    return check == MOVE_OK;
+}
+
+//déterminer pourquoi un mouvement est refusé (MOVE_OK s'il est valide)
+MoveCheck check_move(const Board* board, int start_x, int start_y, int dest_x, int dest_y) {
+    if (!((start_x == dest_x && start_y != dest_y) || (start_x != dest_x && start_y == dest_y))) {
+        return MOVE_NOT_ALIGNED;
+    }
+    if (!is_within_bounds(board, dest_x, dest_y)) {
+        return MOVE_OUT_OF_BOUNDS;
+    }
+    int dest_value = cell_value(board, dest_x, dest_y);
+    if (dest_value == -1) {
+        return MOVE_VOID;
+    }
+    if (cell_chain(board, dest_x, dest_y) != 0) {
+        return MOVE_OCCUPIED;
+    }
+    int start_value = cell_value(board, start_x, start_y);
+    if (dest_value < start_value && start_value != 0) {
+        return MOVE_DECREASING;
+    }
+    return MOVE_OK;
+}
+
+//   effacer une chaîne de la grille
+void erase_chain(Board* board, int chain_id) {
+    if (board->tiles) {
+        tiles_erase_chain(board->tiles, chain_id);
+        return;
+    }
+    if (board->bitboard) {
+        // seules les cases à couvrir déjà occupées peuvent être libérées
+        uint64_t candidates = board->occupied_bits & board->required_bits;
+        for (int x = 0; x < board->size; x++) {
+            for (int y = 0; y < board->size; y++) {
+                if ((candidates & cell_bit(x, y)) && board->chain_grid[x][y] == chain_id) {
+                    set_cell_chain(board, x, y, 0);
+                }
+            }
+        }
+        return;
+    }
+    size_t cells;
+    int* chains = chain_layer(board, &cells);
+    board->scan->erase_chain(chains, board->occupied, board->kinds, cells, chain_id);
+}
+
+//   réinitialiser le niveau
+void reset_level(Board* board) {
+    if (board->tiles) {
+        tiles_reset(board->tiles);
+        return;
+    }
+    board->occupied_bits = 0;
+    size_t cells;
+    int* chains = chain_layer(board, &cells);
+    board->scan->clear(chains, board->occupied, cells);
+}
+
+//compter les cases à couvrir encore libres
+size_t uncovered_cells(const Board* board) {
+    if (board->tiles) {
+        return tiles_uncovered(board->tiles);
+    }
+    if (board->bitboard) {
+        return (size_t)count_bits(board->required_bits & ~board->occupied_bits);
+    }
+    size_t cells = board->morton ? board->morton->cells : (size_t)board->size * board->size;
+    return board->scan->count_uncovered(board->kinds, board->occupied, cells);
+}
+
+//   vérifier si le joueur a gagné
+bool check_victory(const Board* board) {
+    TRACE_START(victory_trace);
+    bool won = board->bitboard ? (board->required_bits & ~board->occupied_bits) == 0 : uncovered_cells(board) == 0;
+    TRACE_END_ARG(victory_trace, TRACE_VICTORY_CHECK, won);
+    return won;
+}
@@ -0,0 +1,71 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "arena.h"
+#include "boardscan.h"
+#include "level.h"
+#include "morton.h"
+#include "tiles.h"
+
+// Résultat de la vérification d'un mouvement
+typedef enum {
+    MOVE_OK,
+    MOVE_NOT_ALIGNED,    // ni même ligne ni même colonne
+    MOVE_OUT_OF_BOUNDS,  // hors de la grille
+    MOVE_VOID,           // case vide (-1)
+    MOVE_OCCUPIED,       // case déjà prise par une chaîne
+    MOVE_DECREASING      // valeur inférieure à celle de départ
+} MoveCheck;
+
+// Grille de jeu : valeur de chaque case et numéro de la chaîne qui l'occupe.
+// Une grille dense garde aussi deux couches d'octets (nature et occupation des cases)
+// pour les parcours vectorisés ; jusqu'à 8x8, l'occupation tient aussi dans un mot de 64 bits
+// (bit x*8+y). Une grande grille (morton != NULL) range ses quatre couches en ordre de Morton
+// (morton.h) : grid et chain_grid sont alors NULL et les cases passent par values et chains.
+// Une grille tuilée (tiles != NULL) lit ses couches à la demande.
+typedef struct {
+    int size;          // N
+    int** grid;
+    int** chain_grid;
+    int8_t* kinds;     // -1 vide, 0 départ, 1 à couvrir
+    uint8_t* occupied; // 1 si chain_grid != 0
+    MortonLayout* morton;
+    int* values;       // ordre de Morton seulement
+    int* chains;
+    const BoardScan* scan;
+    bool bitboard;     // choisi au chargement quand N <= BITBOARD_MAX_SIZE
+    uint64_t required_bits;
+    uint64_t occupied_bits;
+    TileStore* tiles;
+    int* adopted;      // valeurs reprises d'un niveau (board_adopt_level), hors de l'arène
+    Arena arena;       // mémoire du niveau courant (couches, historique des mouvements)
+} Board;
+
+#define BITBOARD_MAX_SIZE 8
+
+extern size_t tile_memory; // Plafond mémoire des grilles tuilées
+
+void allocate_grids(Board* board, int size, const int* values);
+void board_adopt_level(Board* board, Level* level);
+void free_grids(Board* board);
+bool load_grid(Board* board, const char* filename);
+void board_from_level(Board* board, const Level* level);
+void board_copy_layers(const Board* board, void* values, void* chains);
+bool board_open_tiled(Board* board, FILE* file, size_t memory_cap);
+
+int cell_value(const Board* board, int x, int y);
+int cell_chain(const Board* board, int x, int y);
+void set_cell_chain(Board* board, int x, int y, int chain);
+bool is_within_bounds(const Board* board, int x, int y);
+MoveCheck check_move(const Board* board, int start_x, int start_y, int dest_x, int dest_y);
+bool is_valid_move(const Board* board, int start_x, int start_y, int dest_x, int dest_y);
+size_t uncovered_cells(const Board* board);
+bool check_victory(const Board* board);
+void erase_chain(Board* board, int chain_id);
+void reset_level(Board* board);
+
+#endif
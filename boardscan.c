@@ -0,0 +1,155 @@
+#include <string.h>
+#include "boardscan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BOARDSCAN_X86 1
+#include <immintrin.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Version scalaire (référence, et seule version hors x86)
+// ---------------------------------------------------------------------------
+
+static size_t scalar_count_uncovered(const int8_t* kinds, const uint8_t* occupied, size_t count) {
+    size_t uncovered = 0;
+    for (size_t i = 0; i < count; i++) {
+        uncovered += kinds[i] > 0 && !occupied[i];
+    }
+    return uncovered;
+}
+
+static void scalar_erase_chain(int* chains, uint8_t* occupied, const int8_t* kinds, size_t count, int chain_id) {
+    for (size_t i = 0; i < count; i++) {
+        if (chains[i] == chain_id && kinds[i] > 0) {
+            chains[i] = 0;
+            occupied[i] = 0;
+        }
+    }
+}
+
+// memset de la libc est déjà vectorisé (et passe en écritures non temporelles sur les
+// grandes grilles) : les variantes SIMD le réutilisent plutôt que de le réécrire
+static void scalar_clear(int* chains, uint8_t* occupied, size_t count) {
+    memset(chains, 0, count * sizeof(int));
+    memset(occupied, 0, count);
+}
+
+static const BoardScan scalar_scan = {"scalaire", scalar_count_uncovered, scalar_erase_chain, scalar_clear};
+
+#ifdef BOARDSCAN_X86
+
+// ---------------------------------------------------------------------------
+// SSE2 : 16 cases par itération
+// ---------------------------------------------------------------------------
+
+__attribute__((target("sse2")))
+static size_t sse2_count_uncovered(const int8_t* kinds, const uint8_t* occupied, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t uncovered = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i required = _mm_cmpgt_epi8(_mm_loadu_si128((const __m128i*)(kinds + i)), zero);
+        __m128i free_cells = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(occupied + i)), zero);
+        uncovered += (size_t)__builtin_popcount((unsigned)_mm_movemask_epi8(_mm_and_si128(required, free_cells)));
+    }
+    return uncovered + scalar_count_uncovered(kinds + i, occupied + i, count - i);
+}
+
+__attribute__((target("sse2")))
+static void sse2_erase_chain(int* chains, uint8_t* occupied, const int8_t* kinds, size_t count, int chain_id) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i id = _mm_set1_epi32(chain_id);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        // masque « à couvrir » élargi d'un octet à 32 bits par case
+        __m128i required = _mm_cmpgt_epi8(_mm_loadu_si128((const __m128i*)(kinds + i)), zero);
+        __m128i low = _mm_unpacklo_epi8(required, required);
+        __m128i high = _mm_unpackhi_epi8(required, required);
+        __m128i wide[4] = {_mm_unpacklo_epi16(low, low), _mm_unpackhi_epi16(low, low),
+                           _mm_unpacklo_epi16(high, high), _mm_unpackhi_epi16(high, high)};
+        __m128i hit[4];
+        for (int k = 0; k < 4; k++) {
+            __m128i* p = (__m128i*)(chains + i + 4 * k);
+            __m128i c = _mm_loadu_si128(p);
+            hit[k] = _mm_and_si128(_mm_cmpeq_epi32(c, id), wide[k]);
+            _mm_storeu_si128(p, _mm_andnot_si128(hit[k], c));
+        }
+        // masques recompactés en octets pour libérer la couche d'occupation
+        __m128i hit8 = _mm_packs_epi16(_mm_packs_epi32(hit[0], hit[1]), _mm_packs_epi32(hit[2], hit[3]));
+        __m128i* o = (__m128i*)(occupied + i);
+        _mm_storeu_si128(o, _mm_andnot_si128(hit8, _mm_loadu_si128(o)));
+    }
+    scalar_erase_chain(chains + i, occupied + i, kinds + i, count - i, chain_id);
+}
+
+static const BoardScan sse2_scan = {"sse2", sse2_count_uncovered, sse2_erase_chain, scalar_clear};
+
+// ---------------------------------------------------------------------------
+// AVX2 : 32 cases par itération (8 pour l'effacement, qui compare les numéros 32 bits)
+// ---------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+static size_t avx2_count_uncovered(const int8_t* kinds, const uint8_t* occupied, size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    size_t uncovered = 0;
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i required = _mm256_cmpgt_epi8(_mm256_loadu_si256((const __m256i*)(kinds + i)), zero);
+        __m256i free_cells = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(occupied + i)), zero);
+        uncovered += (size_t)__builtin_popcount((unsigned)_mm256_movemask_epi8(_mm256_and_si256(required, free_cells)));
+    }
+    return uncovered + sse2_count_uncovered(kinds + i, occupied + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void avx2_erase_chain(int* chains, uint8_t* occupied, const int8_t* kinds, size_t count, int chain_id) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i id = _mm256_set1_epi32(chain_id);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i* p = (__m256i*)(chains + i);
+        __m256i c = _mm256_loadu_si256(p);
+        __m256i hit = _mm256_cmpeq_epi32(c, id);
+        if (_mm256_testz_si256(hit, hit)) {
+            continue; // cas le plus fréquent : aucune case de la chaîne dans ce bloc
+        }
+        __m256i kind = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(kinds + i)));
+        hit = _mm256_and_si256(hit, _mm256_cmpgt_epi32(kind, zero));
+        _mm256_storeu_si256(p, _mm256_andnot_si256(hit, c));
+        unsigned bits = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(hit));
+        while (bits) {
+            occupied[i + (size_t)__builtin_ctz(bits)] = 0;
+            bits &= bits - 1;
+        }
+    }
+    scalar_erase_chain(chains + i, occupied + i, kinds + i, count - i, chain_id);
+}
+
+static const BoardScan avx2_scan = {"avx2", avx2_count_uncovered, avx2_erase_chain, scalar_clear};
+
+#endif
+
+//lister les variantes utilisables sur ce processeur, de la plus simple à la plus large
+int board_scan_supported(const BoardScan** list, int max) {
+    int count = 0;
+    if (count < max) {
+        list[count++] = &scalar_scan;
+    }
+#ifdef BOARDSCAN_X86
+    __builtin_cpu_init();
+    if (count < max && __builtin_cpu_supports("sse2")) {
+        list[count++] = &sse2_scan;
+    }
+    if (count < max && __builtin_cpu_supports("avx2")) {
+        list[count++] = &avx2_scan;
+    }
+#endif
+    return count;
+}
+
+//choisir la variante la plus large disponible
+const BoardScan* board_scan_best(void) {
+    const BoardScan* list[3];
+    int count = board_scan_supported(list, 3);
+    return list[count - 1];
+}
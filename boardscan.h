@@ -0,0 +1,24 @@
+#ifndef BOARDSCAN_H
+#define BOARDSCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Parcours complets d'une grille dense, sur des couches contiguës :
+//   kinds    : -1 case vide, 0 départ, 1 case à couvrir (int8)
+//   occupied : 1 si la case appartient à une chaîne (uint8)
+//   chains   : numéro de chaîne de chaque case (int, les numéros dépassent 127)
+// Une variante SSE2/AVX2 est choisie à l'exécution selon le processeur,
+// avec une version scalaire partout ailleurs.
+
+typedef struct {
+    const char* name;
+    size_t (*count_uncovered)(const int8_t* kinds, const uint8_t* occupied, size_t count);
+    void (*erase_chain)(int* chains, uint8_t* occupied, const int8_t* kinds, size_t count, int chain_id);
+    void (*clear)(int* chains, uint8_t* occupied, size_t count);
+} BoardScan;
+
+const BoardScan* board_scan_best(void);
+int board_scan_supported(const BoardScan** list, int max);
+
+#endif
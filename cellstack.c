@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cellstack.h"
+
+//vider la pile et choisir la largeur des indices pour une grille de taille grid_size
+void cell_stack_reset(CellStack* s, int grid_size) {
+    unsigned char width = (uint64_t)grid_size * grid_size < 0xFFFF ? 2 : 4;
+    if (width != s->width || s->arena) {
+        // les données déjà allouées ne sont plus interprétables (ou l'arène a été vidée) : on repart de zéro
+        if (!s->arena) {
+            free(s->data);
+        }
+        s->data = NULL;
+        s->capacity = 0;
+        s->width = width;
+    }
+    s->count = 0;
+}
+
+//libérer la mémoire de la pile
+void cell_stack_free(CellStack* s) {
+    if (!s->arena) {
+        free(s->data);
+    }
+    s->data = NULL;
+    s->count = 0;
+    s->capacity = 0;
+}
+
+//ne garder que les count premiers éléments (la mémoire reste réservée)
+void cell_stack_truncate(CellStack* s, size_t count) {
+    if (count < s->count) {
+        s->count = count;
+    }
+}
+
+//agrandir la pile (croissance géométrique : push en O(1) amorti)
+static bool cell_stack_reserve(CellStack* s, size_t needed) {
+    if (needed <= s->capacity) {
+        return true;
+    }
+    size_t capacity = s->capacity ? s->capacity : 64;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    void* data;
+    if (s->arena) {
+        // pas de realloc dans une arène : l'ancien tableau reste perdu jusqu'au prochain arena_reset()
+        data = arena_alloc(s->arena, capacity * s->width);
+        if (data && s->count) {
+            memcpy(data, s->data, s->count * s->width);
+        }
+    } else {
+        data = realloc(s->data, capacity * s->width);
+    }
+    if (!data) {
+        printf("Erreur : memoire insuffisante pour l'historique des mouvements\n");
+        return false; // la pile existante reste intacte
+    }
+    s->data = data;
+    s->capacity = capacity;
+    return true;
+}
+
+static uint32_t cell_stack_read(const CellStack* s, size_t i) {
+    if (s->width == 2) {
+        uint16_t v = ((const uint16_t*)s->data)[i];
+        return v == UINT16_MAX ? NO_CELL : v;
+    }
+    return ((const uint32_t*)s->data)[i];
+}
+
+static void cell_stack_write(CellStack* s, size_t i, uint32_t cell) {
+    if (s->width == 2) {
+        ((uint16_t*)s->data)[i] = cell == NO_CELL ? UINT16_MAX : (uint16_t)cell;
+    } else {
+        ((uint32_t*)s->data)[i] = cell;
+    }
+}
+
+//empiler un indice de case
+bool cell_stack_push(CellStack* s, uint32_t cell) {
+    if (s->width == 0) {
+        s->width = 4; // pile jamais initialisée : indices 32 bits par défaut
+    }
+    if (!cell_stack_reserve(s, s->count + 1)) {
+        return false;
+    }
+    cell_stack_write(s, s->count++, cell);
+    return true;
+}
+
+//dépiler un indice de case (NO_CELL si la pile est vide)
+uint32_t cell_stack_pop(CellStack* s) {
+    if (s->count == 0) {
+        return NO_CELL;
+    }
+    return cell_stack_read(s, --s->count);
+}
+
+//lire le sommet de la pile sans le retirer
+uint32_t cell_stack_top(const CellStack* s) {
+    return s->count ? cell_stack_read(s, s->count - 1) : NO_CELL;
+}
+
+//lire l'élément i (NO_CELL s'il n'existe pas)
+uint32_t cell_stack_get(const CellStack* s, size_t i) {
+    return i < s->count ? cell_stack_read(s, i) : NO_CELL;
+}
+
+//écrire l'élément i, en complétant avec NO_CELL si le tableau est trop court
+bool cell_stack_set(CellStack* s, size_t i, uint32_t cell) {
+    if (s->width == 0) {
+        s->width = 4;
+    }
+    if (i >= s->count) {
+        if (!cell_stack_reserve(s, i + 1)) {
+            return false;
+        }
+        while (s->count <= i) {
+            cell_stack_write(s, s->count++, NO_CELL);
+        }
+    }
+    cell_stack_write(s, i, cell);
+    return true;
+}
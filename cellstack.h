@@ -0,0 +1,34 @@
+#ifndef CELLSTACK_H
+#define CELLSTACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+
+// Indice "aucune case" (chaîne sans tête, pile vide)
+#define NO_CELL UINT32_MAX
+
+// Tableau extensible d'indices de cases (x * N + y).
+// Les indices sont stockés sur 16 bits tant que la grille a moins de 65535 cases,
+// sur 32 bits au-delà : une partie ne coûte que ce qu'elle utilise.
+// Une pile rattachée à une arène y prend sa mémoire : elle est alors libérée avec l'arène,
+// et cell_stack_reset() doit être appelé après chaque arena_reset().
+typedef struct {
+    void* data;
+    size_t count;
+    size_t capacity;
+    unsigned char width; // 2 ou 4 octets par indice
+    Arena* arena;        // NULL : malloc/realloc
+} CellStack;
+
+void cell_stack_reset(CellStack* s, int grid_size);
+void cell_stack_free(CellStack* s);
+void cell_stack_truncate(CellStack* s, size_t count);
+bool cell_stack_push(CellStack* s, uint32_t cell);
+uint32_t cell_stack_pop(CellStack* s);
+uint32_t cell_stack_top(const CellStack* s);
+uint32_t cell_stack_get(const CellStack* s, size_t i);
+bool cell_stack_set(CellStack* s, size_t i, uint32_t cell);
+
+#endif
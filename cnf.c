@@ -0,0 +1,350 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cnf.h"
+#include "sat.h"
+#include "trace.h"
+
+// Ordre des directions : celui des commandes N, S, E, O de play_game()
+static const int dir_dx[4] = {-1, 1, 0, 0};
+static const int dir_dy[4] = {0, 0, 1, -1};
+
+static bool add_clause(LevelCnf* cnf, const int* lits, int count) {
+    if (cnf->lit_count + (size_t)count + 1 > cnf->capacity) {
+        size_t capacity = cnf->capacity ? cnf->capacity * 2 : 1024;
+        while (capacity < cnf->lit_count + (size_t)count + 1) {
+            capacity *= 2;
+        }
+        int* lits_new = realloc(cnf->lits, capacity * sizeof(int));
+        if (!lits_new) {
+            return false;
+        }
+        cnf->lits = lits_new;
+        cnf->capacity = capacity;
+    }
+    memcpy(cnf->lits + cnf->lit_count, lits, (size_t)count * sizeof(int));
+    cnf->lit_count += (size_t)count;
+    cnf->lits[cnf->lit_count++] = 0;
+    cnf->clause_count++;
+    return true;
+}
+
+static bool add2(LevelCnf* cnf, int a, int b) {
+    int lits[2] = {a, b};
+    return add_clause(cnf, lits, 2);
+}
+
+static bool add3(LevelCnf* cnf, int a, int b, int c) {
+    int lits[3] = {a, b, c};
+    return add_clause(cnf, lits, 3);
+}
+
+//au plus une des variables (deux à deux : jamais plus de 4)
+static bool at_most_one(LevelCnf* cnf, const int* vars, int count) {
+    bool ok = true;
+    for (int i = 0; i < count; i++) {
+        for (int j = i + 1; j < count; j++) {
+            ok = ok && add2(cnf, -vars[i], -vars[j]);
+        }
+    }
+    return ok;
+}
+
+//rang unaire dans une composante de m cases de même valeur :
+//ge(i, k) = "le rang de la i-ème case est au moins k" (k = 1..m-1), chaque arête interne l'augmente
+static bool encode_ladder(LevelCnf* cnf, const int* cells, int m, const int* component, const int* local,
+                          const int (*out)[4]) {
+    int base = cnf->var_count;
+    cnf->var_count += m * (m - 1);
+    #define GE(i, k) (base + (i) * (m - 1) + (k))
+    bool ok = true;
+    for (int i = 0; i < m && ok; i++) {
+        for (int k = 1; k + 1 < m; k++) {
+            ok = ok && add2(cnf, -GE(i, k + 1), GE(i, k));
+        }
+        int u = cells[i];
+        for (int d = 0; d < 4 && ok; d++) {
+            int e = out[u][d];
+            if (!e || component[cnf->edge_to[e - 1]] != component[u]) {
+                continue;
+            }
+            int j = local[cnf->edge_to[e - 1]];
+            ok = add2(cnf, -e, GE(j, 1)) && add2(cnf, -e, -GE(i, m - 1));
+            for (int k = 1; k + 1 < m && ok; k++) {
+                ok = add3(cnf, -e, -GE(i, k), GE(j, k + 1));
+            }
+        }
+    }
+    #undef GE
+    return ok;
+}
+
+//coder un niveau ; ladder_max = 0 : toutes les composantes sont codées par rangs
+bool cnf_encode_level(const Level* level, int ladder_max, LevelCnf* cnf) {
+    int n = level->size;
+    int cells = n * n;
+    const int* values = level->values;
+    memset(cnf, 0, sizeof(*cnf));
+    int (*out)[4] = calloc((size_t)cells, sizeof(*out));   // variable de l'arête sortante, 0 si aucune
+    int (*in)[4] = calloc((size_t)cells, sizeof(*in));
+    int* in_count = calloc((size_t)cells, sizeof(int));
+    int* component = malloc((size_t)cells * sizeof(int));
+    int* local = malloc((size_t)cells * sizeof(int));
+    int* queue = malloc((size_t)cells * sizeof(int));
+    cnf->edge_from = malloc((size_t)cells * 4 * sizeof(int));
+    cnf->edge_to = malloc((size_t)cells * 4 * sizeof(int));
+    bool ok = out && in && in_count && component && local && queue && cnf->edge_from && cnf->edge_to;
+
+    for (int u = 0; u < cells && ok; u++) {
+        if (values[u] == -1) {
+            continue;
+        }
+        for (int d = 0; d < 4; d++) {
+            int x = u / n + dir_dx[d], y = u % n + dir_dy[d];
+            if (x < 0 || x >= n || y < 0 || y >= n) {
+                continue;
+            }
+            int v = x * n + y;
+            if (values[v] != -1 && (values[u] == 0 || values[v] >= values[u])) {
+                int e = ++cnf->edge_count;
+                cnf->edge_from[e - 1] = u;
+                cnf->edge_to[e - 1] = v;
+                out[u][d] = e;
+                in[v][in_count[v]++] = e;
+            }
+        }
+    }
+    cnf->var_count = cnf->edge_count;
+
+    for (int u = 0; u < cells && ok; u++) {
+        if (values[u] == -1) {
+            continue;
+        }
+        int outs[4], out_count = 0;
+        for (int d = 0; d < 4; d++) {
+            if (out[u][d]) {
+                outs[out_count++] = out[u][d];
+            }
+        }
+        ok = at_most_one(cnf, in[u], in_count[u]) && at_most_one(cnf, outs, out_count);
+        if (ok && values[u] > 0) {
+            ok = add_clause(cnf, in[u], in_count[u]); // case à couvrir (vide : niveau insoluble)
+        }
+        for (int i = 0; ok && values[u] == 0 && i < in_count[u]; i++) {
+            // une chaîne qui entre sur un 'x' doit en ressortir
+            int clause[5] = {-in[u][i]};
+            memcpy(clause + 1, outs, (size_t)out_count * sizeof(int));
+            ok = add_clause(cnf, clause, out_count + 1);
+        }
+        for (int d = 0; ok && d < 4; d++) {
+            // aller-retour entre deux voisins de même valeur (cycle de deux cases)
+            int v = out[u][d] ? cnf->edge_to[out[u][d] - 1] : -1;
+            if (v > u && out[v][d ^ 1]) {
+                ok = add2(cnf, -out[u][d], -out[v][d ^ 1]);
+            }
+        }
+    }
+
+    // composantes de cases voisines de même valeur : les seules où un cycle est possible
+    for (int c = 0; c < cells; c++) {
+        component[c] = -1;
+    }
+    for (int c = 0; c < cells && ok; c++) {
+        if (values[c] == -1 || component[c] >= 0) {
+            continue;
+        }
+        int m = 0;
+        queue[m++] = c;
+        component[c] = c;
+        for (int head = 0; head < m; head++) {
+            int u = queue[head];
+            local[u] = head;
+            for (int d = 0; d < 4; d++) {
+                int x = u / n + dir_dx[d], y = u % n + dir_dy[d];
+                int v = x * n + y;
+                if (x >= 0 && x < n && y >= 0 && y < n && component[v] < 0 && values[v] == values[c]) {
+                    component[v] = c;
+                    queue[m++] = v;
+                }
+            }
+        }
+        if (m < 4) {
+            continue; // un cycle sur la grille passe par au moins 4 cases
+        }
+        if (ladder_max > 0 && m > ladder_max) {
+            cnf->lazy_components++;
+        } else {
+            ok = encode_ladder(cnf, queue, m, component, local, (const int (*)[4])out);
+        }
+    }
+
+    free(out);
+    free(in);
+    free(in_count);
+    free(component);
+    free(local);
+    free(queue);
+    if (!ok) {
+        printf("Erreur : memoire insuffisante pour coder le niveau en CNF\n");
+        cnf_free(cnf);
+    }
+    return ok;
+}
+
+void cnf_free(LevelCnf* cnf) {
+    free(cnf->lits);
+    free(cnf->edge_from);
+    free(cnf->edge_to);
+    memset(cnf, 0, sizeof(*cnf));
+}
+
+//écrire la formule au format DIMACS, avec la correspondance variables -> arêtes en commentaire
+bool cnf_write_dimacs(const LevelCnf* cnf, const Level* level, const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        printf("Erreur : Impossible de creer le fichier %s\n", filename);
+        return false;
+    }
+    int n = level->size;
+    fprintf(file, "c CardinalChain : niveau %dx%d\n", n, n);
+    fprintf(file, "c variables 1..%d : aretes \"e var x1 y1 x2 y2\" (une chaine avance de (x1 y1) a (x2 y2))\n",
+            cnf->edge_count);
+    fprintf(file, "c variables %d..%d : rangs des composantes de meme valeur\n", cnf->edge_count + 1, cnf->var_count);
+    if (cnf->lazy_components > 0) {
+        fprintf(file, "c attention : %d composante(s) sans rangs, les cycles n'y sont pas exclus\n",
+                cnf->lazy_components);
+    }
+    for (int e = 0; e < cnf->edge_count; e++) {
+        fprintf(file, "c e %d %d %d %d %d\n", e + 1, cnf->edge_from[e] / n, cnf->edge_from[e] % n,
+                cnf->edge_to[e] / n, cnf->edge_to[e] % n);
+    }
+    fprintf(file, "p cnf %d %zu\n", cnf->var_count, cnf->clause_count);
+    for (size_t i = 0; i < cnf->lit_count; i++) {
+        fprintf(file, cnf->lits[i] ? "%d " : "%d\n", cnf->lits[i]);
+    }
+    bool ok = !ferror(file);
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        printf("Erreur d'ecriture de %s\n", filename);
+    }
+    return ok;
+}
+
+//chercher les cycles de la solution (hors des chaînes parties d'un 'x') et les interdire
+static int cut_cycles(SatSolver* sat, const int* next, const int* edge_of, int cells,
+                      uint8_t* mark) {
+    int cuts = 0;
+    memset(mark, 0, (size_t)cells);
+    for (int c = 0; c < cells; c++) {
+        if (next[c] >= 0 && !edge_of[c]) {
+            for (int u = c; u >= 0; u = next[u]) {
+                mark[u] = 1; // chaîne partie de c
+            }
+        }
+    }
+    int* clause = malloc((size_t)cells * sizeof(int));
+    for (int c = 0; c < cells && clause; c++) {
+        if (mark[c] || !edge_of[c]) {
+            continue;
+        }
+        int count = 0;
+        for (int u = c; !mark[u]; u = next[u]) {
+            mark[u] = 1;
+            clause[count++] = -edge_of[next[u]];
+        }
+        sat_add_clause(sat, clause, count);
+        cuts++;
+    }
+    free(clause);
+    return cuts;
+}
+
+//résoudre un niveau par le solveur SAT ; les solutions comptées sont des ensembles de chaînes
+//distincts, chacune couvrant au moins une case
+void solve_level_sat(const Level* level, const SolveOptions* options, SolveResult* result) {
+    int n = level->size;
+    int cells = n * n;
+    LevelCnf cnf;
+    TRACE_START(encode_trace);
+    if (!cnf_encode_level(level, CNF_LADDER_MAX, &cnf)) {
+        result->status = SOLVE_CANCELLED;
+        return;
+    }
+    SatSolver* sat = sat_new(cnf.var_count);
+    int* next = malloc((size_t)cells * sizeof(int));      // case suivante dans la solution, -1 si aucune
+    int* edge_of = malloc((size_t)cells * sizeof(int));   // arête entrante de chaque case, 0 si aucune
+    int* blocking = malloc(((size_t)cnf.edge_count + 1) * sizeof(int));
+    uint8_t* mark = malloc((size_t)cells);
+    if (!sat || !next || !edge_of || !blocking || !mark) {
+        result->status = SOLVE_CANCELLED;
+        cells = 0;
+    }
+    for (size_t i = 0, start = 0; cells && i < cnf.lit_count; i++) {
+        if (cnf.lits[i] == 0) {
+            sat_add_clause(sat, cnf.lits + start, (int)(i - start));
+            start = i + 1;
+        }
+    }
+    TRACE_END(encode_trace, TRACE_SAT_ENCODE);
+
+    TRACE_START(sat_trace);
+    while (cells) {
+        unsigned long long used = sat_decisions(sat);
+        if (options->max_nodes && used >= options->max_nodes) {
+            result->status = SOLVE_CANCELLED;
+            break;
+        }
+        SatResult r = sat_solve(sat, options->cancel, options->max_nodes ? options->max_nodes - used : 0);
+        if (r == SAT_UNKNOWN) {
+            result->status = SOLVE_CANCELLED;
+            break;
+        }
+        if (r == SAT_UNSATISFIABLE) {
+            break;
+        }
+        for (int c = 0; c < cells; c++) {
+            next[c] = -1;
+            edge_of[c] = 0;
+        }
+        for (int e = 1; e <= cnf.edge_count; e++) {
+            blocking[e - 1] = sat_model_value(sat, e) ? -e : e;
+            if (sat_model_value(sat, e)) {
+                next[cnf.edge_from[e - 1]] = cnf.edge_to[e - 1];
+                edge_of[cnf.edge_to[e - 1]] = e;
+            }
+        }
+        if (cut_cycles(sat, next, edge_of, cells, mark) > 0) {
+            continue;
+        }
+
+        if (result->solutions++ == 0) {
+            // chaînes dans l'ordre de leur départ, comme la recherche
+            cell_stack_reset(&result->path, n);
+            for (int c = 0; c < cells; c++) {
+                if (next[c] >= 0 && !edge_of[c]) {
+                    cell_stack_push(&result->path, NO_CELL);
+                    for (int u = c; u >= 0; u = next[u]) {
+                        cell_stack_push(&result->path, (uint32_t)u);
+                    }
+                }
+            }
+        }
+        if (result->solutions >= options->max_solutions) {
+            break;
+        }
+        // exclure exactement cet ensemble d'arêtes
+        if (!sat_add_clause(sat, blocking, cnf.edge_count)) {
+            break;
+        }
+    }
+
+    result->nodes = sat ? sat_decisions(sat) : 0;
+    TRACE_END_ARG(sat_trace, TRACE_SAT_SOLVE, result->nodes);
+    sat_free(sat);
+    free(next);
+    free(edge_of);
+    free(blocking);
+    free(mark);
+    cnf_free(&cnf);
+}
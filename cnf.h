@@ -0,0 +1,40 @@
+#ifndef CNF_H
+#define CNF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "level.h"
+#include "solver.h"
+
+// Codage d'un niveau en formule CNF.
+// Une variable par arête orientée u -> v entre cases voisines non vides, quand une chaîne
+// peut avancer de u à v (is_valid_move() : valeur de v >= valeur de u, ou u est un 'x') :
+//   - chaque case non nulle a exactement une arête entrante ;
+//   - chaque case a au plus une arête entrante et au plus une sortante ;
+//   - une chaîne ne s'arrête pas sur un 'x' (toute chaîne couvre au moins une case) ;
+//   - pas de cycle : seules des cases voisines de même valeur peuvent en former un.
+//     Chaque composante de même valeur reçoit un rang unaire strictement croissant le long
+//     des arêtes ; au-delà de ladder_max cases le rang coûterait trop cher et les cycles
+//     sont exclus pendant la résolution, par une clause par cycle trouvé.
+// Les chaînes partent des 'x' sans arête entrante.
+
+#define CNF_LADDER_MAX 64   // taille maximale d'une composante codée par rangs dans le solveur intégré
+
+typedef struct {
+    int var_count;
+    int* lits;            // clauses à la suite, chacune terminée par 0 (comme en DIMACS)
+    size_t lit_count;
+    size_t capacity;
+    size_t clause_count;
+    int edge_count;       // variables 1..edge_count : arêtes
+    int* edge_from;       // case de départ et d'arrivée de chaque arête (indice x * N + y)
+    int* edge_to;
+    int lazy_components;  // composantes dont les cycles restent à exclure pendant la résolution
+} LevelCnf;
+
+bool cnf_encode_level(const Level* level, int ladder_max, LevelCnf* cnf);
+void cnf_free(LevelCnf* cnf);
+bool cnf_write_dimacs(const LevelCnf* cnf, const Level* level, const char* filename);
+void solve_level_sat(const Level* level, const SolveOptions* options, SolveResult* result);
+
+#endif
@@ -0,0 +1,641 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "board.h"
+#include "cellstack.h"
+#include "diffcheck.h"
+#include "level.h"
+#include "rng.h"
+#include "solver.h"
+#include "stats.h"
+
+#define STEPS_PER_LEVEL 4000
+#define HISTORY_SIZE 32
+#define MAX_ENGINES 8
+#define SOLVER_NODES 40000  // noeuds par comparaison des moteurs de recherche (coupes comprises)
+#define LAYOUT_NODES 20000  // noeuds par comparaison des rangements (une heuristique par niveau)
+
+// ---------------------------------------------------------------------------
+// Moteur de référence : copie figée des règles d'origine sur des tableaux int**.
+// Ne pas optimiser : c'est l'étalon auquel les autres moteurs sont comparés.
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    int N;
+    int** grid;
+    int** chain_grid;
+} RefBoard;
+
+static bool ref_is_within_bounds(RefBoard* r, int x, int y) {
+    return x >= 0 && x < r->N && y >= 0 && y < r->N;
+}
+
+static bool ref_is_valid_move(RefBoard* r, int start_x, int start_y, int dest_x, int dest_y) {
+    int** grid = r->grid;
+    int** chain_grid = r->chain_grid;
+    if ((start_x == dest_x && start_y != dest_y) || (start_x != dest_x && start_y == dest_y)) {
+        if (ref_is_within_bounds(r, dest_x, dest_y)) {
+            if (grid[dest_x][dest_y] != -1 &&
+                chain_grid[dest_x][dest_y] == 0 &&
+                (grid[dest_x][dest_y] >= grid[start_x][start_y] || grid[start_x][start_y] == 0)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void ref_erase_chain(RefBoard* r, int chain_id) {
+    for (int i = 0; i < r->N; i++) {
+        for (int j = 0; j < r->N; j++) {
+            if (r->chain_grid[i][j] == chain_id && r->grid[i][j] != -1 && r->grid[i][j] != 0) {
+                r->chain_grid[i][j] = 0;
+            }
+        }
+    }
+}
+
+static void ref_reset_level(RefBoard* r) {
+    for (int i = 0; i < r->N; i++) {
+        for (int j = 0; j < r->N; j++) {
+            r->chain_grid[i][j] = 0;
+        }
+    }
+}
+
+static bool ref_check_victory(RefBoard* r) {
+    for (int i = 0; i < r->N; i++) {
+        for (int j = 0; j < r->N; j++) {
+            if (r->grid[i][j] != -1 && r->grid[i][j] != 0 && r->chain_grid[i][j] == 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static size_t ref_uncovered(RefBoard* r) {
+    size_t uncovered = 0;
+    for (int i = 0; i < r->N; i++) {
+        for (int j = 0; j < r->N; j++) {
+            uncovered += r->grid[i][j] > 0 && r->chain_grid[i][j] == 0;
+        }
+    }
+    return uncovered;
+}
+
+static RefBoard* ref_open(const Level* level) {
+    RefBoard* r = malloc(sizeof(RefBoard));
+    r->N = level->size;
+    r->grid = malloc(r->N * sizeof(int*));
+    r->chain_grid = malloc(r->N * sizeof(int*));
+    for (int i = 0; i < r->N; i++) {
+        r->grid[i] = malloc(r->N * sizeof(int));
+        r->chain_grid[i] = calloc(r->N, sizeof(int));
+        for (int j = 0; j < r->N; j++) {
+            r->grid[i][j] = level_value(level, i, j);
+        }
+    }
+    return r;
+}
+
+static void ref_close(RefBoard* r) {
+    for (int i = 0; i < r->N; i++) {
+        free(r->grid[i]);
+        free(r->chain_grid[i]);
+    }
+    free(r->grid);
+    free(r->chain_grid);
+    free(r);
+}
+
+// ---------------------------------------------------------------------------
+// Interface commune des moteurs comparés
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    const char* name;
+    void* state;
+    int (*value)(void* state, int x, int y);
+    int (*chain)(void* state, int x, int y);
+    void (*set_chain)(void* state, int x, int y, int chain);
+    bool (*valid_move)(void* state, int start_x, int start_y, int dest_x, int dest_y);
+    bool (*victory)(void* state);
+    size_t (*uncovered)(void* state);
+    void (*erase)(void* state, int chain_id);
+    void (*reset)(void* state);
+    void (*close)(void* state);
+} Engine;
+
+static int ref_value_op(void* s, int x, int y) { return ((RefBoard*)s)->grid[x][y]; }
+static int ref_chain_op(void* s, int x, int y) { return ((RefBoard*)s)->chain_grid[x][y]; }
+static void ref_set_chain_op(void* s, int x, int y, int c) { ((RefBoard*)s)->chain_grid[x][y] = c; }
+static bool ref_valid_op(void* s, int sx, int sy, int dx, int dy) { return ref_is_valid_move(s, sx, sy, dx, dy); }
+static bool ref_victory_op(void* s) { return ref_check_victory(s); }
+static size_t ref_uncovered_op(void* s) { return ref_uncovered(s); }
+static void ref_erase_op(void* s, int c) { ref_erase_chain(s, c); }
+static void ref_reset_op(void* s) { ref_reset_level(s); }
+static void ref_close_op(void* s) { ref_close(s); }
+
+static int board_value_op(void* s, int x, int y) { return cell_value(s, x, y); }
+static int board_chain_op(void* s, int x, int y) { return cell_chain(s, x, y); }
+static void board_set_chain_op(void* s, int x, int y, int c) { set_cell_chain(s, x, y, c); }
+static bool board_valid_op(void* s, int sx, int sy, int dx, int dy) { return is_valid_move(s, sx, sy, dx, dy); }
+static bool board_victory_op(void* s) { return check_victory(s); }
+static size_t board_uncovered_op(void* s) { return uncovered_cells(s); }
+static void board_erase_op(void* s, int c) { erase_chain(s, c); }
+static void board_reset_op(void* s) { reset_level(s); }
+static void board_close_op(void* s) {
+    free_grids(s);
+    free(s);
+}
+
+static Engine engine_reference(const Level* level) {
+    return (Engine){"reference", ref_open(level), ref_value_op, ref_chain_op, ref_set_chain_op,
+                    ref_valid_op, ref_victory_op, ref_uncovered_op, ref_erase_op, ref_reset_op, ref_close_op};
+}
+
+static Engine engine_board(const char* name, Board* board) {
+    return (Engine){name, board, board_value_op, board_chain_op, board_set_chain_op,
+                    board_valid_op, board_victory_op, board_uncovered_op, board_erase_op, board_reset_op, board_close_op};
+}
+
+//ouvrir toutes les variantes à comparer pour un niveau (la référence en premier)
+static int open_engines(const Level* level, Engine engines[MAX_ENGINES]) {
+    static char dense_names[3][32];
+    int count = 0;
+    engines[count++] = engine_reference(level);
+
+    // une grille dense par variante de parcours disponible sur ce processeur
+    const BoardScan* scans[3];
+    int scan_count = board_scan_supported(scans, 3);
+    for (int i = 0; i < scan_count; i++) {
+        Board* dense = calloc(1, sizeof(Board));
+        board_from_level(dense, level);
+        dense->scan = scans[i];
+        dense->bitboard = false;
+        snprintf(dense_names[i], sizeof(dense_names[i]), "dense/%s", scans[i]->name);
+        engines[count++] = engine_board(dense_names[i], dense);
+    }
+
+    // grille choisie au chargement : mot de 64 bits jusqu'à 8x8
+    if (level->size <= BITBOARD_MAX_SIZE) {
+        Board* small = calloc(1, sizeof(Board));
+        board_from_level(small, level);
+        engines[count++] = engine_board("64 bits", small);
+    }
+
+    // ordre de Morton forcé quelle que soit la taille : blocs incomplets sur tous les bords
+    if (level->size > BITBOARD_MAX_SIZE) {
+        int min_size = morton_min_size;
+        morton_min_size = 1;
+        Board* morton = calloc(1, sizeof(Board));
+        board_from_level(morton, level);
+        morton_min_size = min_size;
+        engines[count++] = engine_board("morton", morton);
+    }
+
+    // tuiles de 4x4 et plafond minimal : les évictions et sauvegardes sont sollicitées
+    FILE* file = tmpfile();
+    Board* tiled = calloc(1, sizeof(Board));
+    if (file && tiles_write_level(file, level, 4) && board_open_tiled(tiled, file, 0)) {
+        engines[count++] = engine_board("tuilee", tiled);
+    } else {
+        if (file) {
+            fclose(file);
+        }
+        free(tiled);
+    }
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// Pilote : reproduit la logique de session de play_game() à partir des
+// réponses du moteur de référence, et vérifie que tous les moteurs répondent pareil
+// ---------------------------------------------------------------------------
+
+typedef enum { CMD_START, CMD_MOVE, CMD_FREE_MOVE, CMD_UNDO, CMD_ERASE, CMD_RESET, CMD_SELECT } Command;
+
+static const char* command_names[] = {"depart", "mouvement", "mouvement libre", "annuler", "effacer", "redemarrer",
+                                      "selection"};
+
+typedef struct {
+    Command command;
+    int a, b;
+} LoggedCommand;
+
+typedef struct {
+    Engine engines[MAX_ENGINES];
+    int engine_count;
+    int n;
+    int chain_counter, current_chain;
+    bool started;
+    int last_x, last_y, start_x, start_y;
+    CellStack moves;
+    CellStack heads;
+    uint32_t rng;
+    LoggedCommand history[HISTORY_SIZE];
+    long step;
+    bool failed;
+    const char* level_name;
+    int layout_checks;      // grands niveaux déjà comparés entre rangements
+} Harness;
+
+static void report_failure(Harness* h, const char* what, int x, int y, int expected, int got, int engine) {
+    if (h->failed) {
+        return;
+    }
+    h->failed = true;
+    printf("DIVERGENCE au pas %ld (%s, %dx%d) : %s", h->step, h->level_name, h->n, h->n, what);
+    if (x >= 0) {
+        printf(" en (%d, %d)", x, y);
+    }
+    printf(" : reference=%d, %s=%d\n", expected, h->engines[engine].name, got);
+    printf("Dernieres commandes :\n");
+    long first = h->step - HISTORY_SIZE + 1 > 0 ? h->step - HISTORY_SIZE + 1 : 0;
+    for (long i = first; i <= h->step; i++) {
+        const LoggedCommand* c = &h->history[i % HISTORY_SIZE];
+        printf("  %ld : %s %d %d\n", i, command_names[c->command], c->a, c->b);
+    }
+}
+
+static int read_value(Harness* h, int x, int y) {
+    int expected = h->engines[0].value(h->engines[0].state, x, y);
+    for (int e = 1; e < h->engine_count; e++) {
+        int got = h->engines[e].value(h->engines[e].state, x, y);
+        if (got != expected) {
+            report_failure(h, "valeur", x, y, expected, got, e);
+        }
+    }
+    return expected;
+}
+
+static int read_chain(Harness* h, int x, int y) {
+    int expected = h->engines[0].chain(h->engines[0].state, x, y);
+    for (int e = 1; e < h->engine_count; e++) {
+        int got = h->engines[e].chain(h->engines[e].state, x, y);
+        if (got != expected) {
+            report_failure(h, "chaine", x, y, expected, got, e);
+        }
+    }
+    return expected;
+}
+
+static bool check_valid_move(Harness* h, int sx, int sy, int dx, int dy) {
+    bool expected = h->engines[0].valid_move(h->engines[0].state, sx, sy, dx, dy);
+    for (int e = 1; e < h->engine_count; e++) {
+        bool got = h->engines[e].valid_move(h->engines[e].state, sx, sy, dx, dy);
+        if (got != expected) {
+            report_failure(h, "is_valid_move", dx, dy, expected, got, e);
+        }
+    }
+    return expected;
+}
+
+static void write_chain(Harness* h, int x, int y, int chain) {
+    for (int e = 0; e < h->engine_count; e++) {
+        h->engines[e].set_chain(h->engines[e].state, x, y, chain);
+    }
+}
+
+static void start_new_chain(Harness* h, int x, int y) {
+    h->current_chain = h->chain_counter++;
+    write_chain(h, x, y, h->current_chain);
+    h->last_x = h->start_x = x;
+    h->last_y = h->start_y = y;
+    cell_stack_push(&h->moves, (uint32_t)(x * h->n + y));
+    cell_stack_set(&h->heads, (size_t)h->current_chain, (uint32_t)(x * h->n + y));
+}
+
+//jouer une commande aléatoire sur tous les moteurs
+static void play_random_command(Harness* h) {
+    static const int dx[4] = {-1, 1, 0, 0};
+    static const int dy[4] = {0, 0, 1, -1};
+    LoggedCommand* log = &h->history[h->step % HISTORY_SIZE];
+    uint32_t dice = rng_next(&h->rng) % 100;
+    int rx = (int)(rng_next(&h->rng) % (uint32_t)(h->n + 2)) - 1; // déborde parfois de la grille
+    int ry = (int)(rng_next(&h->rng) % (uint32_t)(h->n + 2)) - 1;
+
+    if (!h->started) {
+        *log = (LoggedCommand){CMD_START, rx, ry};
+        if (ref_is_within_bounds(h->engines[0].state, rx, ry) && read_value(h, rx, ry) == 0 &&
+            read_chain(h, rx, ry) == 0) {
+            start_new_chain(h, rx, ry);
+            h->started = true;
+        }
+        return;
+    }
+
+    if (dice < 60) {
+        int d = (int)(rng_next(&h->rng) % 4);
+        int nx = h->last_x + dx[d], ny = h->last_y + dy[d];
+        *log = (LoggedCommand){CMD_MOVE, d, 0};
+        if (check_valid_move(h, h->last_x, h->last_y, nx, ny)) {
+            write_chain(h, nx, ny, h->current_chain);
+            h->last_x = nx;
+            h->last_y = ny;
+            cell_stack_push(&h->moves, (uint32_t)(nx * h->n + ny));
+            cell_stack_set(&h->heads, (size_t)h->current_chain, (uint32_t)(nx * h->n + ny));
+        }
+    } else if (dice < 66) {
+        // mouvement quelconque (non aligné, lointain, hors grille) : seule la réponse est comparée
+        *log = (LoggedCommand){CMD_FREE_MOVE, rx, ry};
+        check_valid_move(h, h->last_x, h->last_y, rx, ry);
+    } else if (dice < 78) {
+        *log = (LoggedCommand){CMD_UNDO, 0, 0};
+        if (read_value(h, h->last_x, h->last_y) != 0 && h->moves.count > 0) {
+            uint32_t cell = cell_stack_pop(&h->moves);
+            write_chain(h, (int)cell / h->n, (int)cell % h->n, 0);
+            if (h->moves.count > 0) {
+                cell = cell_stack_top(&h->moves);
+                h->last_x = (int)cell / h->n;
+                h->last_y = (int)cell % h->n;
+            } else {
+                h->last_x = h->start_x;
+                h->last_y = h->start_y;
+            }
+        }
+    } else if (dice < 81) {
+        *log = (LoggedCommand){CMD_ERASE, h->current_chain, 0};
+        for (int e = 0; e < h->engine_count; e++) {
+            h->engines[e].erase(h->engines[e].state, h->current_chain);
+        }
+        h->last_x = h->start_x;
+        h->last_y = h->start_y;
+    } else if (dice < 82) {
+        *log = (LoggedCommand){CMD_RESET, 0, 0};
+        for (int e = 0; e < h->engine_count; e++) {
+            h->engines[e].reset(h->engines[e].state);
+        }
+        h->started = false;
+        cell_stack_reset(&h->moves, h->n);
+    } else {
+        *log = (LoggedCommand){CMD_SELECT, rx, ry};
+        if (ref_is_within_bounds(h->engines[0].state, rx, ry) &&
+            (read_value(h, rx, ry) == 0 || read_chain(h, rx, ry) > 0)) {
+            int chain = read_chain(h, rx, ry);
+            if (chain > 0) {
+                h->current_chain = chain;
+                uint32_t head = cell_stack_get(&h->heads, (size_t)chain);
+                h->last_x = (int)head / h->n;
+                h->last_y = (int)head % h->n;
+            } else {
+                start_new_chain(h, rx, ry);
+            }
+        }
+    }
+}
+
+//comparer l'état complet des moteurs
+static void compare_engines(Harness* h) {
+    bool expected = h->engines[0].victory(h->engines[0].state);
+    for (int e = 1; e < h->engine_count; e++) {
+        bool got = h->engines[e].victory(h->engines[e].state);
+        if (got != expected) {
+            report_failure(h, "check_victory", -1, -1, expected, got, e);
+        }
+    }
+    size_t expected_uncovered = h->engines[0].uncovered(h->engines[0].state);
+    for (int e = 1; e < h->engine_count; e++) {
+        size_t got = h->engines[e].uncovered(h->engines[e].state);
+        if (got != expected_uncovered) {
+            report_failure(h, "cases non couvertes", -1, -1, (int)expected_uncovered, (int)got, e);
+        }
+    }
+    for (int x = 0; x < h->n && !h->failed; x++) {
+        for (int y = 0; y < h->n && !h->failed; y++) {
+            read_chain(h, x, y);
+        }
+    }
+}
+
+//générer un niveau aléatoire (rarement soluble : surtout utile pour tester les règles)
+static void random_level(Harness* h, Level* level) {
+    int n = 2 + (int)(rng_next(&h->rng) % 15);
+    level->size = n;
+    level->values = malloc((size_t)n * n * sizeof(int));
+    for (int c = 0; c < n * n; c++) {
+        uint32_t dice = rng_next(&h->rng) % 100;
+        level->values[c] = dice < 15 ? -1 : dice < 35 ? 0 : 1 + (int)(rng_next(&h->rng) % 6);
+    }
+}
+
+//comparer la recherche sur mot de 64 bits à la recherche générale (même arbre, même solution)
+static void compare_solvers(Harness* h, const Level* level, int max_solutions, MoveOrder order) {
+    SolveOptions options;
+    solve_options_default(&options);
+    options.max_solutions = max_solutions;
+    options.order = order;
+    options.max_nodes = SOLVER_NODES; // les niveaux aléatoires peuvent être très longs à épuiser
+    SolveResult fast = {0}, generic = {0};
+    solve_level(level, &options, &fast);
+    options.allow_bitboard = false;
+    solve_level(level, &options, &generic);
+
+    bool same_path = fast.path.count == generic.path.count;
+    for (size_t i = 0; same_path && fast.solutions > 0 && i < fast.path.count; i++) {
+        same_path = cell_stack_get(&fast.path, i) == cell_stack_get(&generic.path, i);
+    }
+    if (fast.status != generic.status || fast.solutions != generic.solutions || fast.nodes != generic.nodes || (fast.solutions > 0 && !same_path)) {
+        h->failed = true;
+        printf("DIVERGENCE du solveur (%s, %dx%d, ordre %s) : %d solution(s), %llu noeuds en 64 bits, "
+               "%d solution(s), %llu noeuds en general\n", h->level_name, level->size, level->size,
+               move_order_name(order), fast.solutions, fast.nodes, generic.solutions, generic.nodes);
+    }
+    solve_result_free(&fast);
+    solve_result_free(&generic);
+}
+
+//comparer la recherche générale en ordre de Morton à celle rangée ligne par ligne (même arbre)
+static void compare_layouts(Harness* h, const Level* level, MoveOrder order) {
+    SolveOptions options;
+    solve_options_default(&options);
+    options.order = order;
+    options.max_nodes = LAYOUT_NODES;
+    SolveResult rows = {0}, morton = {0};
+    int min_size = morton_min_size;
+    morton_min_size = 0;
+    solve_level(level, &options, &rows);
+    morton_min_size = 1;
+    solve_level(level, &options, &morton);
+    morton_min_size = min_size;
+
+    bool same_path = rows.path.count == morton.path.count;
+    for (size_t i = 0; same_path && rows.solutions > 0 && i < rows.path.count; i++) {
+        same_path = cell_stack_get(&rows.path, i) == cell_stack_get(&morton.path, i);
+    }
+    if (rows.status != morton.status || rows.nodes != morton.nodes || (rows.solutions > 0 && !same_path)) {
+        h->failed = true;
+        printf("DIVERGENCE du solveur (%s, %dx%d, ordre %s) : %llu noeuds par lignes, %llu en ordre de Morton\n",
+               h->level_name, level->size, level->size, move_order_name(order), rows.nodes, morton.nodes);
+    }
+    solve_result_free(&rows);
+    solve_result_free(&morton);
+}
+
+//rejouer une solution avec les règles de référence : départs sur des 'x' libres, mouvements
+//entre voisins acceptés par ref_is_valid_move(), toutes les cases couvertes à la fin
+static bool replay_solution(const Level* level, const SolveResult* result) {
+    RefBoard* r = ref_open(level);
+    int n = level->size;
+    int chain = 0;
+    int head = -1;
+    bool ok = true;
+    for (size_t i = 0; i < result->path.count && ok; i++) {
+        uint32_t cell = cell_stack_get(&result->path, i);
+        if (cell == NO_CELL) {
+            chain++;
+            head = -1;
+            continue;
+        }
+        int x = (int)cell / n, y = (int)cell % n;
+        if (head < 0) {
+            ok = chain > 0 && r->grid[x][y] == 0 && r->chain_grid[x][y] == 0;
+        } else {
+            int hx = head / n, hy = head % n;
+            ok = abs(hx - x) + abs(hy - y) == 1 && ref_is_valid_move(r, hx, hy, x, y);
+        }
+        r->chain_grid[x][y] = chain;
+        head = (int)cell;
+    }
+    ok = ok && ref_check_victory(r);
+    ref_close(r);
+    return ok;
+}
+
+//comparer le solveur SAT à la recherche : même verdict quand les deux concluent, solution jouable
+static void compare_sat(Harness* h, const Level* level) {
+    SolveOptions options;
+    solve_options_default(&options);
+    options.max_nodes = SOLVER_NODES;
+    SolveResult search = {0}, sat = {0};
+    solve_level(level, &options, &search);
+    options.engine = ENGINE_SAT;
+    options.max_nodes = 20000;
+    solve_level(level, &options, &sat);
+
+    bool concluded = search.status != SOLVE_CANCELLED && sat.status != SOLVE_CANCELLED;
+    if ((concluded && search.status != sat.status) || (sat.status == SOLVE_FOUND && !replay_solution(level, &sat))) {
+        h->failed = true;
+        printf("DIVERGENCE du solveur SAT (%s, %dx%d) : %s en recherche, %s en SAT%s\n", h->level_name,
+               level->size, level->size, search.status == SOLVE_FOUND ? "soluble" : "insoluble",
+               sat.status == SOLVE_FOUND ? "soluble" : "insoluble",
+               sat.status == SOLVE_FOUND ? " (solution SAT non valide ?)" : "");
+    }
+    solve_result_free(&search);
+    solve_result_free(&sat);
+}
+
+//générer un niveau soluble : chaînes tracées au hasard, de valeurs croissantes, le reste vide
+static void planted_level(Harness* h, Level* level) {
+    static const int dx[4] = {-1, 1, 0, 0};
+    static const int dy[4] = {0, 0, 1, -1};
+    int n = 2 + (int)(rng_next(&h->rng) % 7);
+    level->size = n;
+    level->values = malloc((size_t)n * n * sizeof(int));
+    for (int c = 0; c < n * n; c++) {
+        level->values[c] = -1;
+    }
+    for (int attempt = 0; attempt < n * n; attempt++) {
+        int x = (int)(rng_next(&h->rng) % (uint32_t)n), y = (int)(rng_next(&h->rng) % (uint32_t)n);
+        if (level->values[x * n + y] != -1) {
+            continue;
+        }
+        level->values[x * n + y] = 0;
+        int value = 0;
+        for (int length = 0; length < n * 2; length++) {
+            int d = (int)(rng_next(&h->rng) % 4);
+            int nx = x + dx[d], ny = y + dy[d];
+            if (nx < 0 || nx >= n || ny < 0 || ny >= n || level->values[nx * n + ny] != -1) {
+                break;
+            }
+            value += value == 0 ? 1 : (int)(rng_next(&h->rng) % 3);
+            level->values[nx * n + ny] = value;
+            x = nx;
+            y = ny;
+        }
+    }
+}
+
+static bool run_level(Harness* h, const Level* level, long steps) {
+    // première solution (sensible à l'ordre de parcours) pour chaque heuristique, puis test d'unicité
+    if (level->size <= BITBOARD_MAX_SIZE) {
+        for (int o = 0; o < ORDER_COUNT; o++) {
+            compare_solvers(h, level, 1, (MoveOrder)o);
+        }
+        compare_solvers(h, level, 2, ORDER_FIXED);
+    } else {
+        // une heuristique par niveau, à tour de rôle : les rangements se comparent à coût borné
+        compare_layouts(h, level, (MoveOrder)(h->layout_checks++ % ORDER_COUNT));
+    }
+    compare_sat(h, level);
+    h->n = level->size;
+    h->engine_count = open_engines(level, h->engines);
+    h->chain_counter = 1;
+    h->current_chain = 0;
+    h->started = false;
+    h->last_x = h->last_y = h->start_x = h->start_y = 0;
+    cell_stack_reset(&h->moves, h->n);
+    cell_stack_reset(&h->heads, h->n);
+
+    for (long i = 0; i < steps && !h->failed; i++, h->step++) {
+        play_random_command(h);
+        compare_engines(h);
+    }
+    for (int e = 0; e < h->engine_count; e++) {
+        h->engines[e].close(h->engines[e].state);
+    }
+    return !h->failed;
+}
+
+//lancer la vérification sur les niveaux livrés puis sur des niveaux générés
+int run_diffcheck(long steps, unsigned seed, const char* level_dir) {
+    Harness h = {0};
+    h.rng = seed ? seed : 1;
+    int levels = 0;
+    char name[64];
+    uint64_t start = stats_now_ns();
+
+    for (int number = 1; h.step < steps && !h.failed; number++) {
+        Level level;
+        char error[160];
+        char filename[256];
+        snprintf(filename, sizeof(filename), "%s/level%d.txt", level_dir, number);
+        if (!level_load_file(filename, &level, error, sizeof(error))) {
+            if (strstr(error, "Impossible d'ouvrir")) {
+                break; // fin des niveaux livrés
+            }
+            continue;
+        }
+        snprintf(name, sizeof(name), "level%d.txt", number);
+        h.level_name = name;
+        run_level(&h, &level, STEPS_PER_LEVEL);
+        level_free(&level);
+        levels++;
+    }
+    while (h.step < steps && !h.failed) {
+        Level level;
+        if (levels % 2) {
+            planted_level(&h, &level);
+        } else {
+            random_level(&h, &level);
+        }
+        snprintf(name, sizeof(name), "aleatoire #%d", levels);
+        h.level_name = name;
+        long remaining = steps - h.step;
+        run_level(&h, &level, remaining < STEPS_PER_LEVEL ? remaining : STEPS_PER_LEVEL);
+        level_free(&level);
+        levels++;
+    }
+
+    double seconds = (stats_now_ns() - start) / 1e9;
+    cell_stack_free(&h.moves);
+    cell_stack_free(&h.heads);
+    if (h.failed) {
+        printf("Graine %u : relancer avec --diffcheck %ld %u pour reproduire.\n", seed, steps, seed);
+        return 1;
+    }
+    printf("Verification differentielle : %ld pas sur %d niveaux en %.2f s (%.0f pas/s), aucune divergence.\n",
+           h.step, levels, seconds, seconds > 0 ? h.step / seconds : 0.0);
+    return 0;
+}
@@ -0,0 +1,9 @@
+#ifndef DIFFCHECK_H
+#define DIFFCHECK_H
+
+// Vérification différentielle : les mêmes séquences aléatoires de commandes sont jouées
+// sur le moteur de référence (règles d'origine) et sur chaque variante optimisée,
+// et l'état des grilles est comparé après chaque pas, sur les niveaux level_dir/levelN.txt.
+int run_diffcheck(long steps, unsigned seed, const char* level_dir);
+
+#endif
@@ -0,0 +1,491 @@
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "cellstack.h"
+#include "editor.h"
+#include "level.h"
+#include "solver.h"
+#include "stats.h"
+#include "trace.h"
+
+#define EDITOR_CACHE_SIZE 64   // verdicts gardés, par empreinte de grille
+#define EDITOR_UNDO_DEPTH 256  // modifications annulables (Z)
+#define EDITOR_MAX_NODES 2000000ULL // au-delà, la vérification est abandonnée
+
+// Verdict sur une version de la grille
+typedef struct {
+    unsigned generation;  // numéro de la modification vérifiée
+    uint64_t hash;
+    bool valid;
+    char error[160];
+    SolveStatus status;
+    int solutions;        // 2 : au moins deux solutions
+    unsigned long long nodes;
+    bool partial;         // soluble d'après la solution précédente, unicité encore en cours
+    bool cached;          // verdict repris d'une version déjà vérifiée
+} Verdict;
+
+typedef struct {
+    int x, y, value;      // ancienne valeur de la case
+} Edit;
+
+static struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool stopping;
+    Level pending;        // dernière grille demandée, protégée par lock (values NULL : aucune)
+    unsigned generation;  // numéro de pending, protégé par lock
+    atomic_bool cancel;   // vérification en cours dépassée
+    atomic_uint finished; // numéro de la dernière version vérifiée, verdict déposé ou non
+    _Atomic(Verdict*) slot; // dernier verdict, échangé sans verrou avec la saisie
+    int notify[2];        // tube : un octet par verdict déposé, pour réveiller la saisie
+    // utilisés par le thread de vérification seulement
+    Arena scratch;
+    Verdict cache[EDITOR_CACHE_SIZE];
+    int cache_next;
+    CellStack known;      // dernière solution trouvée, cases ligne par ligne
+    int known_size;
+} checker = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+};
+
+//empreinte FNV-1a d'une grille
+static uint64_t level_hash(const Level* level) {
+    uint64_t hash = 1469598103934665603ull;
+    const unsigned char* bytes = (const unsigned char*)level->values;
+    size_t length = (size_t)level->size * level->size * sizeof(int);
+    hash = (hash ^ (uint64_t)level->size) * 1099511628211ull;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+//la solution connue couvre-t-elle encore la grille ? (chaînes séparées par NO_CELL,
+//départs sur des 'x', pas vers un voisin libre de valeur >= ou depuis un départ)
+static bool solution_fits(const Level* level, const CellStack* path) {
+    int n = level->size;
+    if (checker.known_size != n || path->count == 0) {
+        return false;
+    }
+    size_t cells = (size_t)n * n;
+    bool* covered = calloc(cells, 1);
+    if (!covered) {
+        return false;
+    }
+    bool ok = true;
+    int prev = -1;
+    for (size_t i = 0; i < path->count && ok; i++) {
+        uint32_t cell = cell_stack_get(path, i);
+        if (cell == NO_CELL) {
+            prev = -1;
+            continue;
+        }
+        int value = level->values[cell];
+        if (prev < 0) {
+            ok = value == 0;
+        } else {
+            int dx = (int)cell / n - prev / n, dy = (int)cell % n - prev % n;
+            ok = dx * dx + dy * dy == 1 && value >= 0 &&
+                 (level->values[prev] == 0 || value >= level->values[prev]);
+        }
+        ok = ok && !covered[cell];
+        covered[cell] = true;
+        prev = (int)cell;
+    }
+    for (size_t c = 0; c < cells && ok; c++) {
+        ok = level->values[c] <= 0 || covered[c];
+    }
+    free(covered);
+    return ok;
+}
+
+//déposer un verdict pour la saisie (un verdict jamais lu est remplacé) et la réveiller
+static void publish(const Verdict* verdict) {
+    Verdict* copy = malloc(sizeof(Verdict));
+    if (copy) {
+        *copy = *verdict;
+        free(atomic_exchange(&checker.slot, copy));
+    } else {
+        fprintf(stderr, "Erreur : memoire insuffisante pour le verdict\n"); // la saisie est réveillée quand même
+    }
+    char byte = 1;
+    if (write(checker.notify[1], &byte, 1) < 0) {
+        // tube plein : des réveils sont déjà en attente
+    }
+}
+
+static const Verdict* find_cached(uint64_t hash) {
+    for (int i = 0; i < EDITOR_CACHE_SIZE; i++) {
+        if (checker.cache[i].hash == hash && checker.cache[i].generation) {
+            return &checker.cache[i];
+        }
+    }
+    return NULL;
+}
+
+//valider puis résoudre une version de la grille (deux solutions cherchées pour l'unicité)
+static void check_level(const Level* level, unsigned generation) {
+    Verdict verdict = {0};
+    verdict.hash = level_hash(level);
+    const Verdict* cached = find_cached(verdict.hash);
+    if (cached) {
+        verdict = *cached;
+        verdict.generation = generation;
+        verdict.cached = true;
+        publish(&verdict);
+        return;
+    }
+    verdict.generation = generation;
+    verdict.valid = level_validate(level, verdict.error, sizeof(verdict.error));
+    if (verdict.valid) {
+        if (solution_fits(level, &checker.known)) {
+            verdict.partial = true;
+            verdict.status = SOLVE_FOUND;
+            verdict.solutions = 1;
+            publish(&verdict);
+            verdict.partial = false;
+        }
+        SolveOptions options;
+        SolveResult result = {0};
+        solve_options_default(&options);
+        options.max_solutions = 2;
+        options.max_nodes = EDITOR_MAX_NODES;
+        options.cancel = &checker.cancel;
+        options.scratch = &checker.scratch;
+        verdict.status = solve_level(level, &options, &result);
+        verdict.solutions = result.solutions;
+        verdict.nodes = result.nodes;
+        if (verdict.status == SOLVE_FOUND) {
+            cell_stack_reset(&checker.known, level->size);
+            for (size_t i = 0; i < result.path.count; i++) {
+                cell_stack_push(&checker.known, cell_stack_get(&result.path, i));
+            }
+            checker.known_size = level->size;
+        }
+        solve_result_free(&result);
+        if (verdict.status == SOLVE_CANCELLED && atomic_load(&checker.cancel)) {
+            return; // dépassée : la version suivante est déjà demandée
+        }
+    }
+    checker.cache[checker.cache_next] = verdict;
+    checker.cache_next = (checker.cache_next + 1) % EDITOR_CACHE_SIZE;
+    publish(&verdict);
+}
+
+static void* checker_loop(void* arg) {
+    (void)arg;
+    trace_thread_name("verification");
+    for (;;) {
+        pthread_mutex_lock(&checker.lock);
+        while (!checker.stopping && !checker.pending.values) {
+            pthread_cond_wait(&checker.wake, &checker.lock);
+        }
+        if (checker.stopping) {
+            pthread_mutex_unlock(&checker.lock);
+            break;
+        }
+        Level level = checker.pending;
+        unsigned generation = checker.generation;
+        checker.pending.values = NULL;
+        atomic_store(&checker.cancel, false);
+        pthread_mutex_unlock(&checker.lock);
+
+        check_level(&level, generation);
+        atomic_store(&checker.finished, generation);
+        level_free(&level);
+    }
+    return NULL;
+}
+
+//demander la vérification d'une version de la grille, en interrompant la précédente
+static bool checker_submit(const Level* level, unsigned generation) {
+    size_t bytes = (size_t)level->size * level->size * sizeof(int);
+    int* values = malloc(bytes);
+    if (!values) {
+        return false;
+    }
+    memcpy(values, level->values, bytes);
+    pthread_mutex_lock(&checker.lock);
+    free(checker.pending.values); // version jamais commencée : remplacée
+    checker.pending.size = level->size;
+    checker.pending.values = values;
+    checker.generation = generation;
+    atomic_store(&checker.cancel, true);
+    pthread_cond_signal(&checker.wake);
+    pthread_mutex_unlock(&checker.lock);
+    return true;
+}
+
+static void checker_stop(void) {
+    atomic_store(&checker.cancel, true);
+    pthread_mutex_lock(&checker.lock);
+    checker.stopping = true;
+    pthread_cond_signal(&checker.wake);
+    pthread_mutex_unlock(&checker.lock);
+    pthread_join(checker.thread, NULL);
+    free(checker.pending.values);
+    free(atomic_exchange(&checker.slot, NULL));
+    cell_stack_free(&checker.known);
+    arena_free(&checker.scratch);
+    close(checker.notify[0]);
+    close(checker.notify[1]);
+}
+
+static void print_level(const Level* level) {
+    int n = level->size;
+    printf("   ");
+    for (int y = 0; y < n; y++) {
+        printf("%3d", y);
+    }
+    printf("\n");
+    for (int x = 0; x < n; x++) {
+        printf("%3d", x);
+        for (int y = 0; y < n; y++) {
+            int value = level_value(level, x, y);
+            if (value == -1) {
+                printf("  .");
+            } else if (value == 0) {
+                printf("  x");
+            } else {
+                printf("%3d", value);
+            }
+        }
+        printf("\n");
+    }
+}
+
+static void print_verdict(const Verdict* v, double elapsed_ms) {
+    printf("[%7.2f ms] ", elapsed_ms);
+    if (!v->valid) {
+        printf("non valide : %s", v->error);
+    } else if (v->partial) {
+        printf("soluble (la solution precedente couvre encore la grille), unicite en cours...");
+    } else if (v->status == SOLVE_CANCELLED) {
+        printf("%s (abandon apres %llu noeuds)", v->solutions > 0 ? "soluble, unicite non verifiee" : "indetermine",
+               v->nodes);
+    } else if (v->status == SOLVE_FOUND) {
+        printf("soluble, solution %s (%llu noeuds)", v->solutions > 1 ? "multiple" : "unique", v->nodes);
+    } else {
+        printf("aucune solution (%llu noeuds)", v->nodes);
+    }
+    printf("%s\n", v->cached ? " [deja verifie]" : "");
+    fflush(stdout);
+}
+
+// Saisie ligne par ligne lue directement sur le descripteur : le tampon de stdio cacherait
+// à poll() des lignes déjà lues
+typedef struct {
+    char data[512];
+    size_t length;
+    bool closed;
+} LineReader;
+
+//extraire une ligne complète du tampon (la dernière ligne peut manquer de '\n' en fin d'entrée)
+static bool take_line(LineReader* r, char* line, size_t size) {
+    char* end = memchr(r->data, '\n', r->length);
+    if (!end && !(r->closed && r->length > 0) && r->length < sizeof(r->data)) {
+        return false;
+    }
+    size_t used = end ? (size_t)(end - r->data) + 1 : r->length;
+    size_t copy = used < size ? used : size - 1;
+    memcpy(line, r->data, copy);
+    line[copy] = '\0';
+    memmove(r->data, r->data + used, r->length - used);
+    r->length -= used;
+    return true;
+}
+
+//état de l'affichage des verdicts, tenu par la saisie
+typedef struct {
+    unsigned generation;  // dernière version demandée
+    double submitted_ms;
+    bool done;            // verdict final de cette version affiché
+} Feedback;
+
+//afficher le verdict arrivé s'il concerne la dernière version (les autres sont dépassés)
+static void show_verdict(Feedback* feedback) {
+    char bytes[64];
+    while (read(checker.notify[0], bytes, sizeof(bytes)) > 0);
+    Verdict* verdict = atomic_exchange(&checker.slot, NULL);
+    if (verdict && verdict->generation == feedback->generation && !feedback->done) {
+        print_verdict(verdict, stats_now_ms() - feedback->submitted_ms);
+        feedback->done = !verdict->partial;
+    }
+    free(verdict);
+}
+
+//attendre une ligne en affichant les verdicts dès qu'ils arrivent ; false en fin d'entrée
+static bool wait_line(LineReader* r, Feedback* feedback, char* line, size_t size) {
+    while (!take_line(r, line, size)) {
+        if (r->closed) {
+            return false;
+        }
+        struct pollfd fds[2] = {{.fd = STDIN_FILENO, .events = POLLIN}, {.fd = checker.notify[0], .events = POLLIN}};
+        if (poll(fds, 2, -1) <= 0) {
+            continue;
+        }
+        if (fds[1].revents & POLLIN) {
+            show_verdict(feedback);
+        }
+        if (!(fds[0].revents & (POLLIN | POLLHUP))) {
+            continue;
+        }
+        ssize_t n = read(STDIN_FILENO, r->data + r->length, sizeof(r->data) - r->length);
+        if (n <= 0) {
+            r->closed = true;
+        } else {
+            r->length += (size_t)n;
+        }
+    }
+    return true;
+}
+
+static void submit(const Level* level, Feedback* feedback) {
+    feedback->generation++;
+    feedback->submitted_ms = stats_now_ms();
+    feedback->done = false;
+    if (!checker_submit(level, feedback->generation)) {
+        printf("Erreur : memoire insuffisante, version non verifiee\n");
+        feedback->done = true;
+    }
+}
+
+static void print_help(void) {
+    printf("Commandes : x y valeur (-1 vide, 0 depart 'x'), Z annuler, A afficher,\n");
+    printf("            W [fichier] enregistrer, Q quitter.\n");
+}
+
+//enregistrer la grille au format texte
+static bool save_level(const Level* level, const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        return false;
+    }
+    bool ok = level_write(file, level);
+    return fclose(file) == 0 && ok;
+}
+
+//éditer un niveau jusqu'à Q ou la fin de l'entrée
+int run_editor(const char* filename, int size) {
+    Level level;
+    char error[160];
+    if (!level_load_file(filename, &level, error, sizeof(error))) {
+        if (size <= 0) {
+            printf("%s\n", error);
+            return 1;
+        }
+        level.size = size;
+        level.values = malloc((size_t)size * size * sizeof(int));
+        if (!level.values) {
+            printf("Erreur : memoire insuffisante pour un niveau %dx%d\n", size, size);
+            return 1;
+        }
+        for (int c = 0; c < size * size; c++) {
+            level.values[c] = -1;
+        }
+        printf("Nouveau niveau %dx%d : %s\n", size, size, filename);
+    }
+    Edit* undo = malloc(EDITOR_UNDO_DEPTH * sizeof(Edit));
+    atomic_store(&checker.cancel, false);
+    atomic_store(&checker.finished, 0);
+    checker.stopping = false;
+    if (!undo || pipe(checker.notify) != 0) {
+        printf("Erreur : impossible de lancer la verification\n");
+        free(undo);
+        level_free(&level);
+        return 1;
+    }
+    fcntl(checker.notify[0], F_SETFL, O_NONBLOCK);
+    fcntl(checker.notify[1], F_SETFL, O_NONBLOCK);
+    if (pthread_create(&checker.thread, NULL, checker_loop, NULL) != 0) {
+        printf("Erreur : impossible de lancer la verification\n");
+        close(checker.notify[0]);
+        close(checker.notify[1]);
+        free(undo);
+        level_free(&level);
+        return 1;
+    }
+
+    int undo_count = 0;
+    Feedback feedback = {0};
+    LineReader reader = {0};
+    char line[128];
+    print_level(&level);
+    print_help();
+    submit(&level, &feedback);
+    fflush(stdout);
+
+    bool running = true;
+    while (running && wait_line(&reader, &feedback, line, sizeof(line))) {
+        int x, y, value;
+        char command = 0, argument[sizeof(line)] = "";
+        if (sscanf(line, "%d %d %d", &x, &y, &value) == 3) {
+            if (x < 0 || x >= level.size || y < 0 || y >= level.size || value < -1) {
+                printf("Case ou valeur invalide.\n");
+            } else if (level_value(&level, x, y) != value) {
+                if (undo_count == EDITOR_UNDO_DEPTH) {
+                    memmove(undo, undo + 1, (EDITOR_UNDO_DEPTH - 1) * sizeof(Edit));
+                    undo_count--;
+                }
+                undo[undo_count++] = (Edit){x, y, level_value(&level, x, y)};
+                level.values[x * level.size + y] = value;
+                print_level(&level);
+                submit(&level, &feedback);
+            }
+        } else if (sscanf(line, " %c %127s", &command, argument) >= 1) {
+            switch (command) {
+                case 'z': case 'Z':
+                    if (undo_count == 0) {
+                        printf("Aucune modification a annuler.\n");
+                        break;
+                    }
+                    undo_count--;
+                    level.values[undo[undo_count].x * level.size + undo[undo_count].y] = undo[undo_count].value;
+                    print_level(&level);
+                    submit(&level, &feedback);
+                    break;
+                case 'a': case 'A':
+                    print_level(&level);
+                    break;
+                case 'w': case 'W': {
+                    const char* target = argument[0] ? argument : filename;
+                    printf(save_level(&level, target) ? "Niveau enregistre dans %s\n"
+                                                      : "Erreur : impossible d'ecrire %s\n", target);
+                    break;
+                }
+                case 'q': case 'Q':
+                    running = false;
+                    break;
+                default:
+                    printf("Commande inconnue.\n");
+                    print_help();
+                    break;
+            }
+        }
+        fflush(stdout);
+    }
+    // fin de l'entrée : attendre le verdict de la dernière version, borné par EDITOR_MAX_NODES
+    // (la vérification terminée sans verdict déposé n'est pas attendue)
+    while (running && !feedback.done) {
+        bool finished = atomic_load(&checker.finished) == feedback.generation;
+        struct pollfd fd = {.fd = checker.notify[0], .events = POLLIN};
+        poll(&fd, 1, finished ? 0 : -1);
+        show_verdict(&feedback);
+        if (finished) {
+            break;
+        }
+    }
+    checker_stop();
+    free(undo);
+    level_free(&level);
+    return 0;
+}
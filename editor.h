@@ -0,0 +1,11 @@
+#ifndef EDITOR_H
+#define EDITOR_H
+
+// Éditeur de niveaux : les valeurs des cases sont modifiées sur place et, après chaque
+// modification, un thread de vérification dit en arrière-plan si le niveau reste soluble
+// et si sa solution est unique. Une vérification dépassée par une nouvelle modification
+// est interrompue ; les verdicts déjà calculés et la dernière solution trouvée sont réutilisés.
+// size : côté d'un nouveau niveau si le fichier n'existe pas encore (0 : le fichier doit exister).
+int run_editor(const char* filename, int size);
+
+#endif
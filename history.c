@@ -0,0 +1,284 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "history.h"
+
+//écrire l'état de la partie : position, piles, et chaîne de chaque case de l'historique
+static bool write_state(HistoryBuffer* b, const Session* session) {
+    bool ok = varint_put(b, session->has_started) && varint_put_signed(b, session->chain_counter) &&
+              varint_put_signed(b, session->current_chain) && varint_put_signed(b, session->last_x) &&
+              varint_put_signed(b, session->last_y) && varint_put_signed(b, session->start_x) &&
+              varint_put_signed(b, session->start_y);
+    if (!ok || !session->has_started) {
+        return ok; // niveau pas encore commencé : les piles peuvent dater du niveau précédent
+    }
+    const Board* board = &session->board;
+    uint32_t n = (uint32_t)board->size;
+    size_t count = session->moves.count;
+    ok = varint_put(b, count);
+    int64_t previous = 0;
+    for (size_t i = 0; ok && i < count; i++) {
+        // deux mouvements successifs sont souvent voisins : l'écart tient sur un octet ou deux
+        int64_t cell = cell_stack_get(&session->moves, i);
+        ok = varint_put_signed(b, cell - previous);
+        previous = cell;
+    }
+    for (size_t i = 0; ok && i < count; i++) {
+        uint32_t cell = cell_stack_get(&session->moves, i);
+        ok = varint_put(b, (uint64_t)cell_chain(board, (int)(cell / n), (int)(cell % n)));
+    }
+    ok = ok && varint_put(b, session->heads.count);
+    for (size_t i = 0; ok && i < session->heads.count; i++) {
+        uint32_t head = cell_stack_get(&session->heads, i);
+        ok = varint_put(b, head == NO_CELL ? 0 : (uint64_t)head + 1);
+    }
+    return ok;
+}
+
+//remettre la partie dans l'état écrit par write_state() (même niveau, grille chargée)
+static void read_state(Session* session, const unsigned char* p) {
+    Board* board = &session->board;
+    uint32_t n = (uint32_t)board->size;
+    // seules les cases de l'historique des mouvements peuvent être occupées
+    for (size_t i = 0; i < session->moves.count; i++) {
+        uint32_t cell = cell_stack_get(&session->moves, i);
+        if (cell_chain(board, (int)(cell / n), (int)(cell % n)) != 0) {
+            set_cell_chain(board, (int)(cell / n), (int)(cell % n), 0);
+        }
+    }
+    cell_stack_truncate(&session->moves, 0);
+    cell_stack_truncate(&session->heads, 0);
+
+    session->has_started = varint_read(&p) != 0;
+    session->chain_counter = (int)varint_read_signed(&p);
+    session->current_chain = (int)varint_read_signed(&p);
+    session->last_x = (int)varint_read_signed(&p);
+    session->last_y = (int)varint_read_signed(&p);
+    session->start_x = (int)varint_read_signed(&p);
+    session->start_y = (int)varint_read_signed(&p);
+    if (!session->has_started) {
+        return;
+    }
+    size_t count = (size_t)varint_read(&p);
+    int64_t cell = 0;
+    for (size_t i = 0; i < count; i++) {
+        cell += varint_read_signed(&p);
+        cell_stack_push(&session->moves, (uint32_t)cell);
+    }
+    for (size_t i = 0; i < count; i++) {
+        int chain = (int)varint_read(&p);
+        if (chain != 0) {
+            uint32_t c = cell_stack_get(&session->moves, i);
+            set_cell_chain(board, (int)(c / n), (int)(c % n), chain);
+        }
+    }
+    size_t heads = (size_t)varint_read(&p);
+    for (size_t i = 0; i < heads; i++) {
+        uint64_t head = varint_read(&p);
+        cell_stack_push(&session->heads, head == 0 ? NO_CELL : (uint32_t)(head - 1));
+    }
+}
+
+//sauter une commande du journal
+static const unsigned char* skip_command(const unsigned char* p) {
+    switch (*p++) {
+        case HISTORY_START:
+        case HISTORY_SELECT:
+            varint_read_signed(&p);
+            varint_read_signed(&p);
+            return p;
+        case HISTORY_MOVE:
+            return p + 1;
+        default:
+            return p;
+    }
+}
+
+//rejouer une commande du journal sur la partie
+static const unsigned char* apply_command(Session* session, const unsigned char* p) {
+    int x, y;
+    switch (*p++) {
+        case HISTORY_START:
+            x = (int)varint_read_signed(&p);
+            y = (int)varint_read_signed(&p);
+            session_start(session, x, y);
+            break;
+        case HISTORY_SELECT:
+            x = (int)varint_read_signed(&p);
+            y = (int)varint_read_signed(&p);
+            session_select(session, x, y);
+            break;
+        case HISTORY_MOVE:
+            session_move(session, (char)*p++);
+            break;
+        case HISTORY_UNDO:
+            session_undo(session);
+            break;
+        case HISTORY_ERASE:
+            session_erase(session);
+            break;
+        case HISTORY_RESTART:
+            // comme play_game() qui recharge le niveau : grille vide et piles vidées
+            session_restart(session);
+            cell_stack_truncate(&session->moves, 0);
+            cell_stack_truncate(&session->heads, 0);
+            break;
+        default:
+            break;
+    }
+    return p;
+}
+
+//dernier point de reprise pris au plus tard à l'étape step
+static size_t find_checkpoint(const History* h, size_t step) {
+    size_t low = 0, high = h->checkpoint_count; // checkpoints[0].step <= step
+    while (high - low > 1) {
+        size_t mid = (low + high) / 2;
+        if (h->checkpoints[mid].step <= step) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+//position dans le journal de la commande step + 1
+static size_t command_offset(const History* h, size_t checkpoint, size_t step) {
+    const unsigned char* p = h->commands.bytes + h->checkpoints[checkpoint].command_offset;
+    for (size_t i = h->checkpoints[checkpoint].step; i < step; i++) {
+        p = skip_command(p);
+    }
+    return (size_t)(p - h->commands.bytes);
+}
+
+static bool add_checkpoint(History* h, const Session* session) {
+    if (h->checkpoint_count == h->checkpoint_capacity) {
+        size_t capacity = h->checkpoint_capacity ? h->checkpoint_capacity * 2 : 16;
+        HistoryCheckpoint* checkpoints = realloc(h->checkpoints, capacity * sizeof(HistoryCheckpoint));
+        if (!checkpoints) {
+            printf("Erreur : memoire insuffisante pour l'historique\n");
+            return false;
+        }
+        h->checkpoints = checkpoints;
+        h->checkpoint_capacity = capacity;
+    }
+    size_t offset = h->data.size;
+    if (!write_state(&h->data, session)) {
+        printf("Erreur : memoire insuffisante pour l'historique\n");
+        h->data.size = offset;
+        return false;
+    }
+    h->checkpoints[h->checkpoint_count++] =
+        (HistoryCheckpoint){h->last, h->commands.size, offset, h->data.size - offset};
+    return true;
+}
+
+//oublier les étapes les plus anciennes jusqu'à repasser sous le plafond mémoire
+static void enforce_memory_cap(History* h) {
+    while (history_memory(h) > h->memory_cap && h->checkpoint_count > 1) {
+        // un quart des points de reprise à la fois : les déplacements mémoire restent rares
+        size_t drop = h->checkpoint_count / 4 ? h->checkpoint_count / 4 : 1;
+        HistoryCheckpoint base = h->checkpoints[drop];
+        memmove(h->commands.bytes, h->commands.bytes + base.command_offset, h->commands.size - base.command_offset);
+        h->commands.size -= base.command_offset;
+        memmove(h->data.bytes, h->data.bytes + base.data_offset, h->data.size - base.data_offset);
+        h->data.size -= base.data_offset;
+        h->checkpoint_count -= drop;
+        memmove(h->checkpoints, h->checkpoints + drop, h->checkpoint_count * sizeof(HistoryCheckpoint));
+        for (size_t i = 0; i < h->checkpoint_count; i++) {
+            h->checkpoints[i].command_offset -= base.command_offset;
+            h->checkpoints[i].data_offset -= base.data_offset;
+        }
+        h->first = h->checkpoints[0].step;
+    }
+}
+
+void history_init(History* h, size_t memory_cap) {
+    memset(h, 0, sizeof(*h));
+    h->memory_cap = memory_cap;
+}
+
+void history_free(History* h) {
+    free(h->commands.bytes);
+    free(h->data.bytes);
+    free(h->checkpoints);
+    history_init(h, h->memory_cap);
+}
+
+//commencer l'historique d'un niveau : l'état courant devient l'étape 0
+void history_begin(History* h, const Session* session) {
+    h->commands.size = 0;
+    h->data.size = 0;
+    h->checkpoint_count = 0;
+    h->first = h->last = h->position = 0;
+    h->level = add_checkpoint(h, session) ? session->level_number : 0;
+}
+
+//ajouter une commande acceptée ; session est l'état obtenu après la commande
+void history_record(History* h, const Session* session, HistoryCommand command, int a, int b) {
+    if (h->level == 0) {
+        return;
+    }
+    if (h->position < h->last) {
+        // une nouvelle commande après un retour en arrière remplace la suite
+        size_t checkpoint = find_checkpoint(h, h->position);
+        h->commands.size = command_offset(h, checkpoint, h->position);
+        h->checkpoint_count = checkpoint + 1;
+        h->data.size = h->checkpoints[checkpoint].data_offset + h->checkpoints[checkpoint].data_size;
+        h->last = h->position;
+    }
+    size_t size = h->commands.size;
+    bool ok = byte_buffer_reserve(&h->commands, 2);
+    if (ok) {
+        h->commands.bytes[h->commands.size++] = (unsigned char)command;
+    }
+    if (ok && command == HISTORY_MOVE) {
+        h->commands.bytes[h->commands.size++] = (unsigned char)a; // direction N, S, E ou O
+    } else if (ok && (command == HISTORY_START || command == HISTORY_SELECT)) {
+        ok = varint_put_signed(&h->commands, a) && varint_put_signed(&h->commands, b);
+    }
+    if (!ok) {
+        printf("Erreur : memoire insuffisante pour l'historique\n");
+        h->commands.size = size;
+        h->level = 0; // historique incomplet : il ne sert plus à rien
+        return;
+    }
+    h->position = ++h->last;
+
+    const HistoryCheckpoint* latest = &h->checkpoints[h->checkpoint_count - 1];
+    if (h->last - latest->step >= HISTORY_MIN_INTERVAL &&
+        h->commands.size - latest->command_offset >= latest->data_size / 2) {
+        add_checkpoint(h, session);
+    }
+    enforce_memory_cap(h);
+}
+
+//mettre la partie dans l'état de l'étape step (entre first et last)
+bool history_seek(History* h, Session* session, size_t step) {
+    if (h->level == 0 || h->level != session->level_number || step < h->first || step > h->last) {
+        return false;
+    }
+    size_t checkpoint = find_checkpoint(h, step);
+    size_t from = h->checkpoints[checkpoint].step;
+    const unsigned char* p;
+    if (step >= h->position && h->position >= from) {
+        // l'état courant est plus près que le point de reprise : on rejoue la différence
+        p = h->commands.bytes + command_offset(h, checkpoint, h->position);
+        from = h->position;
+    } else {
+        read_state(session, h->data.bytes + h->checkpoints[checkpoint].data_offset);
+        p = h->commands.bytes + h->checkpoints[checkpoint].command_offset;
+    }
+    for (size_t i = from; i < step; i++) {
+        p = apply_command(session, p);
+    }
+    h->position = step;
+    return true;
+}
+
+//mémoire occupée par le journal et les points de reprise
+size_t history_memory(const History* h) {
+    return h->commands.size + h->data.size + h->checkpoint_count * sizeof(HistoryCheckpoint);
+}
@@ -0,0 +1,59 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "session.h"
+#include "varint.h"
+
+// Historique d'un niveau pour revenir à n'importe quelle étape et la rejouer.
+// Chaque commande acceptée est ajoutée à un journal compact (1 à quelques octets) ;
+// de temps en temps, un point de reprise garde l'état de la partie : position, piles
+// et chaîne de chaque case de l'historique des mouvements (les seules cases qui peuvent
+// être occupées), en entiers variables. Aller à l'étape k restaure le point de reprise
+// qui la précède puis rejoue les commandes suivantes ; avancer depuis l'étape courante
+// rejoue seulement la différence. Un point de reprise est pris quand le journal écrit
+// depuis le précédent a atteint la moitié de sa taille : rejouer ne coûte jamais plus
+// que restaurer. Au-delà du plafond mémoire, les étapes les plus anciennes sont oubliées.
+
+#define HISTORY_DEFAULT_MEMORY (16u * 1024u * 1024u)
+#define HISTORY_MIN_INTERVAL 16 // commandes au moins entre deux points de reprise
+
+typedef enum {
+    HISTORY_START,   // x y
+    HISTORY_MOVE,    // direction
+    HISTORY_UNDO,
+    HISTORY_ERASE,
+    HISTORY_RESTART,
+    HISTORY_SELECT   // x y
+} HistoryCommand;
+
+typedef ByteBuffer HistoryBuffer;
+
+typedef struct {
+    size_t step;            // étape dont l'état est gardé
+    size_t command_offset;  // début, dans le journal, de la commande step + 1
+    size_t data_offset;
+    size_t data_size;
+} HistoryCheckpoint;
+
+typedef struct {
+    HistoryBuffer commands; // journal des commandes, à la suite
+    HistoryBuffer data;     // états des points de reprise, à la suite
+    HistoryCheckpoint* checkpoints;
+    size_t checkpoint_count, checkpoint_capacity;
+    size_t memory_cap;
+    int level;              // niveau enregistré, 0 : aucun
+    size_t first;           // plus ancienne étape encore disponible
+    size_t last;            // dernière étape enregistrée
+    size_t position;        // étape de l'état courant de la partie
+} History;
+
+void history_init(History* h, size_t memory_cap);
+void history_free(History* h);
+void history_begin(History* h, const Session* session);
+void history_record(History* h, const Session* session, HistoryCommand command, int a, int b);
+bool history_seek(History* h, Session* session, size_t step);
+size_t history_memory(const History* h);
+
+#endif
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include "input.h"
+#include "stats.h"
+#include "trace.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define INPUT_BUFFER_SIZE 256
+#define ESCAPE_WAIT_MS 25 // délai laissé à la suite d'une séquence d'échappement
+
+static struct termios saved_termios;
+static int saved_flags;
+static bool raw_active = false;
+
+// Octets lus mais pas encore décodés : une rafale de touches est lue d'un seul appel
+static unsigned char buffer[INPUT_BUFFER_SIZE];
+static int buffer_start = 0, buffer_end = 0;
+
+//passer le terminal en mode brut (lecture non bloquante, sans écho ni ligne)
+bool input_raw_begin(void) {
+    if (raw_active) {
+        return true;
+    }
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &saved_termios) != 0) {
+        return false;
+    }
+    struct termios raw = saved_termios;
+    raw.c_lflag &= ~(tcflag_t)(ICANON | ECHO | ISIG | IEXTEN); // Ctrl-C devient une touche : la partie est sauvegardée
+    raw.c_iflag &= ~(tcflag_t)(IXON);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) != 0) {
+        return false;
+    }
+    saved_flags = fcntl(STDIN_FILENO, F_GETFL);
+    fcntl(STDIN_FILENO, F_SETFL, saved_flags | O_NONBLOCK);
+    raw_active = true;
+    atexit(input_raw_end); // le terminal est rendu même si le programme quitte ailleurs
+    return true;
+}
+
+//rendre au terminal son mode d'origine
+void input_raw_end(void) {
+    if (!raw_active) {
+        return;
+    }
+    fflush(stdout);
+    fcntl(STDIN_FILENO, F_SETFL, saved_flags);
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved_termios);
+    raw_active = false;
+}
+
+//lire tout ce qui est disponible, en attendant au plus timeout_ms (-1 : sans limite)
+// renvoie 1 si des octets sont arrivés, 0 sinon, -1 à la fin de l'entrée
+static int fill_buffer(int timeout_ms) {
+    if (buffer_start == buffer_end) {
+        buffer_start = buffer_end = 0;
+    }
+    if (buffer_end == INPUT_BUFFER_SIZE) {
+        return 1;
+    }
+    struct pollfd fd = {STDIN_FILENO, POLLIN, 0};
+    int ready = poll(&fd, 1, timeout_ms);
+    if (ready <= 0) {
+        return ready < 0 && errno != EINTR ? -1 : 0;
+    }
+    ssize_t n = read(STDIN_FILENO, buffer + buffer_end, (size_t)(INPUT_BUFFER_SIZE - buffer_end));
+    if (n < 0) {
+        return errno == EAGAIN || errno == EINTR ? 0 : -1;
+    }
+    if (n == 0) {
+        return -1; // terminal fermé
+    }
+    buffer_end += (int)n;
+    return 1;
+}
+
+//une touche est-elle déjà en attente ? (sert à regrouper l'affichage d'une rafale)
+bool input_pending(void) {
+    return buffer_start < buffer_end || fill_buffer(0) > 0;
+}
+
+//octet suivant, en attendant au plus timeout_ms ; -1 si rien n'est arrivé
+static int next_byte(int timeout_ms) {
+    if (buffer_start == buffer_end && fill_buffer(timeout_ms) <= 0) {
+        return -1;
+    }
+    return buffer[buffer_start++];
+}
+
+//attendre la touche suivante et décoder les séquences des flèches
+int input_key(void) {
+    fflush(stdout); // l'image en cours part avant l'attente
+    TRACE_START(wait_trace);
+    while (buffer_start == buffer_end) {
+        if (fill_buffer(-1) < 0) {
+            return KEY_QUIT;
+        }
+    }
+    TRACE_END(wait_trace, TRACE_INPUT_WAIT);
+    int c = buffer[buffer_start++];
+    STAT_ADD(STAT_KEYS, 1);
+
+    if (c == 3 || c == 4) {
+        return KEY_QUIT; // Ctrl-C, Ctrl-D
+    }
+    if (c == '\r') {
+        return '\n';
+    }
+    if (c != 0x1b) {
+        return c;
+    }
+    // ESC [ A..D ou ESC O A..D selon le mode du terminal
+    int prefix = next_byte(ESCAPE_WAIT_MS);
+    if (prefix != '[' && prefix != 'O') {
+        return 0x1b;
+    }
+    switch (next_byte(ESCAPE_WAIT_MS)) {
+        case 'A': return KEY_UP;
+        case 'B': return KEY_DOWN;
+        case 'C': return KEY_RIGHT;
+        case 'D': return KEY_LEFT;
+        default: return 0x1b;
+    }
+}
+
+#else
+
+bool input_raw_begin(void) {
+    return false;
+}
+
+void input_raw_end(void) {
+}
+
+bool input_pending(void) {
+    return false;
+}
+
+int input_key(void) {
+    int c = getchar();
+    return c == EOF ? KEY_QUIT : c;
+}
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+
+// Saisie clavier en mode brut : chaque touche est lue dès qu'elle est frappée, sans
+// attendre Entrée ni l'afficher. Les flèches arrivent en séquences d'échappement
+// (ESC [ A...) décodées ici. Hors d'un terminal (entrée redirigée), le mode brut
+// est refusé et le jeu garde la lecture ligne par ligne.
+
+#define KEY_UP    0x101
+#define KEY_DOWN  0x102
+#define KEY_RIGHT 0x103
+#define KEY_LEFT  0x104
+#define KEY_QUIT  (-1)   // fin de l'entrée, Ctrl-C ou Ctrl-D
+
+bool input_raw_begin(void);
+void input_raw_end(void);
+bool input_pending(void);
+int input_key(void);
+
+#endif
@@ -0,0 +1,152 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "level.h"
+
+//lire un niveau au format texte (taille puis valeurs) depuis un fichier ouvert
+bool level_read(FILE* file, Level* level, char* error, size_t error_size) {
+    level->size = 0;
+    level->values = NULL;
+
+    int size;
+    if (fscanf(file, "%d", &size) != 1 || size <= 0 || size > 46340) {
+        snprintf(error, error_size, "Erreur : taille de grille invalide");
+        return false;
+    }
+
+    int* values = malloc((size_t)size * size * sizeof(int));
+    if (!values) {
+        snprintf(error, error_size, "Erreur : memoire insuffisante pour une grille %dx%d", size, size);
+        return false;
+    }
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            if (fscanf(file, "%d", &values[i * size + j]) != 1) {
+                snprintf(error, error_size, "Erreur de lecture à la position (%d, %d)", i, j);
+                free(values);
+                return false;
+            }
+        }
+    }
+
+    level->size = size;
+    level->values = values;
+    return true;
+}
+
+//écrire un niveau au format texte, lisible par level_read()
+bool level_write(FILE* file, const Level* level) {
+    int n = level->size;
+    fprintf(file, "%d\n", n);
+    for (int x = 0; x < n; x++) {
+        for (int y = 0; y < n; y++) {
+            fprintf(file, y ? " %d" : "%d", level_value(level, x, y));
+        }
+        fprintf(file, "\n");
+    }
+    return !ferror(file);
+}
+
+//lire un niveau binaire : "CCLV", la taille puis les valeurs en entiers de 32 bits
+bool level_read_binary(FILE* file, Level* level, char* error, size_t error_size) {
+    level->size = 0;
+    level->values = NULL;
+
+    char magic[4];
+    int32_t size;
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, LEVEL_BINARY_MAGIC, 4) != 0) {
+        snprintf(error, error_size, "Erreur : niveau binaire sans en-tete %s", LEVEL_BINARY_MAGIC);
+        return false;
+    }
+    if (fread(&size, sizeof(size), 1, file) != 1 || size <= 0 || size > 46340) {
+        snprintf(error, error_size, "Erreur : taille de grille invalide");
+        return false;
+    }
+
+    size_t cells = (size_t)size * size;
+    int* values = malloc(cells * sizeof(int));
+    if (!values) {
+        snprintf(error, error_size, "Erreur : memoire insuffisante pour une grille %dx%d", size, size);
+        return false;
+    }
+    if (fread(values, sizeof(int), cells, file) != cells) {
+        snprintf(error, error_size, "Erreur : niveau binaire tronque");
+        free(values);
+        return false;
+    }
+
+    level->size = size;
+    level->values = values;
+    return true;
+}
+
+//écrire un niveau binaire, lisible par level_read_binary()
+bool level_write_binary(FILE* file, const Level* level) {
+    int32_t size = level->size;
+    size_t cells = (size_t)size * size;
+    return fwrite(LEVEL_BINARY_MAGIC, 1, 4, file) == 4 && fwrite(&size, sizeof(size), 1, file) == 1 &&
+           fwrite(level->values, sizeof(int), cells, file) == cells;
+}
+
+//charger un niveau depuis un fichier texte
+bool level_load_file(const char* filename, Level* level, char* error, size_t error_size) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        snprintf(error, error_size, "Erreur : Impossible d'ouvrir le fichier %s", filename);
+        level->size = 0;
+        level->values = NULL;
+        return false;
+    }
+    bool ok = level_read(file, level, error, error_size);
+    fclose(file);
+    return ok;
+}
+
+//vérifier qu'un niveau respecte les règles du jeu :
+//valeurs >= -1, au moins un départ, et chaque case à couvrir peut être atteinte
+//depuis une case voisine (un 'x' ou une valeur inférieure ou égale)
+bool level_validate(const Level* level, char* error, size_t error_size) {
+    static const int dx[4] = {-1, 1, 0, 0};
+    static const int dy[4] = {0, 0, 1, -1};
+    int n = level->size;
+    int starts = 0, required = 0;
+
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            int value = level_value(level, i, j);
+            if (value < -1) {
+                snprintf(error, error_size, "valeur %d invalide en (%d, %d)", value, i, j);
+                return false;
+            }
+            if (value == 0) {
+                starts++;
+            } else if (value > 0) {
+                required++;
+                bool reachable = false;
+                for (int d = 0; d < 4 && !reachable; d++) {
+                    int x = i + dx[d], y = j + dy[d];
+                    if (x >= 0 && x < n && y >= 0 && y < n) {
+                        int from = level_value(level, x, y);
+                        reachable = from == 0 || (from > 0 && from <= value);
+                    }
+                }
+                if (!reachable) {
+                    snprintf(error, error_size, "la case (%d, %d) ne peut etre atteinte par aucune chaine", i, j);
+                    return false;
+                }
+            }
+        }
+    }
+    if (required > 0 && starts == 0) {
+        snprintf(error, error_size, "aucune case de depart 'x'");
+        return false;
+    }
+    return true;
+}
+
+//libérer les valeurs d'un niveau
+void level_free(Level* level) {
+    free(level->values);
+    level->values = NULL;
+    level->size = 0;
+}
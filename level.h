@@ -0,0 +1,33 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Niveau chargé en mémoire, indépendamment de la partie en cours :
+// les valeurs sont rangées ligne par ligne dans un seul bloc.
+typedef struct {
+    int size;
+    int* values;
+} Level;
+
+static inline int level_value(const Level* level, int x, int y) {
+    return level->values[x * level->size + y];
+}
+
+// Format binaire : les 4 octets "CCLV", la taille puis les valeurs ligne par ligne,
+// en entiers de 32 bits dans l'ordre d'octets de la machine (comme les sauvegardes).
+#define LEVEL_BINARY_MAGIC "CCLV"
+
+#define LEVEL_DEFAULT_DIR "../Level" // Répertoire des niveaux livrés (level1.txt, level2.txt...)
+
+bool level_read(FILE* file, Level* level, char* error, size_t error_size);
+bool level_write(FILE* file, const Level* level);
+bool level_read_binary(FILE* file, Level* level, char* error, size_t error_size);
+bool level_write_binary(FILE* file, const Level* level);
+bool level_load_file(const char* filename, Level* level, char* error, size_t error_size);
+bool level_validate(const Level* level, char* error, size_t error_size);
+void level_free(Level* level);
+
+#endif
@@ -0,0 +1,541 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "level.h"
+#include "loadgen.h"
+#include "rng.h"
+#include "session.h"
+#include "solver.h"
+#include "stats.h"
+#include "trace.h"
+
+#define SOLVE_MAX_NODES 2000000  // au-delà, la solution est demandée au solveur SAT
+#define HISTOGRAM_BUCKETS 1024
+
+typedef enum { CMD_START, CMD_MOVE, CMD_UNDO, CMD_ERASE, CMD_RESTART, CMD_SELECT, CMD_COUNT } CommandType;
+
+static const char* command_names[CMD_COUNT] = {"depart", "mouvement", "annuler", "effacer", "redemarrer", "selection"};
+
+typedef struct {
+    uint8_t type;
+    char direction;   // CMD_MOVE
+    int x, y;         // CMD_START, CMD_SELECT
+} ScriptCommand;
+
+// Partie à rejouer sur un niveau ; elle est suivie d'un redémarrage puis recommence
+typedef struct {
+    const Level* level;
+    ScriptCommand* commands;
+    int count;
+} Script;
+
+typedef struct {
+    Session session;
+    const Script* script;
+    int position;
+    uint64_t due_ns;      // instant prévu de la prochaine commande
+    uint32_t rng;
+} Player;
+
+// Histogramme log-linéaire : 16 cases par puissance de 2 (précision d'environ 6 %)
+typedef struct {
+    uint64_t counts[CMD_COUNT][HISTOGRAM_BUCKETS];   // latence depuis l'instant prévu
+    uint64_t service[CMD_COUNT][HISTOGRAM_BUCKETS];  // durée d'exécution seule
+    uint64_t refused[CMD_COUNT];
+    uint64_t max_ns[CMD_COUNT];
+    uint64_t rounds;      // parties menées jusqu'à la victoire
+} Measures;
+
+typedef struct {
+    const LoadgenOptions* options;
+    Player* players;
+    int count;
+    int* heap;            // joueurs du thread, par instant prévu croissant
+    uint64_t deadline_ns;
+    Measures measures;
+    pthread_t thread;
+} Worker;
+
+static int bucket_of(uint64_t ns) {
+    if (ns < 16) {
+        return (int)ns;
+    }
+    int msb = 63 - __builtin_clzll(ns);
+    return (msb - 3) * 16 + (int)((ns >> (msb - 4)) & 15);
+}
+
+//borne haute des durées rangées dans une case
+static uint64_t bucket_limit(int bucket) {
+    if (bucket < 16) {
+        return (uint64_t)bucket;
+    }
+    int msb = bucket / 16 + 3;
+    return ((uint64_t)(16 + bucket % 16 + 1) << (msb - 4)) - 1;
+}
+
+// ---------------------------------------------------------------------------
+// Parties à rejouer
+// ---------------------------------------------------------------------------
+
+static bool script_push(Script* script, int* capacity, ScriptCommand command) {
+    if (script->count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 64;
+        ScriptCommand* commands = realloc(script->commands, (size_t)*capacity * sizeof(ScriptCommand));
+        if (!commands) {
+            return false;
+        }
+        script->commands = commands;
+    }
+    script->commands[script->count++] = command;
+    return true;
+}
+
+//partie tirée de la solution du solveur : première chaîne par son départ, les suivantes par C
+static bool script_from_solution(Script* script, const Level* level) {
+    SolveOptions options;
+    SolveResult result = {0};
+    solve_options_default(&options);
+    options.max_nodes = SOLVE_MAX_NODES;
+    if (solve_level(level, &options, &result) == SOLVE_CANCELLED) {
+        options.engine = ENGINE_SAT;
+        options.max_nodes = 0;
+        solve_level(level, &options, &result);
+    }
+    bool ok = result.status == SOLVE_FOUND;
+    int n = level->size;
+    int capacity = 0;
+    int prev = -1;
+    bool first = true;
+    for (size_t i = 0; ok && i < result.path.count; i++) {
+        uint32_t cell = cell_stack_get(&result.path, i);
+        if (cell == NO_CELL) {
+            prev = -1;
+            continue;
+        }
+        int x = (int)cell / n, y = (int)cell % n;
+        ScriptCommand command = {CMD_MOVE, 0, x, y};
+        if (prev < 0) {
+            command.type = first ? CMD_START : CMD_SELECT;
+            first = false;
+        } else {
+            int px = prev / n, py = prev % n;
+            command.direction = x < px ? 'N' : x > px ? 'S' : y > py ? 'E' : 'O';
+        }
+        ok = script_push(script, &capacity, command);
+        prev = (int)cell;
+    }
+    solve_result_free(&result);
+    return ok && script->count > 0;
+}
+
+//partie enregistrée : les entrées de play_game ("x y" pour le départ, puis N S E O B R X, C x y)
+static bool script_from_file(Script* script, const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        printf("Erreur : Impossible d'ouvrir le fichier %s\n", filename);
+        return false;
+    }
+    int capacity = 0;
+    bool ok = true;
+    bool expect_start = true;
+    while (ok) {
+        ScriptCommand command = {CMD_START, 0, 0, 0};
+        char c;
+        if (expect_start) {
+            if (fscanf(file, "%d %d", &command.x, &command.y) != 2) {
+                break;
+            }
+            expect_start = false;
+        } else {
+            if (fscanf(file, " %c", &c) != 1) {
+                break;
+            }
+            switch (c) {
+                case 'B': case 'b': command.type = CMD_UNDO; break;
+                case 'R': case 'r': command.type = CMD_ERASE; break;
+                case 'X': case 'x': command.type = CMD_RESTART; expect_start = true; break;
+                case 'C': case 'c':
+                    command.type = CMD_SELECT;
+                    ok = fscanf(file, "%d %d", &command.x, &command.y) == 2;
+                    break;
+                default: command.type = CMD_MOVE; command.direction = c; break;
+            }
+        }
+        ok = ok && script_push(script, &capacity, command);
+    }
+    bool complete = ok && feof(file);
+    fclose(file);
+    if (!complete || script->count == 0) {
+        printf("Erreur : partie enregistree illisible dans %s\n", filename);
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Joueurs
+// ---------------------------------------------------------------------------
+
+static void player_begin(Player* player) {
+    Session* s = &player->session;
+    s->chain_counter = 1; // les numéros de chaîne repartent de 1 à chaque partie
+    s->current_chain = 0;
+    s->has_started = false;
+    s->last_x = s->last_y = 0;
+    s->start_x = s->start_y = -1;
+    session_begin_level(s);
+    player->position = 0;
+}
+
+static bool player_open(Player* player, const Script* script, uint32_t seed) {
+    memset(player, 0, sizeof(*player));
+    player->script = script;
+    player->rng = seed ? seed : 1;
+    Session* s = &player->session;
+    // piles hors de l'arène : elles sont vidées à chaque partie sans recharger la grille
+    allocate_grids(&s->board, script->level->size, script->level->values);
+    if (!s->board.kinds) {
+        return false;
+    }
+    player_begin(player);
+    return true;
+}
+
+static void player_close(Player* player) {
+    free_grids(&player->session.board);
+    cell_stack_free(&player->session.moves);
+    cell_stack_free(&player->session.heads);
+}
+
+//un mouvement que les règles refusent depuis la tête courante, 0 s'il n'y en a pas
+static char wrong_direction(Player* player) {
+    static const char names[4] = {'N', 'S', 'E', 'O'};
+    static const int dx[4] = {-1, 1, 0, 0};
+    static const int dy[4] = {0, 0, 1, -1};
+    Session* s = &player->session;
+    int first = (int)(rng_next(&player->rng) % 4);
+    for (int k = 0; k < 4; k++) {
+        int d = (first + k) % 4;
+        if (!is_valid_move(&s->board, s->last_x, s->last_y, s->last_x + dx[d], s->last_y + dy[d])) {
+            return names[d];
+        }
+    }
+    return 0;
+}
+
+static bool is_refused(SessionStatus status) {
+    return status != SESSION_OK && status != SESSION_VICTORY && status != SESSION_CHAIN_RESUMED;
+}
+
+//jouer la commande suivante (ou une erreur), renvoie son type et si elle a été refusée
+static CommandType player_step(Player* player, const LoadgenOptions* options, bool* refused, bool* won) {
+    Session* s = &player->session;
+    *won = false;
+    if (s->has_started && options->error_rate > 0 &&
+        rng_next(&player->rng) < (uint32_t)(options->error_rate * 4294967295.0)) {
+        char wrong = wrong_direction(player);
+        if (wrong) {
+            *refused = is_refused(session_move(s, wrong));
+            return CMD_MOVE;
+        }
+    }
+
+    if (player->position == player->script->count) {
+        // partie terminée (ou partie enregistrée épuisée) : on recommence
+        session_restart(s);
+        player_begin(player);
+        *refused = false;
+        return CMD_RESTART;
+    }
+    const ScriptCommand* c = &player->script->commands[player->position++];
+    SessionStatus status = SESSION_OK;
+    switch (c->type) {
+        case CMD_START: status = session_start(s, c->x, c->y); break;
+        case CMD_MOVE: status = session_move(s, c->direction); break;
+        case CMD_UNDO: status = session_undo(s); break;
+        case CMD_ERASE: session_erase(s); break;
+        case CMD_RESTART: session_restart(s); session_begin_level(s); break;
+        case CMD_SELECT: status = session_select(s, c->x, c->y); break;
+    }
+    *refused = is_refused(status);
+    *won = status == SESSION_VICTORY;
+    return (CommandType)c->type;
+}
+
+// ---------------------------------------------------------------------------
+// Threads
+// ---------------------------------------------------------------------------
+
+static void heap_down(Worker* w, int i) {
+    for (;;) {
+        int best = i, l = 2 * i + 1, r = 2 * i + 2;
+        if (l < w->count && w->players[w->heap[l]].due_ns < w->players[w->heap[best]].due_ns) {
+            best = l;
+        }
+        if (r < w->count && w->players[w->heap[r]].due_ns < w->players[w->heap[best]].due_ns) {
+            best = r;
+        }
+        if (best == i) {
+            return;
+        }
+        int t = w->heap[i];
+        w->heap[i] = w->heap[best];
+        w->heap[best] = t;
+        i = best;
+    }
+}
+
+//temps de réflexion tiré selon une loi exponentielle
+static uint64_t think_time(Player* player, double mean_ms) {
+    if (mean_ms <= 0) {
+        return 0;
+    }
+    double u = (rng_next(&player->rng) + 1.0) / 4294967297.0;
+    return (uint64_t)(-log(u) * mean_ms * 1e6);
+}
+
+static void sleep_until(uint64_t ns) {
+    struct timespec ts = {(time_t)(ns / 1000000000u), (long)(ns % 1000000000u)};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+    }
+}
+
+static void* worker_loop(void* arg) {
+    Worker* w = arg;
+    trace_thread_name("joueurs");
+    Measures* m = &w->measures;
+    for (;;) {
+        Player* player = &w->players[w->heap[0]];
+        uint64_t now = stats_now_ns();
+        if (player->due_ns > now) {
+            if (player->due_ns >= w->deadline_ns) {
+                break;
+            }
+            sleep_until(player->due_ns);
+        } else if (now >= w->deadline_ns) {
+            break;
+        }
+
+        bool refused, won;
+        uint64_t begin = stats_now_ns();
+        CommandType type = player_step(player, w->options, &refused, &won);
+        uint64_t done = stats_now_ns();
+        uint64_t latency = done - player->due_ns;
+        m->counts[type][bucket_of(latency)]++;
+        m->service[type][bucket_of(done - begin)]++;
+        m->refused[type] += refused;
+        m->rounds += won;
+        if (latency > m->max_ns[type]) {
+            m->max_ns[type] = latency;
+        }
+        player->due_ns = done + think_time(player, w->options->think_ms);
+        heap_down(w, 0);
+    }
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Rapport
+// ---------------------------------------------------------------------------
+
+static uint64_t percentile(const uint64_t* counts, uint64_t total, double p) {
+    uint64_t rank = (uint64_t)ceil(p * (double)total);
+    uint64_t seen = 0;
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+        seen += counts[b];
+        if (seen >= rank && seen > 0) {
+            return bucket_limit(b);
+        }
+    }
+    return 0;
+}
+
+static void print_report(const LoadgenOptions* options, const Measures* total, double seconds) {
+    uint64_t commands = 0;
+    for (int t = 0; t < CMD_COUNT; t++) {
+        for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            commands += total->counts[t][b];
+        }
+    }
+    printf("Generateur de charge : %d joueurs sur %d threads pendant %.1f s (reflexion %.1f ms, erreurs %.1f %%)\n",
+           options->players, options->threads, seconds, options->think_ms, options->error_rate * 100);
+    printf("%llu commandes (%.0f/s), %llu parties gagnees\n", (unsigned long long)commands,
+           (double)commands / seconds, (unsigned long long)total->rounds);
+    printf("%-12s %9s %9s %9s | %-49s | %s\n", "", "", "", "", "latence (us)", "execution (us)");
+    printf("%-12s %9s %9s %9s | %9s %9s %9s %9s %9s | %9s %9s\n", "commande", "nombre", "refusees", "par s",
+           "p50", "p90", "p99", "p99.9", "max", "p50", "p99");
+    for (int t = 0; t < CMD_COUNT; t++) {
+        uint64_t count = 0;
+        for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            count += total->counts[t][b];
+        }
+        if (count == 0) {
+            continue;
+        }
+        printf("%-12s %9llu %9llu %9.0f | %9.2f %9.2f %9.2f %9.2f %9.2f | %9.2f %9.2f\n", command_names[t],
+               (unsigned long long)count, (unsigned long long)total->refused[t], (double)count / seconds,
+               percentile(total->counts[t], count, 0.50) / 1e3, percentile(total->counts[t], count, 0.90) / 1e3,
+               percentile(total->counts[t], count, 0.99) / 1e3, percentile(total->counts[t], count, 0.999) / 1e3,
+               total->max_ns[t] / 1e3, percentile(total->service[t], count, 0.50) / 1e3,
+               percentile(total->service[t], count, 0.99) / 1e3);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Interface
+// ---------------------------------------------------------------------------
+
+void loadgen_options_default(LoadgenOptions* options) {
+    options->players = 1000;
+    options->threads = 4;
+    options->think_ms = 0;
+    options->error_rate = 0;
+    options->duration_s = 5;
+    options->level_file = NULL;
+    options->level_dir = LEVEL_DEFAULT_DIR;
+    options->script_file = NULL;
+    options->seed = 1;
+}
+
+//charger les niveaux et préparer une partie à rejouer pour chacun
+static int load_scripts(const LoadgenOptions* options, Level* levels, Script* scripts, int max) {
+    int count = 0;
+    char error[160];
+    for (int number = 1; count < max; number++) {
+        char filename[256];
+        const char* path = options->level_file;
+        if (!path) {
+            snprintf(filename, sizeof(filename), "%s/level%d.txt", options->level_dir, number);
+            path = filename;
+        } else if (number > 1) {
+            break;
+        }
+        if (!level_load_file(path, &levels[count], error, sizeof(error))) {
+            if (options->level_file || strstr(error, "Impossible d'ouvrir")) {
+                if (options->level_file) {
+                    printf("%s\n", error);
+                }
+                break; // fin des niveaux livrés
+            }
+            continue;
+        }
+        Script* script = &scripts[count];
+        memset(script, 0, sizeof(*script));
+        script->level = &levels[count];
+        bool ok = options->script_file ? script_from_file(script, options->script_file)
+                                       : script_from_solution(script, &levels[count]);
+        if (!ok) {
+            if (!options->script_file) {
+                printf("%s ignore : aucune solution a rejouer\n", path);
+            }
+            free(script->commands);
+            level_free(&levels[count]);
+            if (options->script_file) {
+                break;
+            }
+            continue;
+        }
+        count++;
+    }
+    return count;
+}
+
+#define LOADGEN_MAX_LEVELS 256
+
+//lancer les joueurs simulés et afficher le débit et les latences par commande
+int run_loadgen(const LoadgenOptions* options) {
+    if (options->script_file && !options->level_file) {
+        printf("Erreur : une partie enregistree (--script) se rejoue sur un niveau donne (--level)\n");
+        return 1;
+    }
+    if (options->players < 1 || options->threads < 1 || options->duration_s <= 0) {
+        printf("Erreur : parametres du generateur de charge invalides\n");
+        return 1;
+    }
+    static Level levels[LOADGEN_MAX_LEVELS];
+    static Script scripts[LOADGEN_MAX_LEVELS];
+    int script_count = load_scripts(options, levels, scripts, LOADGEN_MAX_LEVELS);
+    if (script_count == 0) {
+        printf("Erreur : aucun niveau a rejouer\n");
+        return 1;
+    }
+
+    int threads = options->threads < options->players ? options->threads : options->players;
+    Player* players = calloc((size_t)options->players, sizeof(Player));
+    Worker* workers = calloc((size_t)threads, sizeof(Worker));
+    int* heap = malloc((size_t)options->players * sizeof(int));
+    bool ok = players && workers && heap;
+    for (int i = 0; ok && i < options->players; i++) {
+        ok = player_open(&players[i], &scripts[i % script_count], options->seed * 2654435761u + (uint32_t)i);
+    }
+    if (!ok) {
+        printf("Erreur : memoire insuffisante pour %d joueurs\n", options->players);
+    }
+
+    uint64_t start = stats_now_ns();
+    uint64_t deadline = start + (uint64_t)(options->duration_s * 1e9);
+    // joueurs répartis par blocs contigus ; départs étalés sur le premier temps de réflexion
+    for (int t = 0, first = 0; ok && t < threads; t++) {
+        Worker* w = &workers[t];
+        w->options = options;
+        w->players = players + first;
+        w->count = options->players / threads + (t < options->players % threads);
+        w->heap = heap + first;
+        w->deadline_ns = deadline;
+        for (int i = 0; i < w->count; i++) {
+            w->players[i].due_ns = start + think_time(&w->players[i], options->think_ms);
+            w->heap[i] = i;
+        }
+        for (int i = w->count / 2 - 1; i >= 0; i--) {
+            heap_down(w, i);
+        }
+        first += w->count;
+    }
+    int started = 0;
+    for (; ok && started < threads; started++) {
+        if (pthread_create(&workers[started].thread, NULL, worker_loop, &workers[started]) != 0) {
+            printf("Erreur : impossible de demarrer le thread %d\n", started);
+            break;
+        }
+    }
+    Measures* total = calloc(1, sizeof(Measures));
+    for (int t = 0; t < started; t++) {
+        pthread_join(workers[t].thread, NULL);
+        for (int c = 0; total && c < CMD_COUNT; c++) {
+            for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+                total->counts[c][b] += workers[t].measures.counts[c][b];
+                total->service[c][b] += workers[t].measures.service[c][b];
+            }
+            total->refused[c] += workers[t].measures.refused[c];
+            if (workers[t].measures.max_ns[c] > total->max_ns[c]) {
+                total->max_ns[c] = workers[t].measures.max_ns[c];
+            }
+        }
+        if (total) {
+            total->rounds += workers[t].measures.rounds;
+        }
+    }
+    double seconds = (double)(stats_now_ns() - start) / 1e9;
+    if (ok && total && started == threads) {
+        LoadgenOptions shown = *options;
+        shown.threads = threads;
+        print_report(&shown, total, seconds);
+    }
+
+    for (int i = 0; players && i < options->players; i++) {
+        player_close(&players[i]);
+    }
+    for (int i = 0; i < script_count; i++) {
+        free(scripts[i].commands);
+        level_free(&levels[i]);
+    }
+    free(total);
+    free(players);
+    free(workers);
+    free(heap);
+    return ok && started == threads ? 0 : 1;
+}
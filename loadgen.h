@@ -0,0 +1,26 @@
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+// Générateur de charge : des milliers de joueurs simulés rejouent une partie (enregistrée,
+// ou tirée de la solution du solveur) sur le moteur de jeu du processus, répartis sur
+// quelques threads. Chaque joueur attend un temps de réflexion tiré au hasard entre deux
+// commandes et se trompe parfois (mouvement refusé). Le débit et les percentiles de latence
+// sont donnés par type de commande ; la latence est comptée depuis l'instant où la commande
+// aurait dû partir, pour que le retard pris sous forte charge reste visible.
+
+typedef struct {
+    int players;
+    int threads;
+    double think_ms;           // temps de réflexion moyen (loi exponentielle), 0 : sans pause
+    double error_rate;         // part des commandes précédées d'un mouvement refusé (0 à 1)
+    double duration_s;
+    const char* level_file;    // NULL : niveaux level_dir/levelN.txt, attribués aux joueurs à tour de rôle
+    const char* level_dir;
+    const char* script_file;   // partie enregistrée (commandes de play_game), avec level_file
+    unsigned seed;
+} LoadgenOptions;
+
+void loadgen_options_default(LoadgenOptions* options);
+int run_loadgen(const LoadgenOptions* options);
+
+#endif
@@ -1,175 +1,177 @@
+#include <signal.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include "board.h"
+#include "cellstack.h"
+#include "cnf.h"
+#include "diffcheck.h"
+#include "editor.h"
+#include "history.h"
+#include "input.h"
+#include "level.h"
+#include "loadgen.h"
+#include "morton.h"
+#include "pack.h"
+#include "prefetch.h"
+#include "session.h"
+#include "snapshot.h"
+#include "solver.h"
+#include "spectate.h"
+#include "stats.h"
+#include "stream.h"
+#include "tiles.h"
+#include "trace.h"
+#include "watch.h"
+#include "wire.h"
 
-#define MAX_MOVES 1000
+#define VIEWPORT_SIZE 20 // Côté de la fenêtre affichée pour les grilles tuilées
+#define SAVE_DEFAULT_FILE "partie.sav" // Sauvegarde automatique du parcours des niveaux
 
-// Variables globales pour la grille et les mouvements
-int** grid;
-int** chain_grid;
-int last_positions[MAX_MOVES][2];  // Dernières positions des chaînes
-
-int move_stack[MAX_MOVES][2]; // Pour annuler les mouvements
-int move_stack_top = -1;
-
-int N; // Taille de la grille
+// Variables globales pour la partie en cours
+Session session; // Grille, mouvements et position du joueur
+History history; // Étapes du niveau en cours, pour revenir en arrière et refaire
+size_t history_limit = HISTORY_DEFAULT_MEMORY;
+int view_x = 0, view_y = 0; // Centre de la fenêtre affichée
+const char* save_file = SAVE_DEFAULT_FILE; // NULL si la sauvegarde est désactivée
+const char* level_dir = LEVEL_DEFAULT_DIR;
+bool raw_input = false; // touches lues une à une (--raw), sinon ligne par ligne
+bool input_closed = false; // le joueur a quitté en mode brut (Q, Ctrl-C)
+int cursor_x = -1, cursor_y = -1; // case surlignée pendant un choix de case en mode brut
 
 bool colors_enabled = true; // Assurez-vous que cette variable est définie sur true
 
 // Prototypes des fonctions
-void play_game();
-bool load_grid(const char* filename);
+void play_game(const char* level_file);
 void print_grid();
-void reset_level();
-bool check_victory();
-void erase_chain(int chain_id);
+int print_grid_region(int row, int col, int rows, int cols);
 void display_controls(int last_x, int last_y, int current_chain);
-void push_move(int x, int y);
-void pop_move(int *x, int *y);
-bool is_within_bounds(int x, int y);
-bool is_valid_move(int start_x, int start_y, int dest_x, int dest_y);
 bool prompt_for_next_level(int current_level);
-void allocate_grids(int size);
-void free_grids();
-
-//allouer la mémoire pour les grilles
-void allocate_grids(int size) {
-    N = size;
-    grid = malloc(N * sizeof(int*));
-    chain_grid = malloc(N * sizeof(int*));
-
-    for (int i = 0; i < N; i++) {
-        grid[i] = malloc(N * sizeof(int));
-        chain_grid[i] = malloc(N * sizeof(int));
-        memset(chain_grid[i], 0, N * sizeof(int));
-    }
-}
-
-//libérer la mémoire allouée pour les grilles
-void free_grids() {
-    for (int i = 0; i < N; i++) {
-        free(grid[i]);
-        free(chain_grid[i]);
-    }
-    free(grid);
-    free(chain_grid);
-}
-
-//empiler un mouvement
-void push_move(int x, int y) {
-    if (move_stack_top < MAX_MOVES - 1) {
-        move_stack_top++;
-        move_stack[move_stack_top][0] = x;
-        move_stack[move_stack_top][1] = y;
-    }
-}
-
-//épiler un mouvement
-void pop_move(int *x, int *y) {
-    if (move_stack_top >= 0) {
-        *x = move_stack[move_stack_top][0];
-        *y = move_stack[move_stack_top][1];
-        move_stack_top--;
-    }
-}
-
-//verifier si les coordonnées sont dans les limites de la grille
-bool is_within_bounds(int x, int y) {
-    return x >= 0 && x < N && y >= 0 && y < N;
-}
-
-//vérifier si un mouvement est valide
-bool is_valid_move(int start_x, int start_y, int dest_x, int dest_y) {
-    if ((start_x == dest_x && start_y != dest_y) || (start_x != dest_x && start_y == dest_y)) {
-        if (is_within_bounds(dest_x, dest_y)) {
-            if (grid[dest_x][dest_y] != -1 &&
-                chain_grid[dest_x][dest_y] == 0 &&
-                (grid[dest_x][dest_y] >= grid[start_x][start_y] || grid[start_x][start_y] == 0)) {
-                return true;
-            }
-        }
-    }
-    return false;
-}
+int read_cell(int* x, int* y, char* command);
+int read_command(char* move);
+void travel_history(char command);
+void resume_saved_game(void);
+void level_path(char* filename, size_t size, int number);
 
 //   afficher une valeur colorée en fonction du numéro de chaîne
-void print_colored(int chain_number, int value) {
+int print_colored(int chain_number, int value) {
+    int bytes = 0;
     if (!colors_enabled) {
-        printf(" %d ", value);
-        return;
+        return printf(" %d ", value);
     }
 
     switch (chain_number) {
         case 1:
-            printf("\033[34m %d \033[0m", value); // Bleu
+            bytes += printf("\033[34m %d \033[0m", value); // Bleu
         break;
         case 2:
-            printf("\033[31m %d \033[0m", value); // Rouge
+            bytes += printf("\033[31m %d \033[0m", value); // Rouge
         break;
         case 3:
-            printf("\033[32m %d \033[0m", value); // Vert
+            bytes += printf("\033[32m %d \033[0m", value); // Vert
         break;
         case 4:
-            printf("\033[33m %d \033[0m", value); // Jaune
+            bytes += printf("\033[33m %d \033[0m", value); // Jaune
         break;
         default:
-            printf(" %d ", value); // Par défaut
+            bytes += printf(" %d ", value); // Par défaut
         break;
     }
-    printf("\033[0m");
+    bytes += printf("\033[0m");
+    return bytes;
 }
 
 //   afficher un 'x' coloré en fonction du numéro de chaîne
-void print_blocked(int chain_number) {
+int print_blocked(int chain_number) {
+    int bytes = 0;
     if (!colors_enabled) {
-        printf(" x ");
-        return;
+        return printf(" x ");
     }
 
     switch (chain_number) {
         case 1:
-            printf("\033[34m x \033[0m");
+            bytes += printf("\033[34m x \033[0m");
             break;
         case 2:
-            printf("\033[31m x \033[0m");
+            bytes += printf("\033[31m x \033[0m");
             break;
         case 3:
-            printf("\033[32m x \033[0m");
+            bytes += printf("\033[32m x \033[0m");
             break;
         case 4:
-            printf("\033[33m x \033[0m");
+            bytes += printf("\033[33m x \033[0m");
             break;
         default:
-            printf(" x ");
+            bytes += printf(" x ");
             break;
     }
+    return bytes;
 }
 
 //   afficher la grille de jeu
 void print_grid() {
     colors_enabled = true; // s'assure que les couleurs sont activées
-    printf("Grille de jeu :\n");
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            if (grid[i][j] == -1) {
-                printf("   "); // Afficher -1 comme vide
+    STAT_ADD(STAT_RENDERS, 1);
+    TRACE_START(render_trace);
+    int N = session.board.size;
+    int bytes; // octets écrits, calculés même sans compteurs (STAT_ADD n'évalue alors rien)
+    if (!session.board.tiles) {
+        bytes = printf("Grille de jeu :\n");
+        bytes += print_grid_region(0, 0, N, N);
+        STAT_ADD(STAT_RENDER_BYTES, bytes);
+        TRACE_END(render_trace, TRACE_RENDER);
+        return;
+    }
+
+    // grille tuilée : seule une fenêtre autour de la position courante est affichée
+    int size = N < VIEWPORT_SIZE ? N : VIEWPORT_SIZE;
+    int row = view_x - size / 2;
+    int col = view_y - size / 2;
+    row = row < 0 ? 0 : (row > N - size ? N - size : row);
+    col = col < 0 ? 0 : (col > N - size ? N - size : col);
+    bytes = printf("Grille de jeu (lignes %d-%d, colonnes %d-%d sur %d) :\n",
+                   row, row + size - 1, col, col + size - 1, N);
+    bytes += print_grid_region(row, col, size, size);
+    STAT_ADD(STAT_RENDER_BYTES, bytes);
+    TRACE_END(render_trace, TRACE_RENDER);
+}
+
+//   afficher une portion rectangulaire de la grille, renvoie le nombre d'octets écrits
+int print_grid_region(int row, int col, int rows, int cols) {
+    int bytes = 0;
+    for (int i = row; i < row + rows; i++) {
+        for (int j = col; j < col + cols; j++) {
+            int value = cell_value(&session.board, i, j);
+            int chain = cell_chain(&session.board, i, j);
+            if (i == cursor_x && j == cursor_y) {
+                bytes += printf("\033[7m"); // vidéo inverse jusqu'à la fin de la case
+            }
+            if (value == -1) {
+                bytes += printf("   "); // Afficher -1 comme vide
             } else {
-                if (chain_grid[i][j] > 0) {
-                    if (grid[i][j] == 0) {
-                        print_blocked(chain_grid[i][j]); // Afficher 'x' coloré
+                if (chain > 0) {
+                    if (value == 0) {
+                        bytes += print_blocked(chain); // Afficher 'x' coloré
                     } else {
-                        print_colored(chain_grid[i][j], grid[i][j]); // Afficher en couleur
+                        bytes += print_colored(chain, value); // Afficher en couleur
                     }
-                } else if (grid[i][j] == 0) {
-                    printf(" x "); // Afficher 'x' au lieu de 0
+                } else if (value == 0) {
+                    bytes += printf(" x "); // Afficher 'x' au lieu de 0
                 } else {
-                    printf(" %d ", grid[i][j]);
+                    bytes += printf(" %d ", value);
                 }
             }
+            if (i == cursor_x && j == cursor_y) {
+                bytes += printf("\033[0m");
+            }
         }
-        printf("\n");
+        bytes += printf("\n");
     }
+    return bytes;
 }
 
 //   afficher les contrôles du jeu
@@ -188,66 +190,200 @@ void display_controls(int last_x, int last_y, int current_chain) {
     printf("Annuler le mouvement precedent (B).\n");
     printf("Effacer la chaine (R).\n");
     printf("Redemarrer le niveau (X).\n");
-    printf("Selectionner une autre chaine (C).\n \n ");
+    printf("Selectionner une autre chaine (C).\n");
+    printf("Revenir en arriere (Z), refaire (Y), aller a une etape (H) : etape %zu sur %zu.\n",
+           history.position, history.last);
+    if (raw_input) {
+        printf("Touches : fleches, WASD ou NSEO pour avancer, Q pour quitter.\n");
+    }
+    printf(" \n ");
+}
+
+//   la saisie est-elle terminée (fin de l'entrée, ou Q en mode brut) ?
+bool input_ended(void) {
+    return raw_input ? input_closed : feof(stdin);
 }
 
-//   effacer une chaîne de la grille
-//   effacer une chaîne de la grille
-void erase_chain(int chain_id) {
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            if (chain_grid[i][j] == chain_id && grid[i][j] != -1 && grid[i][j] != 0) {
-                chain_grid[i][j] = 0;
+//   traduire une touche du mode brut en commande de jeu (N, S, E, O, B, R, X, C), 0 si ignorée
+char key_command(int key) {
+    switch (key) {
+        case KEY_UP: case 'w': case 'W': case 'n': case 'N': return 'N';
+        case KEY_DOWN: case 's': case 'S': return 'S';
+        case KEY_RIGHT: case 'd': case 'D': case 'e': case 'E': return 'E';
+        case KEY_LEFT: case 'a': case 'A': case 'o': case 'O': return 'O';
+        case 'b': case 'B': case 127: case '\b': return 'B'; // retour arrière annule aussi
+        case 'r': case 'R': return 'R';
+        case 'x': case 'X': return 'X';
+        case 'c': case 'C': return 'C';
+        case 'z': case 'Z': return 'Z';
+        case 'y': case 'Y': return 'Y';
+        case 'h': case 'H': return 'H';
+        default: return 0;
+    }
+}
+
+//   lire une case (x y) ; en mode brut, les flèches déplacent un curseur et Entrée valide.
+//   Si command n'est pas NULL, Z, Y ou H y sont rendus (valeur 1) à la place d'une case.
+int read_cell(int* x, int* y, char* command) {
+    if (!raw_input) {
+        TRACE_START(wait_trace);
+        int read = 0;
+        if (command) {
+            int c;
+            while ((c = getchar()) == ' ' || c == '\n' || c == '\t' || c == '\r');
+            if (c != EOF && strchr("ZzYyHh", c)) {
+                *command = (char)toupper(c);
+                read = 1;
+            } else {
+                ungetc(c, stdin);
             }
         }
+        if (!read) {
+            read = scanf("%d %d", x, y);
+        }
+        TRACE_END(wait_trace, TRACE_INPUT_WAIT);
+        return read;
+    }
+    int N = session.board.size;
+    cursor_x = session.last_x >= 0 && session.last_x < N ? session.last_x : 0;
+    cursor_y = session.last_y >= 0 && session.last_y < N ? session.last_y : 0;
+    for (;;) {
+        if (!input_pending()) { // une rafale de touches ne donne qu'un affichage
+            view_x = cursor_x;
+            view_y = cursor_y;
+            print_grid();
+            printf("Case %d %d (Entree pour valider) ", cursor_x, cursor_y);
+        }
+        int key = input_key();
+        if (key == KEY_QUIT || key == 'q' || key == 'Q') {
+            input_closed = true;
+            cursor_x = cursor_y = -1;
+            return EOF;
+        }
+        if (key == '\n' || key == ' ') {
+            printf("\n");
+            *x = cursor_x;
+            *y = cursor_y;
+            cursor_x = cursor_y = -1;
+            return 2;
+        }
+        char key_cmd = key_command(key);
+        if (command && (key_cmd == 'Z' || key_cmd == 'Y' || key_cmd == 'H')) {
+            printf("%c\n", key_cmd);
+            *command = key_cmd;
+            cursor_x = cursor_y = -1;
+            return 1;
+        }
+        switch (key_cmd) {
+            case 'N': cursor_x -= cursor_x > 0; break;
+            case 'S': cursor_x += cursor_x < N - 1; break;
+            case 'E': cursor_y += cursor_y < N - 1; break;
+            case 'O': cursor_y -= cursor_y > 0; break;
+            default: break;
+        }
     }
 }
 
-//   réinitialiser le niveau
-void reset_level() {
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            chain_grid[i][j] = 0;
+//   lire un numéro d'étape ; en mode brut, les chiffres sont affichés au fur et à mesure
+int read_number(long* value) {
+    if (!raw_input) {
+        int read = scanf("%ld", value);
+        if (read == 0) {
+            while (getchar() != '\n'); // Vider le buffer d'entrée
+        }
+        return read;
+    }
+    char digits[20];
+    size_t length = 0;
+    for (;;) {
+        int key = input_key();
+        if (key == KEY_QUIT) {
+            input_closed = true;
+            return EOF;
         }
+        if (key == '\n') {
+            printf("\n");
+            digits[length] = '\0';
+            *value = atol(digits);
+            return length > 0;
+        }
+        if ((key == 127 || key == '\b') && length > 0) {
+            length--;
+            printf("\b \b");
+        } else if (key >= '0' && key <= '9' && length < sizeof(digits) - 1) {
+            digits[length++] = (char)key;
+            printf("%c", key);
+        }
+        fflush(stdout);
     }
 }
 
-//   vérifier si le joueur a gagné
-bool check_victory() {
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            if (grid[i][j] != -1 && grid[i][j] != 0 && chain_grid[i][j] == 0) {
-                return false;
+//   aller dans l'historique du niveau : Z recule d'une étape, Y avance, H va à l'étape choisie
+void travel_history(char command) {
+    size_t target = history.position;
+    if (command == 'Z') {
+        if (history.position == history.first) {
+            printf("Debut de l'historique.\n");
+            return;
+        }
+        target--;
+    } else if (command == 'Y') {
+        if (history.position == history.last) {
+            printf("Aucune etape a refaire.\n");
+            return;
+        }
+        target++;
+    } else {
+        long step;
+        printf("Aller a l'etape (%zu a %zu) : ", history.first, history.last);
+        if (read_number(&step) != 1 || step < (long)history.first || step > (long)history.last) {
+            if (!input_ended()) {
+                printf("Etape invalide.\n");
             }
+            return;
         }
+        target = (size_t)step;
+    }
+    if (!history_seek(&history, &session, target)) {
+        printf("Historique indisponible.\n");
     }
-    return true;
 }
 
-//   charger une grille à partir d'un fichier
-bool load_grid(const char* filename) {
-    printf("Tentative d'ouverture du fichier: %s\n", filename);
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        printf("Erreur : Impossible d'ouvrir le fichier %s\n", filename);
-        return false;
-    }
-
-    int grid_size;
-    fscanf(file, "%d", &grid_size);
-    allocate_grids(grid_size);
-
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            if (fscanf(file, "%d", &grid[i][j]) != 1) {
-                printf("Erreur de lecture à la position (%d, %d)\n", i, j);
-                fclose(file);
-                return false;
-            }
+//   lire une commande de jeu ; en mode brut, chaque touche est une commande
+int read_command(char* move) {
+    if (!raw_input) {
+        TRACE_START(wait_trace);
+        int read = scanf(" %c", move);
+        TRACE_END(wait_trace, TRACE_INPUT_WAIT);
+        return read;
+    }
+    for (;;) {
+        int key = input_key();
+        if (key == KEY_QUIT || key == 'q' || key == 'Q') {
+            input_closed = true;
+            return EOF;
+        }
+        *move = key_command(key);
+        if (*move) {
+            printf("%c\n", *move); // pas d'écho en mode brut
+            return 1;
         }
     }
-    fclose(file);
-    return true;
+}
+
+//   installer un niveau préparé en arrière-plan
+void install_prepared_level(PreparedLevel* prepared) {
+    printf("Niveau %d pret (charge en arriere-plan).\n", prepared->number);
+    if (!prepared->valid) {
+        printf("Attention : %s\n", prepared->error);
+    } else if (prepared->solved) {
+        printf(prepared->status == SOLVE_FOUND ? "Niveau verifie : soluble (%llu noeuds explores).\n"
+                                               : "Attention : ce niveau n'a pas de solution (%llu noeuds explores).\n",
+               prepared->nodes);
+    } else if (prepared->status == SOLVE_CANCELLED) {
+        printf("Verification abandonnee apres %llu noeuds.\n", prepared->nodes);
+    }
+    board_adopt_level(&session.board, &prepared->level); // bloc de valeurs repris sans copie
 }
 
 //   afficher un message de félicitations pour le niveau terminé
@@ -255,158 +391,222 @@ bool prompt_for_next_level(int current_level) {
     printf("Bravo ! Vous avez terminé le niveau %d.\n", current_level);
     print_grid(); // Afficher la grille complétée
 
-    char response;
+    char response = 'N'; // fin de l'entrée : on s'arrête
     printf("Voulez-vous continuer au niveau suivant ? (O/N) : ");
-    scanf(" %c", &response);
+    if (raw_input) {
+        int key = input_key();
+        response = key == KEY_QUIT ? 'N' : (char)key;
+        printf("%c\n", response);
+    } else {
+        scanf(" %c", &response);
+    }
 
     return (response == 'O' || response == 'o');
 }
 
-void play_game() {
-    int x, y, new_x, new_y;
-    int chain_counter = 1;
+//   construire le nom du fichier d'un niveau du parcours
+void level_path(char* filename, size_t size, int number) {
+    snprintf(filename, size, "%s/level%d.txt", level_dir, number);
+}
+
+//   reprendre la partie sauvegardée, s'il y en a une
+void resume_saved_game(void) {
+    char error[160];
+    if (!snapshot_restore(&session, save_file, error, sizeof(error))) {
+        if (!strstr(error, "Impossible d'ouvrir")) {
+            printf("%s (partie non reprise)\n", error);
+        }
+        return;
+    }
+    printf("Partie reprise au niveau %d.\n", session.level_number);
+    if (session.has_started) {
+        char filename[256];
+        level_path(filename, sizeof(filename), session.level_number + 1);
+        prefetch_request(session.level_number + 1, filename);
+    }
+}
+
+void play_game(const char* level_file) {
+    int x, y;
     bool playing = true;
-    int current_chain = 0;
-    bool has_started = false;
-    int last_x = 0, last_y = 0;
-    int start_x = -1, start_y = -1;
-    int current_level = 1;
+    session.chain_counter = 1;
+    session.current_chain = 0;
+    session.has_started = false;
+    session.last_x = session.last_y = 0;
+    session.start_x = session.start_y = -1;
+    session.level_number = 1;
+    // l'historique des mouvements vit dans l'arène du niveau et disparaît avec lui
+    session.moves.arena = &session.board.arena;
+    session.heads.arena = &session.board.arena;
+    history_init(&history, history_limit);
 
-    memset(last_positions, -1, sizeof(last_positions));
+    // seul le parcours des niveaux est sauvegardé : un fichier --level se rejoue tel quel
+    SnapshotWriter saver;
+    bool autosave = !level_file && save_file;
+    if (autosave) {
+        resume_saved_game(); // avant d'ouvrir le fichier en écriture
+        autosave = snapshot_writer_open(&saver, save_file);
+    }
 
     while (playing) {
+        if (autosave) {
+            snapshot_writer_save(&saver, &session); // après chaque commande
+        }
+        if (history.level != session.level_number) {
+            history_begin(&history, &session); // nouveau niveau (ou partie reprise) : étape 0
+        }
         colors_enabled = true; // s'assure que les couleurs sont activées
-        display_controls(last_x, last_y, current_chain);
+        view_x = session.last_x;
+        view_y = session.last_y;
+        // en mode brut, les touches déjà arrivées sont traitées avant de redessiner
+        bool redraw = !raw_input || !input_pending();
+        if (redraw) {
+            display_controls(session.last_x, session.last_y, session.current_chain);
+        }
 
-        if (!has_started) {
-            printf("Chargement du niveau %d...\n", current_level);
-            char filename[100];
-            snprintf(filename, sizeof(filename), "../Level/level%d.txt", current_level);
-            if (!load_grid(filename)) {
-                continue;
+        if (!session.has_started) {
+            printf("Chargement du niveau %d...\n", session.level_number);
+            char filename[256];
+            level_path(filename, sizeof(filename), session.level_number);
+            PreparedLevel* prepared = level_file ? NULL : prefetch_take(session.level_number);
+            if (prepared && prepared->loaded) {
+                install_prepared_level(prepared);
+                prefetch_release(prepared);
+            } else {
+                prefetch_release(prepared);
+                if (!load_grid(&session.board, level_file ? level_file : filename)) {
+                    if (level_file) {
+                        return; // pas de niveau suivant à essayer
+                    }
+                    continue;
+                }
             }
+            if (!level_file) {
+                // préparer le niveau suivant pendant que celui-ci est joué
+                level_path(filename, sizeof(filename), session.level_number + 1);
+                prefetch_request(session.level_number + 1, filename);
+            }
+            session_begin_level(&session);
 
-            print_grid();
-
-            printf("Entrez une case de depart pour commencer une nouvelle chaine sur un 'x' (x y) : ");
-            if (scanf("%d %d", &x, &y) != 2) {
+            if (raw_input) {
+                printf("Placez le curseur sur un 'x' de depart pour commencer une nouvelle chaine.\n");
+            } else {
+                print_grid();
+                printf("Entrez une case de depart pour commencer une nouvelle chaine sur un 'x' (x y) : ");
+            }
+            char command;
+            int read = read_cell(&x, &y, &command);
+            if (read == 1) {
+                travel_history(command); // par exemple pour annuler un redémarrage
+                continue;
+            }
+            if (read != 2) {
+                if (input_ended()) {
+                    playing = false; // fin de l'entrée : la partie est sauvegardée avant de quitter
+                    continue;
+                }
                 printf("Entrée invalide. Veuillez entrer deux entiers.\n");
                 while (getchar() != '\n'); // Vider le buffer d'entrée
                 continue;
             }
 
-            if (is_within_bounds(x, y) && grid[x][y] == 0 && chain_grid[x][y] == 0) {
-                current_chain = chain_counter++;
-                chain_grid[x][y] = current_chain; // Colorier la case sélectionnée
-                last_x = x;
-                last_y = y;
-                start_x = x;
-                start_y = y;
-                push_move(x, y);
-                last_positions[current_chain][0] = last_x;
-                last_positions[current_chain][1] = last_y;
-                has_started = true;
-            } else {
+            SessionStatus started = session_start(&session, x, y);
+            if (started == SESSION_NO_MEMORY) {
+                printf("Erreur : memoire insuffisante, depart ignore.\n");
+                continue;
+            } else if (started != SESSION_OK) {
                 printf("Mouvement invalide. Veuillez sélectionner un 'x'.\n");
                 continue;
             }
+            history_record(&history, &session, HISTORY_START, x, y);
         } else {
-            print_grid();
+            if (redraw) {
+                print_grid();
+                printf("Entrez votre mouvement (N/S/E/O) : ");
+            }
 
             char move;
-            printf("Entrez votre mouvement (N/S/E/O) : ");
-            if (scanf(" %c", &move) != 1) {
+            if (read_command(&move) != 1) {
+                if (input_ended()) {
+                    playing = false;
+                    continue;
+                }
                 printf("Entrée invalide. Veuillez entrer une direction (N/S/E/O).\n");
                 while (getchar() != '\n'); // Vider le buffer d'entrée
                 continue;
             }
 
+            SessionStatus status;
             switch (move) {
-                case 'N':
-                case 'n':
-                    new_x = last_x - 1; new_y = last_y; break;
-                case 'S':
-                case 's':
-                    new_x = last_x + 1; new_y = last_y; break;
-                case 'E':
-                case 'e':
-                    new_x = last_x; new_y = last_y + 1; break;
-                case 'O':
-                case 'o':
-                    new_x = last_x; new_y = last_y - 1; break;
                 case 'B':
                 case 'b':
-                    if (grid[last_x][last_y] == 0) {
+                    status = session_undo(&session);
+                    if (status == SESSION_OK) {
+                        history_record(&history, &session, HISTORY_UNDO, 0, 0);
+                    } else if (status == SESSION_UNDO_ON_START) {
                         printf("Impossible d'annuler un mouvement sur un 'x'.\n");
-                    } else if (move_stack_top >= 0) {
-                        int popped_x = move_stack[move_stack_top][0];
-                        int popped_y = move_stack[move_stack_top][1];
-                        move_stack_top--;
-                        chain_grid[popped_x][popped_y] = 0;
-                        if (move_stack_top >= 0) {
-                            last_x = move_stack[move_stack_top][0];
-                            last_y = move_stack[move_stack_top][1];
-                        } else {
-                            last_x = start_x;
-                            last_y = start_y;
-                        }
-                    } else {
+                    } else if (status == SESSION_NOTHING_TO_UNDO) {
                         printf("Aucun mouvement précédent à annuler.\n");
                     }
                     continue;
                 case 'R':
                 case 'r':
-                    erase_chain(current_chain); last_x = start_x; last_y = start_y; continue;
+                    session_erase(&session);
+                    history_record(&history, &session, HISTORY_ERASE, 0, 0);
+                    continue;
                 case 'X':
                 case 'x':
-                    reset_level(); has_started = false; continue;
+                    session_restart(&session);
+                    history_record(&history, &session, HISTORY_RESTART, 0, 0);
+                    continue;
+                case 'Z':
+                case 'z':
+                case 'Y':
+                case 'y':
+                case 'H':
+                case 'h':
+                    travel_history((char)toupper(move));
+                    continue;
                 case 'C':
                 case 'c':
                         printf("Selectionnez une case pour changer la chaine (x y) : ");
-                scanf("%d %d", &x, &y);
-
-                if (is_within_bounds(x, y) && (grid[x][y] == 0 || chain_grid[x][y] > 0)) {
-                    if (chain_grid[x][y] > 0) {
-                        // Mettez à jour current_chain avec la chaîne existante
-                        current_chain = chain_grid[x][y];
-                        // Derniere position de la chaine
-                        last_x = last_positions[current_chain][0];
-                        last_y = last_positions[current_chain][1];
-                        // Affichez la position reprise
-                        printf("Vous avez repris la chaîne %d à la position (%d, %d).\n", current_chain, last_x + 1, last_y + 1);
-                    } else {
-                        // Si c'est une case 'x', démarrez une nouvelle chaîne
-                        current_chain = chain_counter++;
-                        chain_grid[x][y] = current_chain;
-                        last_x = x;
-                        last_y = y;
-                        push_move(x, y);
-                        last_positions[current_chain][0] = last_x;
-                        last_positions[current_chain][1] = last_y;
-                    }
-                } else {
+                if (read_cell(&x, &y, NULL) == EOF && input_ended()) {
+                    playing = false;
+                    continue;
+                }
+
+                status = session_select(&session, x, y);
+                if (status != SESSION_BAD_SELECT && status != SESSION_NO_MEMORY) {
+                    history_record(&history, &session, HISTORY_SELECT, x, y);
+                }
+                if (status == SESSION_CHAIN_RESUMED) {
+                    // Affichez la position reprise
+                    printf("Vous avez repris la chaîne %d à la position (%d, %d).\n", session.current_chain, session.last_x + 1, session.last_y + 1);
+                } else if (status == SESSION_BAD_SELECT) {
                     printf("Case invalide. Veuillez sélectionner un 'x' ou une case déjà occupée.\n");
+                } else if (status == SESSION_NO_MEMORY) {
+                    printf("Erreur : memoire insuffisante, selection ignoree.\n");
                 }
                 continue;
                 default:
-                    printf("Mouvement invalide.\n");
-                    continue;
+                    status = session_move(&session, move); // N, S, E, O
+                    break;
             }
 
-            if (is_valid_move(last_x, last_y, new_x, new_y)) {
-                chain_grid[new_x][new_y] = current_chain;
-                last_x = new_x;
-                last_y = new_y;
-                push_move(last_x, last_y);
-                last_positions[current_chain][0] = last_x;
-                last_positions[current_chain][1] = last_y;
-
-                if (check_victory()) {
-                    if (prompt_for_next_level(current_level)) {
-                        current_level++;
-                        has_started = false;
-                    } else {
+            if (status == SESSION_NO_MEMORY) {
+                printf("Erreur : memoire insuffisante, mouvement ignore.\n");
+            } else if (status != SESSION_BAD_MOVE) {
+                history_record(&history, &session, HISTORY_MOVE, move, 0);
+                if (status == SESSION_VICTORY) {
+                    if (level_file) {
+                        printf("Bravo ! Vous avez terminé le niveau %s.\n", level_file);
+                        print_grid();
                         playing = false;
+                    } else {
+                        // le niveau suivant est enregistré même si le joueur s'arrête ici
+                        playing = prompt_for_next_level(session.level_number);
+                        session.level_number++;
+                        session.has_started = false;
                     }
                 }
             } else {
@@ -415,11 +615,446 @@ void play_game() {
         }
     }
 
-    free_grids();
+    if (autosave) {
+        snapshot_writer_save(&saver, &session);
+        snapshot_writer_close(&saver);
+    }
+    if (session.board.tiles) {
+        tiles_print_stats(session.board.tiles);
+    }
+    free_grids(&session.board);
+    history_free(&history);
+    cell_stack_free(&session.moves);
+    cell_stack_free(&session.heads);
+}
+
+//   résoudre un niveau et afficher la solution
+static atomic_bool solve_interrupted; // Ctrl-C pendant --solve : arrêt propre avec point de reprise
+
+static void on_interrupt(int signal_number) {
+    (void)signal_number;
+    atomic_store(&solve_interrupted, true);
+}
+
+int solve_file(const char* filename, SolveEngine engine, MoveOrder order, const char* checkpoint, bool resume,
+               double time_limit) {
+    Level level;
+    char error[160];
+    if (tiles_is_tiled_file(filename)) {
+        // le solveur travaille sur la grille entière en mémoire : une grille tuilée est
+        // seulement validée, tuile par tuile, sous le plafond --tile-mem
+        TileStore* tiles = tiles_open(filename, tile_memory);
+        if (!tiles) {
+            return 1;
+        }
+        int n = tiles_size(tiles);
+        if (tiles_validate(tiles, error, sizeof(error))) {
+            printf("Grille tuilee %dx%d valide.\n", n, n);
+        } else {
+            printf("Grille tuilee %dx%d non valide : %s\n", n, n, error);
+        }
+        tiles_close(tiles);
+        printf("Erreur : la resolution d'une grille tuilee n'est pas prise en charge "
+               "(convertir le niveau au format texte pour le resoudre)\n");
+        return 1;
+    }
+    if (!level_load_file(filename, &level, error, sizeof(error))) {
+        printf("%s\n", error);
+        return 1;
+    }
+    if (!level_validate(&level, error, sizeof(error))) {
+        printf("Attention : %s\n", error);
+    }
+
+    SolveOptions options;
+    SolveResult result = {0};
+    solve_options_default(&options);
+    options.order = order;
+    options.engine = engine;
+    if (checkpoint && engine == ENGINE_SEARCH) {
+        options.checkpoint = checkpoint;
+        options.resume = resume;
+        options.cancel = &solve_interrupted;
+        signal(SIGINT, on_interrupt);
+    }
+    if (time_limit > 0 && engine == ENGINE_SEARCH) {
+        // réponse dans le délai : meilleure couverture partielle si la recherche n'aboutit pas
+        options.time_limit = time_limit;
+        options.anytime = true;
+    }
+    SolveStatus status = solve_level(&level, &options, &result);
+    signal(SIGINT, SIG_DFL);
+    if (result.resumed) {
+        printf("Recherche reprise depuis %s.\n", checkpoint);
+    } else if (resume && options.checkpoint) {
+        printf("Pas de point de reprise utilisable dans %s : recherche depuis le debut.\n", checkpoint);
+    }
+    if (status == SOLVE_FOUND) {
+        printf("Solution trouvee (%llu %s) :\n", result.nodes, engine == ENGINE_SAT ? "decisions" : "noeuds explores");
+        print_solution(&level, &result);
+    } else if (status == SOLVE_CANCELLED && options.checkpoint) {
+        printf("Recherche interrompue apres %llu noeuds ; reprise avec --resume depuis %s.\n", result.nodes,
+               options.checkpoint);
+    } else if (status == SOLVE_CANCELLED && !options.anytime) {
+        printf("Recherche interrompue apres %llu noeuds.\n", result.nodes);
+    } else {
+        printf("Aucune solution %s(%llu %s).\n", status == SOLVE_CANCELLED ? "dans le delai " : "", result.nodes,
+               engine == ENGINE_SAT ? "decisions" : "noeuds explores");
+    }
+    if (status != SOLVE_FOUND && options.anytime) {
+        printf("Meilleure couverture : %d cases sur %d (%s) :\n", result.best_covered, result.required,
+               result.optimal ? "optimale" : "optimum non prouve");
+        print_best(&level, &result);
+    }
+    solve_result_free(&result);
+    level_free(&level);
+    return status == SOLVE_FOUND ? 0 : status == SOLVE_CANCELLED ? 3 : 2;
+}
+
+//   lire les options de --solve FICHIER : ordre ou sat, point de reprise
+int solve_command(int argc, char** argv) {
+    SolveEngine engine = ENGINE_SEARCH;
+    MoveOrder order = ORDER_FIXED;
+    const char* checkpoint = NULL;
+    bool resume = false;
+    double time_limit = 0;
+    char default_checkpoint[256];
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "sat") == 0) {
+            engine = ENGINE_SAT;
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            checkpoint = argv[++i];
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            resume = true;
+        } else if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+            time_limit = atof(argv[++i]);
+        } else if (!move_order_parse(argv[i], &order)) {
+            printf("Ordre inconnu : %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (resume && !checkpoint) {
+        snprintf(default_checkpoint, sizeof(default_checkpoint), "%s.ck", argv[0]);
+        checkpoint = default_checkpoint;
+    }
+    return solve_file(argv[0], engine, order, checkpoint, resume, time_limit);
+}
+
+//coder un niveau en CNF et l'écrire au format DIMACS
+int export_dimacs(const char* filename, const char* out_file) {
+    Level level;
+    LevelCnf cnf;
+    char error[160];
+    if (!level_load_file(filename, &level, error, sizeof(error))) {
+        printf("%s\n", error);
+        return 1;
+    }
+    bool ok = cnf_encode_level(&level, 0, &cnf) && cnf_write_dimacs(&cnf, &level, out_file);
+    if (ok) {
+        printf("%s : %d variables (%d aretes), %zu clauses\n", out_file, cnf.var_count, cnf.edge_count, cnf.clause_count);
+    }
+    cnf_free(&cnf);
+    level_free(&level);
+    return ok ? 0 : 1;
+}
+
+#define ORDER_BENCH_MAX_NODES 100000000ULL // au-delà, la résolution est comptée comme abandonnée
+
+//résoudre chaque niveau avec chaque heuristique d'ordre et comparer noeuds et temps
+int compare_orders(char** files, int count) {
+    unsigned long long total_nodes[ORDER_COUNT] = {0};
+    double total_ms[ORDER_COUNT] = {0};
+    int gave_up[ORDER_COUNT] = {0};
+    int levels = 0;
+
+    printf("%-24s", "niveau");
+    for (int o = 0; o < ORDER_COUNT; o++) {
+        printf(" %22s", move_order_name((MoveOrder)o));
+    }
+    printf("\n");
+    for (int i = 0; i < count; i++) {
+        Level level;
+        char error[160];
+        if (!level_load_file(files[i], &level, error, sizeof(error))) {
+            printf("%s\n", error);
+            continue;
+        }
+        const char* name = strrchr(files[i], '/') ? strrchr(files[i], '/') + 1 : files[i];
+        printf("%-24s", name);
+        for (int o = 0; o < ORDER_COUNT; o++) {
+            SolveOptions options;
+            SolveResult result = {0};
+            solve_options_default(&options);
+            options.order = (MoveOrder)o;
+            options.max_nodes = ORDER_BENCH_MAX_NODES;
+            uint64_t start = stats_now_ns();
+            SolveStatus status = solve_level(&level, &options, &result);
+            double ms = (double)(stats_now_ns() - start) / 1e6;
+            total_nodes[o] += result.nodes;
+            total_ms[o] += ms;
+            gave_up[o] += status == SOLVE_CANCELLED;
+            printf(" %12llu %8.2fms%c", result.nodes, ms, status == SOLVE_CANCELLED ? '+' : ' ');
+            solve_result_free(&result);
+        }
+        printf("\n");
+        level_free(&level);
+        levels++;
+    }
+    if (levels == 0) {
+        return 1;
+    }
+
+    int best = 0;
+    printf("%-24s", "total");
+    for (int o = 0; o < ORDER_COUNT; o++) {
+        printf(" %12llu %8.2fms ", total_nodes[o], total_ms[o]);
+        if (gave_up[o] < gave_up[best] || (gave_up[o] == gave_up[best] && total_ms[o] < total_ms[best])) {
+            best = o;
+        }
+    }
+    printf("\n(+ : abandon apres %llu noeuds)\n", ORDER_BENCH_MAX_NODES);
+    printf("Ordre le plus rapide sur %d niveau(x) : %s\n", levels, move_order_name((MoveOrder)best));
+    return 0;
+}
+
+//   afficher les options de la ligne de commande
+void print_usage(const char* program) {
+    printf("Utilisation :\n");
+    printf("  %s [--level FICHIER] [--tile-mem Mo]   jouer (niveaux %s/ par defaut)\n", program, LEVEL_DEFAULT_DIR);
+    printf("      [--levels REPERTOIRE]               repertoire des niveaux level1.txt, level2.txt...\n");
+    printf("      [--morton N]                        grilles et recherche en ordre de Morton a partir de NxN\n");
+    printf("                                          (%d par defaut, 0 : jamais ; avant --solve)\n", MORTON_DEFAULT_MIN_SIZE);
+    printf("      [--no-prefetch] [--presolve]        chargement du niveau suivant en arriere-plan\n");
+    printf("      [--stats | --stats=json]            statistiques de performance en fin d'execution\n");
+    printf("      [--trace FICHIER]                   intervalles dates au format Chrome (Perfetto)\n");
+    printf("      [--save FICHIER | --no-save]        sauvegarde automatique (%s par defaut)\n", SAVE_DEFAULT_FILE);
+    printf("      [--history-mem Mo]                  memoire de l'historique (Z, Y, H) par niveau\n");
+    printf("      [--raw]                             une touche par commande (fleches, WASD), sans Entree\n");
+    printf("  %s --solve FICHIER [ordre | sat]        resoudre un niveau (ordre : fixe, contrainte,\n", program);
+    printf("                                          valeur ou warnsdorff ; sat : solveur SAT)\n");
+    printf("      [--checkpoint FICHIER] [--resume]   point de reprise (chaque minute et a Ctrl-C)\n");
+    printf("      [--time SECONDES]                   delai : sinon meilleure couverture partielle trouvee\n");
+    printf("  %s --stream [mode] < NIVEAUX            traiter une suite de niveaux (texte ou binaire) lue sur\n", program);
+    printf("                                          l'entree (mode : valider, resoudre, afficher, texte, binaire)\n");
+    printf("  %s --wire [N]                           partie en protocole binaire sur l'entree et la sortie\n", program);
+    printf("                                          (une image complete toutes les N reponses)\n");
+    printf("  %s --wire-encode | --wire-decode        commandes texte -> binaire, reponses binaires -> texte\n", program);
+    printf("  %s --dimacs FICHIER SORTIE.cnf          exporter le niveau en CNF (format DIMACS)\n", program);
+    printf("  %s --orders FICHIER...                  comparer les heuristiques d'ordre sur des niveaux\n", program);
+    printf("  %s --watch REPERTOIRE                   revalider les niveaux a chaque modification\n", program);
+    printf("  %s --edit FICHIER [N]                   editer un niveau (nouveau : NxN), soluble et unique\n", program);
+    printf("                                          verifies en arriere-plan apres chaque modification\n");
+    printf("  %s --pack GRILLE.txt SORTIE.bin [T]    convertir une grille texte en grille tuilee\n", program);
+    printf("  %s --gen-tiled SORTIE.bin N [graine]   generer une grille tuilee de test NxN\n", program);
+    printf("  %s --diffcheck [pas] [graine]          comparer les moteurs de grille aux regles de reference\n", program);
+    printf("  %s --loadgen JOUEURS [--threads N] [--think MS] [--errors %%] [--duration S]\n", program);
+    printf("      [--seed G] [--script FICHIER]       simuler des joueurs (niveau : --level avant --loadgen)\n");
+    printf("  %s --spectate SPECTATEURS [--threads N] [--buffer F] [--slow %%] [--commands N]\n", program);
+    printf("      [--seed G]                          diffuser une partie au hasard a des spectateurs\n");
+    printf("  %s --make-pack REPERTOIRE NOMBRE [--size N] [--seed G] [--workers G,R,D,C] [--queue Q]\n", program);
+    printf("                                          fabriquer un paquet de niveaux tries par difficulte\n");
+    printf("Les options de jeu (--level, --levels, --morton, --stats, --trace...) se placent avant le mode\n");
+    printf("(--solve, --wire, --stream...) : ce qui suit le mode lui appartient.\n");
+}
+
+//   lire les options du générateur de charge (après --loadgen JOUEURS)
+int loadgen_command(int argc, char** argv, const char* level_file) {
+    LoadgenOptions options;
+    loadgen_options_default(&options);
+    options.players = atoi(argv[0]);
+    options.level_file = level_file;
+    options.level_dir = level_dir;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            print_usage("untitled1");
+            return 1;
+        }
+        if (strcmp(argv[i], "--threads") == 0) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--think") == 0) {
+            options.think_ms = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--errors") == 0) {
+            options.error_rate = atof(argv[++i]) / 100;
+        } else if (strcmp(argv[i], "--duration") == 0) {
+            options.duration_s = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            options.seed = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--script") == 0) {
+            options.script_file = argv[++i];
+        } else {
+            print_usage("untitled1");
+            return 1;
+        }
+    }
+    return run_loadgen(&options);
+}
+
+//   lire les options de la diffusion aux spectateurs (après --spectate SPECTATEURS)
+int spectate_command(int argc, char** argv, const char* level_file) {
+    SpectateOptions options;
+    spectate_options_default(&options);
+    options.spectators = atoi(argv[0]);
+    char filename[256];
+    level_path(filename, sizeof(filename), 1);
+    options.level_file = level_file ? level_file : filename;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            print_usage("untitled1");
+            return 1;
+        }
+        if (strcmp(argv[i], "--threads") == 0) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--buffer") == 0) {
+            options.buffer = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--slow") == 0) {
+            options.slow_rate = atof(argv[++i]) / 100;
+        } else if (strcmp(argv[i], "--commands") == 0) {
+            options.commands = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            options.seed = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else {
+            print_usage("untitled1");
+            return 1;
+        }
+    }
+    return run_spectate(&options);
+}
+
+//   lire les options du paquet de niveaux (après --make-pack REPERTOIRE NOMBRE)
+int pack_command(int argc, char** argv) {
+    PackOptions options;
+    pack_options_default(&options);
+    options.output_dir = argv[0];
+    options.target = atoi(argv[1]);
+    for (int i = 2; i < argc; i++) {
+        if (i + 1 >= argc) {
+            print_usage("untitled1");
+            return 1;
+        }
+        if (strcmp(argv[i], "--size") == 0) {
+            options.size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            options.seed = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--queue") == 0) {
+            options.queue_capacity = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--workers") == 0) {
+            // threads de génération, résolution, doublons et difficulté
+            if (sscanf(argv[++i], "%d,%d,%d,%d", &options.workers[PACK_GENERATE], &options.workers[PACK_SOLVE],
+                       &options.workers[PACK_DEDUP], &options.workers[PACK_GRADE]) != 4) {
+                print_usage("untitled1");
+                return 1;
+            }
+        } else {
+            print_usage("untitled1");
+            return 1;
+        }
+    }
+    return run_pack(&options);
 }
 
 // Fonction principale
-int main() {
-    play_game();
+int main(int argc, char** argv) {
+    const char* level_file = NULL;
+    bool prefetch_enabled = true;
+    bool presolve = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+            level_file = argv[++i];
+        } else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc) {
+            level_dir = argv[++i];
+        } else if (strcmp(argv[i], "--tile-mem") == 0 && i + 1 < argc) {
+            tile_memory = (size_t)strtoul(argv[++i], NULL, 10) * 1024 * 1024;
+        } else if (strcmp(argv[i], "--morton") == 0 && i + 1 < argc) {
+            morton_min_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            stats_enable_dump(STATS_TEXT);
+        } else if (strcmp(argv[i], "--stats=json") == 0) {
+            stats_enable_dump(STATS_JSON);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            if (!trace_open(argv[++i])) {
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            save_file = argv[++i];
+        } else if (strcmp(argv[i], "--no-save") == 0) {
+            save_file = NULL;
+        } else if (strcmp(argv[i], "--history-mem") == 0 && i + 1 < argc) {
+            history_limit = (size_t)strtoul(argv[++i], NULL, 10) * 1024 * 1024;
+        } else if (strcmp(argv[i], "--raw") == 0) {
+            raw_input = true;
+        } else if (strcmp(argv[i], "--no-prefetch") == 0) {
+            prefetch_enabled = false;
+        } else if (strcmp(argv[i], "--presolve") == 0) {
+            presolve = true;
+        } else if (strcmp(argv[i], "--solve") == 0 && i + 1 < argc) {
+            return solve_command(argc - i - 1, argv + i + 1);
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            StreamMode mode = STREAM_SOLVE;
+            if (i + 1 < argc && !stream_mode_parse(argv[i + 1], &mode)) {
+                printf("Mode inconnu : %s\n", argv[i + 1]);
+                return 1;
+            }
+            return run_stream(mode);
+        } else if (strcmp(argv[i], "--wire") == 0) {
+            WireOptions options = {level_file, level_dir, WIRE_DEFAULT_SNAPSHOT_INTERVAL};
+            if (i + 1 < argc) {
+                // seul un nombre est pris : les options globales se placent avant --wire
+                char* end;
+                long interval = strtol(argv[i + 1], &end, 10);
+                if (end == argv[i + 1] || *end != '\0' || interval < 0 || interval > INT_MAX) {
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                options.snapshot_interval = (int)interval;
+            }
+            return run_wire_server(&options);
+        } else if (strcmp(argv[i], "--wire-encode") == 0) {
+            return run_wire_encode();
+        } else if (strcmp(argv[i], "--wire-decode") == 0) {
+            return run_wire_decode();
+        } else if (strcmp(argv[i], "--dimacs") == 0 && i + 2 < argc) {
+            return export_dimacs(argv[i + 1], argv[i + 2]);
+        } else if (strcmp(argv[i], "--orders") == 0 && i + 1 < argc) {
+            return compare_orders(argv + i + 1, argc - i - 1);
+        } else if (strcmp(argv[i], "--watch") == 0 && i + 1 < argc) {
+            return watch_levels(argv[i + 1]);
+        } else if (strcmp(argv[i], "--edit") == 0 && i + 1 < argc) {
+            return run_editor(argv[i + 1], i + 2 < argc ? atoi(argv[i + 2]) : 0);
+        } else if (strcmp(argv[i], "--pack") == 0 && i + 2 < argc) {
+            int tile = i + 3 < argc ? atoi(argv[i + 3]) : TILE_DEFAULT_SIZE;
+            return tiles_pack_text(argv[i + 1], argv[i + 2], tile) ? 0 : 1;
+        } else if (strcmp(argv[i], "--gen-tiled") == 0 && i + 2 < argc) {
+            unsigned seed = i + 3 < argc ? (unsigned)strtoul(argv[i + 3], NULL, 10) : 1;
+            return tiles_generate(argv[i + 1], atoi(argv[i + 2]), seed, TILE_DEFAULT_SIZE) ? 0 : 1;
+        } else if (strcmp(argv[i], "--make-pack") == 0 && i + 2 < argc) {
+            return pack_command(argc - i - 1, argv + i + 1);
+        } else if (strcmp(argv[i], "--loadgen") == 0 && i + 1 < argc) {
+            return loadgen_command(argc - i - 1, argv + i + 1, level_file);
+        } else if (strcmp(argv[i], "--spectate") == 0 && i + 1 < argc) {
+            return spectate_command(argc - i - 1, argv + i + 1, level_file);
+        } else if (strcmp(argv[i], "--diffcheck") == 0) {
+            long steps = i + 1 < argc ? atol(argv[i + 1]) : 1000000;
+            unsigned seed = i + 2 < argc ? (unsigned)strtoul(argv[i + 2], NULL, 10) : 1;
+            return run_diffcheck(steps > 0 ? steps : 1000000, seed, level_dir);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (prefetch_enabled && !level_file) {
+        prefetch_start(presolve);
+    }
+    if (raw_input && !input_raw_begin()) {
+        printf("L'entree n'est pas un terminal : saisie ligne par ligne.\n");
+        raw_input = false;
+    }
+    if (raw_input) {
+        setvbuf(stdout, NULL, _IOFBF, 1 << 16); // une image part en une écriture, vidée avant chaque attente
+    }
+    play_game(level_file);
+    input_raw_end();
+    prefetch_stop();
     return 0;
 }
@@ -0,0 +1,38 @@
+#include "morton.h"
+
+int morton_min_size = MORTON_DEFAULT_MIN_SIZE;
+
+//écarter les bits d'une coordonnée dans le bloc : b3 b2 b1 b0 -> b3 0 b2 0 b1 0 b0
+static uint32_t spread_bits(uint32_t v) {
+    uint32_t r = 0;
+    for (int b = 0; (1 << b) < MORTON_BLOCK; b++) {
+        r |= ((v >> b) & 1u) << (2 * b);
+    }
+    return r;
+}
+
+//une grille de cette taille doit-elle être rangée en ordre de Morton ?
+bool morton_wanted(int size) {
+    return morton_min_size > 0 && size >= morton_min_size;
+}
+
+//cases rangées pour une grille N x N, blocs du bord complétés
+size_t morton_cells(int size) {
+    size_t blocks = (size_t)(size + MORTON_BLOCK - 1) / MORTON_BLOCK;
+    return blocks * blocks * MORTON_BLOCK * MORTON_BLOCK;
+}
+
+//calculer les tables d'indices d'une grille N x N (allouées dans l'arène)
+void morton_init(MortonLayout* layout, int size, Arena* arena) {
+    uint32_t blocks = (uint32_t)(size + MORTON_BLOCK - 1) / MORTON_BLOCK;
+    uint32_t block_cells = MORTON_BLOCK * MORTON_BLOCK;
+    layout->size = size;
+    layout->cells = morton_cells(size);
+    layout->row = arena_alloc(arena, (size_t)size * sizeof(uint32_t));
+    layout->col = arena_alloc(arena, (size_t)size * sizeof(uint32_t));
+    for (int i = 0; i < size; i++) {
+        uint32_t block = (uint32_t)i / MORTON_BLOCK, inner = spread_bits((uint32_t)i % MORTON_BLOCK);
+        layout->row[i] = block * blocks * block_cells + (inner << 1);
+        layout->col[i] = block * block_cells + inner;
+    }
+}
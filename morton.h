@@ -0,0 +1,37 @@
+#ifndef MORTON_H
+#define MORTON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "arena.h"
+
+// Ordre de Morton par blocs pour les grandes grilles en mémoire : la grille est découpée en
+// blocs de MORTON_BLOCK x MORTON_BLOCK cases rangés ligne par ligne, et les cases d'un bloc
+// suivent la courbe en Z (bits de x et de y entrelacés). Les voisins N et S d'une case sont
+// alors presque toujours dans le même bloc (1 Ko d'entiers) au lieu d'être une ligne de grille
+// plus loin. Les blocs du bord sont complétés : les cases hors grille existent dans les couches.
+// L'indice d'une case est la somme de deux tables, une par coordonnée.
+
+#define MORTON_BLOCK 16
+#define MORTON_DEFAULT_MIN_SIZE 256
+
+// Taille de grille à partir de laquelle grilles et recherche passent en ordre de Morton (0 : jamais)
+extern int morton_min_size;
+
+typedef struct {
+    int size;
+    size_t cells;     // cases rangées, blocs complétés compris
+    uint32_t* row;    // part de l'indice due à x (blocs au-dessus, bits de x dans le bloc)
+    uint32_t* col;    // part due à y
+} MortonLayout;
+
+static inline uint32_t morton_index(const MortonLayout* layout, int x, int y) {
+    return layout->row[x] + layout->col[y];
+}
+
+bool morton_wanted(int size);
+size_t morton_cells(int size);
+void morton_init(MortonLayout* layout, int size, Arena* arena);
+
+#endif
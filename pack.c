@@ -0,0 +1,602 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "arena.h"
+#include "level.h"
+#include "pack.h"
+#include "queue.h"
+#include "solver.h"
+#include "stats.h"
+#include "trace.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+static const char* stage_names[PACK_STAGES] = {"generation", "resolution", "doublons", "difficulte", "ecriture"};
+
+typedef struct {
+    uint64_t index;                // numéro du tirage : fixe le contenu et l'ordre de préférence
+    Level level;
+    uint64_t hash;                 // empreinte de la forme canonique (parmi les 8 symétries)
+    int cells;                     // cases à couvrir
+    int starts;
+    unsigned long long difficulty; // noeuds jusqu'à la première solution avec le meilleur ordre
+} PackItem;
+
+// Empreintes déjà vues, avec le plus petit tirage de chaque classe de symétrie
+typedef struct {
+    _Atomic uint64_t hash;         // 0 : case libre
+    _Atomic uint64_t index;
+} DedupSlot;
+
+typedef struct {
+    _Atomic uint64_t items_in;
+    _Atomic uint64_t items_out;
+    _Atomic uint64_t busy_ns;
+    _Atomic uint64_t wait_in_ns;   // file amont vide
+    _Atomic uint64_t wait_out_ns;  // file aval pleine (contre-pression)
+} StageStats;
+
+typedef struct Pipeline Pipeline;
+
+typedef struct {
+    Pipeline* pipeline;
+    PackStage stage;
+    pthread_t thread;
+} StageWorker;
+
+struct Pipeline {
+    const PackOptions* options;
+    Queue queues[PACK_WRITE];      // queues[s] : sortie de l'étape s
+    StageStats stats[PACK_STAGES];
+    DedupSlot* seen;
+    size_t seen_mask;
+    _Atomic uint64_t next_index;
+    _Atomic uint64_t superseded;   // niveaux transmis puis remplacés par un tirage antérieur
+    _Atomic uint64_t live;         // niveaux tirés qui n'ont pas été écartés (en vol ou gardés)
+    atomic_bool stop;
+};
+
+static uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+static uint32_t next_random(uint64_t* state) {
+    *state = mix64(*state);
+    return (uint32_t)(*state >> 32);
+}
+
+static void pack_item_free(PackItem* item) {
+    level_free(&item->level);
+    free(item);
+}
+
+//tirer un niveau : des chaînes tracées au hasard, de valeurs croissantes, le reste vide
+static PackItem* generate_item(const PackOptions* options, uint64_t index) {
+    static const int dx[4] = {-1, 1, 0, 0};
+    static const int dy[4] = {0, 0, 1, -1};
+    PackItem* item = calloc(1, sizeof(PackItem));
+    int n = options->size;
+    int* values = item ? malloc((size_t)n * n * sizeof(int)) : NULL;
+    if (!values) {
+        free(item);
+        return NULL;
+    }
+    uint64_t rng = mix64(options->seed) ^ mix64(index);
+    for (int c = 0; c < n * n; c++) {
+        values[c] = -1;
+    }
+    for (int attempt = 0; attempt < n * n; attempt++) {
+        int x = (int)(next_random(&rng) % (uint32_t)n), y = (int)(next_random(&rng) % (uint32_t)n);
+        if (values[x * n + y] != -1) {
+            continue;
+        }
+        values[x * n + y] = 0;
+        int value = 0;
+        for (int length = 0; length < n * 2; length++) {
+            int d = (int)(next_random(&rng) % 4);
+            int nx = x + dx[d], ny = y + dy[d];
+            if (nx < 0 || nx >= n || ny < 0 || ny >= n || values[nx * n + ny] != -1) {
+                break;
+            }
+            value += value == 0 ? 1 : (int)(next_random(&rng) % 3);
+            values[nx * n + ny] = value;
+            x = nx;
+            y = ny;
+        }
+    }
+    item->index = index;
+    item->level.size = n;
+    item->level.values = values;
+    for (int c = 0; c < n * n; c++) {
+        item->cells += values[c] > 0;
+        item->starts += values[c] == 0;
+    }
+    return item;
+}
+
+//garder les niveaux valides et non triviaux dont une solution est retrouvée
+//(la recherche d'abord, le solveur SAT pour les grilles où elle s'épuise)
+static bool solve_item(const PackOptions* options, PackItem* item, Arena* scratch) {
+    char error[160];
+    if (item->cells < item->level.size || !level_validate(&item->level, error, sizeof(error))) {
+        return false;
+    }
+    SolveOptions solve;
+    solve_options_default(&solve);
+    solve.max_nodes = options->max_nodes;
+    solve.scratch = scratch;
+    SolveResult result = {0};
+    SolveStatus status = solve_level(&item->level, &solve, &result);
+    if (status == SOLVE_CANCELLED) {
+        solve_result_free(&result);
+        solve.engine = ENGINE_SAT;
+        status = solve_level(&item->level, &solve, &result);
+    }
+    solve_result_free(&result);
+    return status == SOLVE_FOUND;
+}
+
+//valeur de la case (r, c) de la grille transformée par la symétrie t du carré
+static int transformed_value(const Level* level, int t, int r, int c) {
+    int m = level->size - 1;
+    switch (t) {
+        case 0: return level_value(level, r, c);
+        case 1: return level_value(level, c, m - r);
+        case 2: return level_value(level, m - r, m - c);
+        case 3: return level_value(level, m - c, r);
+        case 4: return level_value(level, r, m - c);
+        case 5: return level_value(level, m - r, c);
+        case 6: return level_value(level, c, r);
+        default: return level_value(level, m - c, m - r);
+    }
+}
+
+//empreinte de la plus petite des 8 images du niveau (les règles ne dépendent pas de l'orientation)
+static uint64_t canonical_hash(const Level* level) {
+    int n = level->size;
+    int best = 0;
+    for (int t = 1; t < 8; t++) {
+        int order = 0;
+        for (int c = 0; c < n * n && order == 0; c++) {
+            int a = transformed_value(level, t, c / n, c % n), b = transformed_value(level, best, c / n, c % n);
+            order = (a > b) - (a < b);
+        }
+        if (order < 0) {
+            best = t;
+        }
+    }
+    uint64_t hash = 14695981039346656037ull ^ (uint64_t)n;
+    for (int c = 0; c < n * n; c++) {
+        hash = (hash ^ (uint32_t)transformed_value(level, best, c / n, c % n)) * 1099511628211ull;
+    }
+    return hash ? hash : 1;
+}
+
+//noter le tirage pour son empreinte ; false si un tirage antérieur de la même classe existe déjà
+static bool dedup_claim(Pipeline* p, uint64_t hash, uint64_t index) {
+    for (size_t i = hash & p->seen_mask;; i = (i + 1) & p->seen_mask) {
+        DedupSlot* slot = &p->seen[i];
+        uint64_t current = atomic_load(&slot->hash);
+        if (current == 0) {
+            uint64_t empty = 0;
+            if (!atomic_compare_exchange_strong(&slot->hash, &empty, hash) && empty != hash) {
+                continue; // case prise entre-temps par une autre empreinte
+            }
+        } else if (current != hash) {
+            continue;
+        }
+        uint64_t kept = atomic_load(&slot->index);
+        while (index < kept) {
+            if (atomic_compare_exchange_weak(&slot->index, &kept, index)) {
+                if (kept != UINT64_MAX) {
+                    atomic_fetch_add(&p->superseded, 1); // l'ancien sera retiré à l'écriture
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+static uint64_t dedup_kept(const Pipeline* p, uint64_t hash) {
+    for (size_t i = hash & p->seen_mask;; i = (i + 1) & p->seen_mask) {
+        uint64_t current = atomic_load(&p->seen[i].hash);
+        if (current == hash || current == 0) {
+            return current ? atomic_load(&p->seen[i].index) : UINT64_MAX;
+        }
+    }
+}
+
+//difficulté : le moins de noeuds qu'il faut à une des heuristiques pour trouver une solution
+//(max_nodes si aucune n'y arrive)
+static void grade_item(const PackOptions* options, PackItem* item, Arena* scratch) {
+    SolveOptions solve;
+    solve_options_default(&solve);
+    solve.scratch = scratch;
+    item->difficulty = options->max_nodes;
+    for (int o = 0; o < ORDER_COUNT; o++) {
+        solve.order = (MoveOrder)o;
+        solve.max_nodes = item->difficulty; // inutile d'aller plus loin que le meilleur ordre
+        SolveResult result = {0};
+        if (solve_level(&item->level, &solve, &result) == SOLVE_FOUND && result.nodes < item->difficulty) {
+            item->difficulty = result.nodes;
+        }
+        solve_result_free(&result);
+    }
+}
+
+//traiter un élément ; false s'il est écarté
+static bool process_item(Pipeline* p, PackStage stage, PackItem* item, Arena* scratch) {
+    switch (stage) {
+        case PACK_SOLVE:
+            return solve_item(p->options, item, scratch);
+        case PACK_DEDUP:
+            item->hash = canonical_hash(&item->level);
+            return dedup_claim(p, item->hash, item->index);
+        case PACK_GRADE:
+            grade_item(p->options, item, scratch);
+            return true;
+        default:
+            return true;
+    }
+}
+
+static void* stage_loop(void* arg) {
+    StageWorker* w = arg;
+    trace_thread_name(stage_names[w->stage]);
+    Pipeline* p = w->pipeline;
+    Queue* out = &p->queues[w->stage];
+    uint64_t in_count = 0, out_count = 0, busy = 0, wait_in = 0, wait_out = 0;
+    Arena scratch = {0};
+
+    if (w->stage == PACK_GENERATE) {
+        // tous les tirages sont menés au bout (le paquet ne dépend pas des threads) : on ne tire
+        // pas plus que ce qu'il manque, en comptant ce qui est encore en vol dans les étapes
+        for (int attempt = 0; !atomic_load(&p->stop);) {
+            if (atomic_load(&p->live) >= (uint64_t)p->options->target + atomic_load(&p->superseded)) {
+                uint64_t start = stats_now_ns();
+                queue_backoff(attempt++);
+                wait_out += stats_now_ns() - start;
+                continue;
+            }
+            attempt = 0;
+            atomic_fetch_add(&p->live, 1);
+            uint64_t index = atomic_fetch_add(&p->next_index, 1);
+            if (index >= p->options->max_attempts) {
+                atomic_fetch_sub(&p->live, 1);
+                break;
+            }
+            uint64_t start = stats_now_ns();
+            PackItem* item = generate_item(p->options, index);
+            busy += stats_now_ns() - start;
+            in_count++;
+            if (item) {
+                out_count++;
+                wait_out += queue_push(out, item);
+            } else {
+                atomic_fetch_sub(&p->live, 1);
+            }
+        }
+    } else {
+        Queue* in = &p->queues[w->stage - 1];
+        void* item;
+        while (queue_pop(in, &item, &wait_in)) {
+            in_count++;
+            uint64_t start = stats_now_ns();
+            bool keep = process_item(p, w->stage, item, &scratch);
+            busy += stats_now_ns() - start;
+            if (keep) {
+                out_count++;
+                wait_out += queue_push(out, item);
+            } else {
+                pack_item_free(item);
+                atomic_fetch_sub(&p->live, 1);
+            }
+        }
+    }
+    queue_producer_done(out);
+    arena_free(&scratch);
+
+    StageStats* stats = &p->stats[w->stage];
+    atomic_fetch_add(&stats->items_in, in_count);
+    atomic_fetch_add(&stats->items_out, out_count);
+    atomic_fetch_add(&stats->busy_ns, busy);
+    atomic_fetch_add(&stats->wait_in_ns, wait_in);
+    atomic_fetch_add(&stats->wait_out_ns, wait_out);
+    return NULL;
+}
+
+typedef struct {
+    PackItem** items;
+    size_t count;
+    size_t capacity;
+} ItemList;
+
+static bool item_list_push(ItemList* list, PackItem* item) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 64;
+        PackItem** items = realloc(list->items, capacity * sizeof(PackItem*));
+        if (!items) {
+            return false;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = item;
+    return true;
+}
+
+//une passe du pipeline : les étapes tournent jusqu'à ce que l'écriture ait assez de niveaux
+static bool run_round(Pipeline* p, ItemList* kept) {
+    const PackOptions* options = p->options;
+    int ready = 0;
+    while (ready < PACK_WRITE && queue_init(&p->queues[ready], (size_t)options->queue_capacity, options->workers[ready])) {
+        ready++;
+    }
+    if (ready < PACK_WRITE) {
+        printf("Erreur : memoire insuffisante pour les files du pipeline\n");
+        while (ready-- > 0) {
+            queue_free(&p->queues[ready]);
+        }
+        return false;
+    }
+    bool ok = true;
+    atomic_store(&p->superseded, 0);
+    atomic_store(&p->live, kept->count);
+    atomic_store(&p->stop, false);
+
+    int total = 0;
+    for (int s = 0; s < PACK_WRITE; s++) {
+        total += options->workers[s];
+    }
+    StageWorker* workers = calloc((size_t)total, sizeof(StageWorker));
+    ok = workers != NULL;
+    int started = 0;
+    for (int s = 0; ok && s < PACK_WRITE; s++) {
+        for (int t = 0; t < options->workers[s]; t++) {
+            workers[started] = (StageWorker){p, (PackStage)s, 0};
+            if (pthread_create(&workers[started].thread, NULL, stage_loop, &workers[started]) != 0) {
+                printf("Erreur : impossible de demarrer un thread de l'etape %s\n", stage_names[s]);
+                ok = false;
+                break;
+            }
+            started++;
+        }
+    }
+    if (!ok) {
+        // les threads déjà lancés s'arrêtent : plus de tirage, et les files sans producteur se ferment
+        atomic_store(&p->stop, true);
+        for (int s = 0; s < PACK_WRITE; s++) {
+            int missing = options->workers[s];
+            for (int t = 0; t < started; t++) {
+                missing -= workers[t].stage == (PackStage)s;
+            }
+            atomic_fetch_sub(&p->queues[s].producers, missing);
+        }
+    }
+
+    // étape d'écriture, sur ce thread
+    StageStats* stats = &p->stats[PACK_WRITE];
+    uint64_t wait_in = 0, busy = 0;
+    void* item;
+    while (queue_pop(&p->queues[PACK_WRITE - 1], &item, &wait_in)) {
+        uint64_t start = stats_now_ns();
+        atomic_fetch_add(&stats->items_in, 1);
+        if (!item_list_push(kept, item)) {
+            pack_item_free(item);
+            ok = false;
+        }
+        if (kept->count >= (size_t)options->target + atomic_load(&p->superseded)) {
+            atomic_store(&p->stop, true); // les tirages s'arrêtent, les étapes se vident
+        }
+        busy += stats_now_ns() - start;
+    }
+    atomic_fetch_add(&stats->wait_in_ns, wait_in);
+    atomic_fetch_add(&stats->busy_ns, busy);
+
+    for (int t = 0; t < started; t++) {
+        pthread_join(workers[t].thread, NULL);
+    }
+    free(workers);
+    for (int s = 0; s < PACK_WRITE; s++) {
+        queue_free(&p->queues[s]);
+    }
+    return ok;
+}
+
+static int compare_index(const void* a, const void* b) {
+    const PackItem* x = *(PackItem* const*)a;
+    const PackItem* y = *(PackItem* const*)b;
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+static int compare_difficulty(const void* a, const void* b) {
+    const PackItem* x = *(PackItem* const*)a;
+    const PackItem* y = *(PackItem* const*)b;
+    if (x->difficulty != y->difficulty) {
+        return x->difficulty < y->difficulty ? -1 : 1;
+    }
+    if (x->cells != y->cells) {
+        return x->cells < y->cells ? -1 : 1;
+    }
+    return compare_index(a, b);
+}
+
+//retirer les niveaux remplacés par un tirage antérieur de la même classe de symétrie
+static void drop_superseded(const Pipeline* p, ItemList* kept) {
+    size_t count = 0;
+    for (size_t i = 0; i < kept->count; i++) {
+        if (dedup_kept(p, kept->items[i]->hash) == kept->items[i]->index) {
+            kept->items[count++] = kept->items[i];
+        } else {
+            pack_item_free(kept->items[i]);
+        }
+    }
+    kept->count = count;
+}
+
+static bool write_level(const char* filename, const Level* level) {
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        printf("Erreur : impossible d'ecrire %s\n", filename);
+        return false;
+    }
+    bool written = level_write(file, level);
+    return fclose(file) == 0 && written;
+}
+
+//écrire le paquet : level1.txt, level2.txt... par difficulté croissante, et un index
+static bool write_pack(const PackOptions* options, PackItem** items, size_t count) {
+#ifdef _WIN32
+    int made = _mkdir(options->output_dir);
+#else
+    int made = mkdir(options->output_dir, 0755);
+#endif
+    if (made != 0 && errno != EEXIST) {
+        printf("Erreur : impossible de creer le repertoire %s\n", options->output_dir);
+        return false;
+    }
+    char filename[512];
+    snprintf(filename, sizeof(filename), "%s/index.txt", options->output_dir);
+    FILE* index = fopen(filename, "w");
+    if (!index) {
+        printf("Erreur : impossible d'ecrire %s\n", filename);
+        return false;
+    }
+    fprintf(index, "# niveau tirage cases departs noeuds (graine %u, grilles %dx%d)\n", options->seed,
+            options->size, options->size);
+    bool ok = true;
+    for (size_t i = 0; ok && i < count; i++) {
+        snprintf(filename, sizeof(filename), "%s/level%zu.txt", options->output_dir, i + 1);
+        ok = write_level(filename, &items[i]->level);
+        fprintf(index, "%zu %llu %d %d %llu\n", i + 1, (unsigned long long)items[i]->index, items[i]->cells,
+                items[i]->starts, items[i]->difficulty);
+    }
+    return fclose(index) == 0 && ok;
+}
+
+static void print_stage_report(const Pipeline* p, double seconds) {
+    printf("\n%-12s %7s %9s %9s %10s %11s %14s %13s\n", "Etape", "threads", "entrees", "sorties", "debit/s",
+           "occupation", "attente amont", "attente aval");
+    for (int s = 0; s < PACK_STAGES; s++) {
+        const StageStats* st = &p->stats[s];
+        int threads = s == PACK_WRITE ? 1 : p->options->workers[s];
+        uint64_t in = atomic_load(&st->items_in);
+        double wall = seconds * threads;
+        printf("%-12s %7d %9llu %9llu %10.0f %10.1f%% %12.1f s %11.1f s\n", stage_names[s], threads,
+               (unsigned long long)in, (unsigned long long)atomic_load(&st->items_out), in / seconds,
+               wall > 0 ? 100.0 * atomic_load(&st->busy_ns) / 1e9 / wall : 0.0,
+               atomic_load(&st->wait_in_ns) / 1e9 / threads, atomic_load(&st->wait_out_ns) / 1e9 / threads);
+    }
+}
+
+void pack_options_default(PackOptions* options) {
+    long cpus = 4;
+#ifndef _WIN32
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpus = cpus > 0 ? cpus : 4;
+#endif
+    options->target = 30;
+    options->size = 6;
+    options->seed = 1;
+    options->workers[PACK_GENERATE] = 1;
+    options->workers[PACK_SOLVE] = (int)cpus;
+    options->workers[PACK_DEDUP] = 1;
+    options->workers[PACK_GRADE] = cpus / 2 > 0 ? (int)(cpus / 2) : 1;
+    options->workers[PACK_WRITE] = 1;
+    options->queue_capacity = 256;
+    options->max_nodes = 500000;
+    options->max_attempts = 0; // 0 : 10000 tirages par niveau demandé
+    options->output_dir = NULL;
+}
+
+//fabriquer le paquet de niveaux décrit par options
+int run_pack(const PackOptions* options) {
+    PackOptions o = *options;
+    if (o.target < 1 || o.size < 2 || o.size > 64 || o.queue_capacity < 2 || !o.output_dir) {
+        printf("Erreur : parametres du paquet de niveaux invalides\n");
+        return 1;
+    }
+    for (int s = 0; s < PACK_WRITE; s++) {
+        if (o.workers[s] < 1) {
+            printf("Erreur : l'etape %s doit avoir au moins un thread\n", stage_names[s]);
+            return 1;
+        }
+    }
+    o.workers[PACK_WRITE] = 1;
+    if (o.max_attempts == 0) {
+        o.max_attempts = (unsigned long long)o.target * 10000;
+    }
+
+    Pipeline* p = calloc(1, sizeof(Pipeline));
+    // chaque classe retenue occupe une case : le paquet, plus ce qui peut être en vol dans les files
+    size_t in_flight = (size_t)o.target + (size_t)o.queue_capacity * PACK_WRITE + 1024;
+    size_t slots = 2;
+    while (slots < in_flight * 2) {
+        slots *= 2;
+    }
+    if (p) {
+        p->seen = calloc(slots, sizeof(DedupSlot));
+    }
+    if (!p || !p->seen) {
+        printf("Erreur : memoire insuffisante pour le paquet de niveaux\n");
+        free(p);
+        return 1;
+    }
+    p->options = &o;
+    p->seen_mask = slots - 1;
+    for (size_t i = 0; i < slots; i++) {
+        atomic_init(&p->seen[i].hash, 0);
+        atomic_init(&p->seen[i].index, UINT64_MAX);
+    }
+    atomic_init(&p->next_index, 0);
+
+    printf("Paquet de %d niveaux %dx%d (graine %u) : %d/%d/%d/%d threads (generation/resolution/doublons/difficulte)\n",
+           o.target, o.size, o.size, o.seed, o.workers[PACK_GENERATE], o.workers[PACK_SOLVE], o.workers[PACK_DEDUP],
+           o.workers[PACK_GRADE]);
+    uint64_t start = stats_now_ns();
+    ItemList kept = {0};
+    bool ok = true;
+    // un tirage antérieur arrivé après l'arrêt peut en remplacer un autre : on relance alors une passe
+    while (ok && kept.count < (size_t)o.target && atomic_load(&p->next_index) < o.max_attempts) {
+        ok = run_round(p, &kept);
+        drop_superseded(p, &kept);
+    }
+    double seconds = (double)(stats_now_ns() - start) / 1e9;
+
+    // les premiers tirages retenus, puis du plus facile au plus difficile
+    qsort(kept.items, kept.count, sizeof(PackItem*), compare_index);
+    size_t count = kept.count < (size_t)o.target ? kept.count : (size_t)o.target;
+    qsort(kept.items, count, sizeof(PackItem*), compare_difficulty);
+    atomic_store(&p->stats[PACK_WRITE].items_out, count);
+    if (ok && count > 0) {
+        ok = write_pack(&o, kept.items, count);
+    }
+    print_stage_report(p, seconds);
+    uint64_t drawn = atomic_load(&p->stats[PACK_GENERATE].items_in);
+    printf("\n%zu niveaux ecrits dans %s (%llu tirages en %.2f s)\n", count, o.output_dir,
+           (unsigned long long)drawn, seconds);
+    if (count < (size_t)o.target) {
+        printf("Attention : seulement %zu niveaux retenus sur %d demandes\n", count, o.target);
+    }
+
+    for (size_t i = 0; i < kept.count; i++) {
+        pack_item_free(kept.items[i]);
+    }
+    free(kept.items);
+    free(p->seen);
+    free(p);
+    return ok && count == (size_t)o.target ? 0 : 1;
+}
@@ -0,0 +1,33 @@
+#ifndef PACK_H
+#define PACK_H
+
+// Fabrication d'un paquet de niveaux : génération, résolution, élimination des doublons,
+// classement par difficulté et écriture, chaque étape sur ses propres threads et reliée
+// à la suivante par une file bornée sans verrou (queue.h). Le paquet ne dépend que de la
+// graine et du nombre de niveaux demandés, pas du nombre de threads : parmi les niveaux
+// retenus, ce sont toujours ceux des premiers tirages qui sont gardés.
+
+typedef enum {
+    PACK_GENERATE,   // tirage de chaînes au hasard (niveau soluble par construction)
+    PACK_SOLVE,      // validation et recherche d'une solution (unicité non vérifiée)
+    PACK_DEDUP,      // une seule grille par classe de symétrie (rotations, miroirs)
+    PACK_GRADE,      // difficulté : noeuds jusqu'à la première solution, meilleur ordre
+    PACK_WRITE,      // tri et écriture des fichiers (un seul thread)
+    PACK_STAGES
+} PackStage;
+
+typedef struct {
+    int target;                   // nombre de niveaux du paquet
+    int size;                     // côté des grilles
+    unsigned seed;
+    int workers[PACK_STAGES];     // threads par étape (PACK_WRITE : toujours 1)
+    int queue_capacity;           // cases de chaque file entre deux étapes
+    unsigned long long max_nodes; // au-delà, le niveau est jugé trop dur et écarté
+    unsigned long long max_attempts; // tirages au plus
+    const char* output_dir;
+} PackOptions;
+
+void pack_options_default(PackOptions* options);
+int run_pack(const PackOptions* options);
+
+#endif
@@ -0,0 +1,179 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "prefetch.h"
+#include "stats.h"
+#include "trace.h"
+
+static struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool running;
+    bool stopping;
+    bool presolve;
+    int requested;          // niveau demandé au thread de chargement (0 : aucun), protégé par lock
+    char filename[256];
+    int last_requested;     // dernier niveau demandé, lu et écrit par le thread de jeu seulement
+    PreparedLevel* active;  // préparation en cours (NULL : aucune), protégée par lock
+    _Atomic(PreparedLevel*) slot; // niveau prêt à être joué
+    Arena scratch;          // mémoire de travail du solveur, utilisée par le thread de chargement seulement
+} prefetch = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+};
+
+//lire, valider et éventuellement résoudre un niveau
+static PreparedLevel* prepare_level(int number, const char* filename) {
+    STAT_TIMER_START(load_start);
+    TRACE_START(load_trace);
+    PreparedLevel* prepared = calloc(1, sizeof(PreparedLevel));
+    if (!prepared) {
+        return NULL;
+    }
+    prepared->number = number;
+    pthread_mutex_lock(&prefetch.lock);
+    prefetch.active = prepared;
+    pthread_mutex_unlock(&prefetch.lock);
+    prepared->loaded = level_load_file(filename, &prepared->level, prepared->error, sizeof(prepared->error));
+    if (!prepared->loaded) {
+        return prepared;
+    }
+    STAT_ADD(STAT_LEVELS_LOADED, 1);
+    STAT_TIMER_RECORD(load_start, STAT_LEVEL_LOAD_NS, STAT_LEVEL_LOAD_MAX_NS);
+    TRACE_END(load_trace, TRACE_LEVEL_LOAD);
+    prepared->valid = level_validate(&prepared->level, prepared->error, sizeof(prepared->error));
+    if (prepared->valid && prefetch.presolve) {
+        SolveOptions options;
+        SolveResult result = {0};
+        solve_options_default(&options);
+        options.max_nodes = PREFETCH_MAX_NODES;
+        options.cancel = &prepared->cancel;
+        options.scratch = &prefetch.scratch;
+        prepared->status = solve_level(&prepared->level, &options, &result);
+        prepared->nodes = result.nodes;
+        prepared->solved = prepared->status != SOLVE_CANCELLED;
+        solve_result_free(&result);
+    }
+    return prepared;
+}
+
+static void* prefetch_loop(void* arg) {
+    (void)arg;
+    trace_thread_name("chargement");
+    for (;;) {
+        pthread_mutex_lock(&prefetch.lock);
+        while (!prefetch.stopping && prefetch.requested == 0) {
+            pthread_cond_wait(&prefetch.wake, &prefetch.lock);
+        }
+        if (prefetch.stopping) {
+            pthread_mutex_unlock(&prefetch.lock);
+            break;
+        }
+        int number = prefetch.requested;
+        char filename[sizeof(prefetch.filename)];
+        memcpy(filename, prefetch.filename, sizeof(filename));
+        prefetch.requested = 0;
+        pthread_mutex_unlock(&prefetch.lock);
+
+        PreparedLevel* prepared = prepare_level(number, filename);
+        pthread_mutex_lock(&prefetch.lock);
+        prefetch.active = NULL;
+        pthread_mutex_unlock(&prefetch.lock);
+        if (!prepared || atomic_load(&prepared->cancel)) {
+            prefetch_release(prepared); // dépassé pendant la préparation
+            continue;
+        }
+        // dépôt sans verrou : un niveau préparé mais jamais récupéré est remplacé
+        prefetch_release(atomic_exchange(&prefetch.slot, prepared));
+    }
+    return NULL;
+}
+
+//démarrer le thread de chargement
+void prefetch_start(bool presolve) {
+    if (prefetch.running) {
+        return;
+    }
+    prefetch.presolve = presolve;
+    prefetch.stopping = false;
+    prefetch.running = pthread_create(&prefetch.thread, NULL, prefetch_loop, NULL) == 0;
+}
+
+//demander la préparation d'un niveau (sans effet si déjà demandé)
+void prefetch_request(int number, const char* filename) {
+    if (!prefetch.running || number == prefetch.last_requested) {
+        return;
+    }
+    prefetch.last_requested = number;
+    pthread_mutex_lock(&prefetch.lock);
+    if (prefetch.active && prefetch.active->number != number) {
+        atomic_store(&prefetch.active->cancel, true);
+    }
+    prefetch.requested = number;
+    strncpy(prefetch.filename, filename, sizeof(prefetch.filename) - 1);
+    prefetch.filename[sizeof(prefetch.filename) - 1] = '\0';
+    pthread_cond_signal(&prefetch.wake);
+    pthread_mutex_unlock(&prefetch.lock);
+}
+
+//récupérer le niveau préparé s'il est prêt (NULL sinon : le charger soi-même)
+PreparedLevel* prefetch_take(int number) {
+    if (!prefetch.running) {
+        return NULL;
+    }
+    PreparedLevel* prepared = atomic_exchange(&prefetch.slot, NULL);
+    if (prepared && prepared->number != number) {
+        // autre niveau (souvent le suivant, quand le courant est rechargé) : remis en place,
+        // sauf si le thread de chargement a déjà déposé plus récent entre-temps
+        PreparedLevel* empty = NULL;
+        if (!atomic_compare_exchange_strong(&prefetch.slot, &empty, prepared)) {
+            if (prepared->number == prefetch.last_requested) {
+                prefetch.last_requested = 0; // à redemander
+            }
+            prefetch_release(prepared);
+        }
+        prepared = NULL;
+    }
+    if (!prepared && number == prefetch.last_requested) {
+        // chargé sans le thread : la préparation de ce niveau, demandée ou en cours, est abandonnée
+        pthread_mutex_lock(&prefetch.lock);
+        if (prefetch.requested == number) {
+            prefetch.requested = 0;
+        }
+        if (prefetch.active && prefetch.active->number == number) {
+            atomic_store(&prefetch.active->cancel, true);
+        }
+        pthread_mutex_unlock(&prefetch.lock);
+    }
+    if (number == prefetch.last_requested) {
+        prefetch.last_requested = 0;
+    }
+    return prepared;
+}
+
+//libérer un niveau préparé
+void prefetch_release(PreparedLevel* prepared) {
+    if (prepared) {
+        level_free(&prepared->level);
+        free(prepared);
+    }
+}
+
+//arrêter le thread de chargement (une résolution en cours est interrompue)
+void prefetch_stop(void) {
+    if (!prefetch.running) {
+        return;
+    }
+    pthread_mutex_lock(&prefetch.lock);
+    if (prefetch.active) {
+        atomic_store(&prefetch.active->cancel, true);
+    }
+    prefetch.stopping = true;
+    pthread_cond_signal(&prefetch.wake);
+    pthread_mutex_unlock(&prefetch.lock);
+    pthread_join(prefetch.thread, NULL);
+    arena_free(&prefetch.scratch);
+    prefetch_release(atomic_exchange(&prefetch.slot, NULL));
+    prefetch.running = false;
+}
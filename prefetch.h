@@ -0,0 +1,33 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stdbool.h>
+#include "level.h"
+#include "solver.h"
+
+// Chargement du niveau suivant en arrière-plan pendant que le joueur termine le niveau courant.
+// Le thread de chargement lit, valide et (optionnellement) résout le niveau, puis le dépose
+// dans un emplacement unique échangé sans verrou avec le thread de jeu. Une préparation que
+// le jeu n'attend plus (autre niveau demandé, niveau chargé sans elle) est interrompue.
+
+#define PREFETCH_MAX_NODES 2000000ULL // au-delà, la résolution est abandonnée et le niveau déposé tel quel
+
+typedef struct {
+    int number;
+    Level level;
+    bool loaded;          // lecture réussie
+    bool valid;           // règles du jeu respectées
+    char error[160];
+    bool solved;          // résolution effectuée (SOLVE_CANCELLED sans solved : PREFETCH_MAX_NODES atteint)
+    SolveStatus status;
+    unsigned long long nodes;
+    atomic_bool cancel;   // préparation dépassée : le niveau n'est plus attendu
+} PreparedLevel;
+
+void prefetch_start(bool presolve);
+void prefetch_request(int number, const char* filename);
+PreparedLevel* prefetch_take(int number);
+void prefetch_release(PreparedLevel* prepared);
+void prefetch_stop(void);
+
+#endif
@@ -0,0 +1,123 @@
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+#include "queue.h"
+#include "stats.h"
+
+//créer une file d'au moins capacity cases (arrondi à une puissance de 2)
+bool queue_init(Queue* q, size_t capacity, int producers) {
+    size_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+    q->slots = malloc(size * sizeof(QueueSlot));
+    if (!q->slots) {
+        return false;
+    }
+    for (size_t i = 0; i < size; i++) {
+        atomic_init(&q->slots[i].sequence, i);
+        q->slots[i].item = NULL;
+    }
+    q->mask = size - 1;
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->head, 0);
+    atomic_init(&q->producers, producers);
+    return true;
+}
+
+void queue_free(Queue* q) {
+    free(q->slots);
+    q->slots = NULL;
+}
+
+//déposer un élément, false si la file est pleine
+bool queue_try_push(Queue* q, void* item) {
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    for (;;) {
+        QueueSlot* slot = &q->slots[pos & q->mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            // case libre pour ce tour : on la réserve en avançant la queue
+            if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                slot->item = item;
+                atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // la case n'a pas encore été lue : file pleine
+        } else {
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+        }
+    }
+}
+
+//retirer un élément, false si la file est vide
+bool queue_try_pop(Queue* q, void** item) {
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    for (;;) {
+        QueueSlot* slot = &q->slots[pos & q->mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                *item = slot->item;
+                // la case resservira au tour suivant de l'écriture
+                atomic_store_explicit(&slot->sequence, pos + q->mask + 1, memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+        }
+    }
+}
+
+//attendre un peu plus à chaque essai : d'abord céder le processeur, puis dormir
+void queue_backoff(int attempt) {
+    if (attempt < 64) {
+        sched_yield();
+    } else {
+        struct timespec pause = {0, 50000};
+        nanosleep(&pause, NULL);
+    }
+}
+
+//déposer un élément en attendant qu'une case se libère ; renvoie le temps attendu
+uint64_t queue_push(Queue* q, void* item) {
+    if (queue_try_push(q, item)) {
+        return 0;
+    }
+    uint64_t start = stats_now_ns();
+    for (int attempt = 0; !queue_try_push(q, item); attempt++) {
+        queue_backoff(attempt);
+    }
+    return stats_now_ns() - start;
+}
+
+//retirer un élément en attendant qu'il arrive ; false quand la file est fermée et vide
+bool queue_pop(Queue* q, void** item, uint64_t* waited_ns) {
+    if (queue_try_pop(q, item)) {
+        return true;
+    }
+    uint64_t start = stats_now_ns();
+    bool ok = true;
+    for (int attempt = 0; !queue_try_pop(q, item); attempt++) {
+        if (atomic_load_explicit(&q->producers, memory_order_acquire) <= 0) {
+            // plus de producteur : un dernier essai, puisqu'un élément a pu arriver entre-temps
+            ok = queue_try_pop(q, item);
+            break;
+        }
+        queue_backoff(attempt);
+    }
+    *waited_ns += stats_now_ns() - start;
+    return ok;
+}
+
+//signaler qu'un producteur a fini ; le dernier ferme la file
+void queue_producer_done(Queue* q) {
+    atomic_fetch_sub_explicit(&q->producers, 1, memory_order_release);
+}
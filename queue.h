@@ -0,0 +1,37 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// File bornée sans verrou, plusieurs producteurs et plusieurs consommateurs (tableau
+// circulaire dont chaque case porte un numéro de séquence). Une file pleine bloque ses
+// producteurs : l'étape en amont ralentit au rythme de l'étape en aval.
+// La file est fermée quand son dernier producteur a appelé queue_producer_done() ;
+// queue_pop() renvoie alors false une fois la file vidée.
+
+typedef struct {
+    atomic_size_t sequence;
+    void* item;
+} QueueSlot;
+
+typedef struct {
+    QueueSlot* slots;
+    size_t mask;
+    _Alignas(64) atomic_size_t tail;   // prochaine case à écrire
+    _Alignas(64) atomic_size_t head;   // prochaine case à lire
+    _Alignas(64) atomic_int producers; // producteurs encore actifs
+} Queue;
+
+bool queue_init(Queue* q, size_t capacity, int producers);
+void queue_free(Queue* q);
+bool queue_try_push(Queue* q, void* item);
+bool queue_try_pop(Queue* q, void** item);
+uint64_t queue_push(Queue* q, void* item);
+bool queue_pop(Queue* q, void** item, uint64_t* waited_ns);
+void queue_producer_done(Queue* q);
+void queue_backoff(int attempt);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Tirages xorshift32 des outils de test (vérification différentielle, générateur de charge,
+// spectateurs, grilles tuilées de test) : reproductibles à partir d'une graine non nulle.
+static inline uint32_t rng_next(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+#endif
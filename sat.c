@@ -0,0 +1,584 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sat.h"
+
+// Littéraux internes : 2 * variable (à partir de 0), +1 pour la négation
+#define LIT_VAR(lit) ((lit) >> 1)
+#define LIT_NOT(lit) ((lit) ^ 1)
+
+#define VAR_DECAY 0.95
+#define CLAUSE_DECAY 0.999
+#define RESTART_BASE 100      // conflits par unité de la suite de Luby
+#define CANCEL_CHECK 1024     // décisions entre deux contrôles d'interruption
+
+typedef struct {
+    int size;
+    bool learnt;
+    float activity;
+    int lits[];   // lits[0] et lits[1] sont surveillés ; lits[0] est le littéral impliqué
+} Clause;
+
+typedef struct {
+    Clause** data;
+    int count;
+    int capacity;
+} ClauseVec;
+
+struct SatSolver {
+    int vars;
+    int8_t* value;        // par variable : 1 vrai, -1 faux, 0 libre
+    int* level;
+    Clause** reason;
+    bool* phase;          // dernière valeur prise, réutilisée à la décision suivante
+    double* activity;
+    double var_inc;
+    float clause_inc;
+    int* heap;            // variables par activité décroissante
+    int* heap_index;      // position dans le tas, -1 si absente
+    int heap_count;
+    ClauseVec* watches;   // par littéral : clauses à revoir quand il devient faux
+    ClauseVec clauses;
+    ClauseVec learnts;
+    int* trail;
+    int trail_count;
+    int qhead;
+    int* trail_lim;       // début de chaque niveau de décision dans trail
+    int level_count;
+    uint8_t* seen;
+    int* buffer;          // clause apprise en construction
+    int* analyzed;
+    bool* model;
+    bool inconsistent;
+    int max_learnts;
+    unsigned long long decisions;
+    unsigned long long conflicts;
+};
+
+static bool vec_push(ClauseVec* v, Clause* c) {
+    if (v->count == v->capacity) {
+        int capacity = v->capacity ? v->capacity * 2 : 4;
+        Clause** data = realloc(v->data, (size_t)capacity * sizeof(Clause*));
+        if (!data) {
+            return false;
+        }
+        v->data = data;
+        v->capacity = capacity;
+    }
+    v->data[v->count++] = c;
+    return true;
+}
+
+static int lit_value(const SatSolver* s, int lit) {
+    int v = s->value[LIT_VAR(lit)];
+    return lit & 1 ? -v : v;
+}
+
+// ---------------------------------------------------------------------------
+// Tas des variables libres (activité la plus forte en tête)
+// ---------------------------------------------------------------------------
+
+static void heap_swap(SatSolver* s, int i, int j) {
+    int a = s->heap[i], b = s->heap[j];
+    s->heap[i] = b;
+    s->heap[j] = a;
+    s->heap_index[b] = i;
+    s->heap_index[a] = j;
+}
+
+static void heap_up(SatSolver* s, int i) {
+    while (i > 0 && s->activity[s->heap[(i - 1) / 2]] < s->activity[s->heap[i]]) {
+        heap_swap(s, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void heap_down(SatSolver* s, int i) {
+    for (;;) {
+        int best = i, l = 2 * i + 1, r = 2 * i + 2;
+        if (l < s->heap_count && s->activity[s->heap[l]] > s->activity[s->heap[best]]) {
+            best = l;
+        }
+        if (r < s->heap_count && s->activity[s->heap[r]] > s->activity[s->heap[best]]) {
+            best = r;
+        }
+        if (best == i) {
+            return;
+        }
+        heap_swap(s, i, best);
+        i = best;
+    }
+}
+
+static void heap_insert(SatSolver* s, int v) {
+    if (s->heap_index[v] >= 0) {
+        return;
+    }
+    s->heap[s->heap_count] = v;
+    s->heap_index[v] = s->heap_count++;
+    heap_up(s, s->heap_index[v]);
+}
+
+static int heap_pop(SatSolver* s) {
+    int v = s->heap[0];
+    heap_swap(s, 0, --s->heap_count);
+    s->heap_index[v] = -1;
+    heap_down(s, 0);
+    return v;
+}
+
+static void bump_var(SatSolver* s, int v) {
+    if ((s->activity[v] += s->var_inc) > 1e100) {
+        for (int i = 0; i < s->vars; i++) {
+            s->activity[i] *= 1e-100;
+        }
+        s->var_inc *= 1e-100;
+    }
+    if (s->heap_index[v] >= 0) {
+        heap_up(s, s->heap_index[v]);
+    }
+}
+
+static void bump_clause(SatSolver* s, Clause* c) {
+    if ((c->activity += s->clause_inc) > 1e20f) {
+        for (int i = 0; i < s->learnts.count; i++) {
+            s->learnts.data[i]->activity *= 1e-20f;
+        }
+        s->clause_inc *= 1e-20f;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Affectations et propagation
+// ---------------------------------------------------------------------------
+
+static void enqueue(SatSolver* s, int lit, Clause* from) {
+    int v = LIT_VAR(lit);
+    s->value[v] = lit & 1 ? -1 : 1;
+    s->level[v] = s->level_count;
+    s->reason[v] = from;
+    s->trail[s->trail_count++] = lit;
+}
+
+static void backtrack(SatSolver* s, int level) {
+    if (s->level_count <= level) {
+        return;
+    }
+    for (int i = s->trail_count - 1; i >= s->trail_lim[level]; i--) {
+        int v = LIT_VAR(s->trail[i]);
+        s->phase[v] = s->value[v] > 0;
+        s->value[v] = 0;
+        s->reason[v] = NULL;
+        heap_insert(s, v);
+    }
+    s->trail_count = s->trail_lim[level];
+    s->qhead = s->trail_count;
+    s->level_count = level;
+}
+
+static Clause* clause_new(const int* lits, int size, bool learnt) {
+    Clause* c = malloc(sizeof(Clause) + (size_t)size * sizeof(int));
+    if (c) {
+        c->size = size;
+        c->learnt = learnt;
+        c->activity = 0;
+        memcpy(c->lits, lits, (size_t)size * sizeof(int));
+    }
+    return c;
+}
+
+static bool attach(SatSolver* s, Clause* c) {
+    return vec_push(&s->watches[c->lits[0]], c) && vec_push(&s->watches[c->lits[1]], c);
+}
+
+//propager les affectations en attente, renvoie la clause en conflit (NULL sinon)
+static Clause* propagate(SatSolver* s) {
+    while (s->qhead < s->trail_count) {
+        int false_lit = LIT_NOT(s->trail[s->qhead++]);
+        ClauseVec* list = &s->watches[false_lit];
+        int i = 0, j = 0;
+        while (i < list->count) {
+            Clause* c = list->data[i++];
+            if (c->lits[0] == false_lit) {
+                c->lits[0] = c->lits[1];
+                c->lits[1] = false_lit;
+            }
+            if (lit_value(s, c->lits[0]) > 0) {
+                list->data[j++] = c; // déjà satisfaite
+                continue;
+            }
+            bool moved = false;
+            for (int k = 2; k < c->size; k++) {
+                if (lit_value(s, c->lits[k]) >= 0) {
+                    c->lits[1] = c->lits[k];
+                    c->lits[k] = false_lit;
+                    vec_push(&s->watches[c->lits[1]], c);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) {
+                continue;
+            }
+            list->data[j++] = c;
+            if (lit_value(s, c->lits[0]) < 0) {
+                while (i < list->count) {
+                    list->data[j++] = list->data[i++];
+                }
+                list->count = j;
+                return c;
+            }
+            enqueue(s, c->lits[0], c);
+        }
+        list->count = j;
+    }
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Analyse des conflits
+// ---------------------------------------------------------------------------
+
+//un littéral appris est redondant si sa raison ne contient que des littéraux déjà dans la clause
+static bool redundant(const SatSolver* s, int lit) {
+    const Clause* r = s->reason[LIT_VAR(lit)];
+    if (!r) {
+        return false;
+    }
+    for (int k = 1; k < r->size; k++) {
+        int v = LIT_VAR(r->lits[k]);
+        if (!s->seen[v] && s->level[v] > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//clause apprise au premier point d'implication unique, renvoie sa taille et le niveau de retour
+static int analyze(SatSolver* s, Clause* conflict, int* back_level) {
+    int* learnt = s->buffer;
+    int count = 1;
+    int analyzed = 0;
+    int pending = 0;
+    int p = -1;
+    int index = s->trail_count - 1;
+    Clause* c = conflict;
+    do {
+        if (c->learnt) {
+            bump_clause(s, c);
+        }
+        for (int j = p < 0 ? 0 : 1; j < c->size; j++) {
+            int q = c->lits[j];
+            int v = LIT_VAR(q);
+            if (s->seen[v] || s->level[v] == 0) {
+                continue;
+            }
+            bump_var(s, v);
+            s->seen[v] = 1;
+            s->analyzed[analyzed++] = v;
+            if (s->level[v] >= s->level_count) {
+                pending++;
+            } else {
+                learnt[count++] = q;
+            }
+        }
+        while (!s->seen[LIT_VAR(s->trail[index])]) {
+            index--;
+        }
+        p = s->trail[index--];
+        c = s->reason[LIT_VAR(p)];
+        s->seen[LIT_VAR(p)] = 0;
+        pending--;
+    } while (pending > 0);
+    learnt[0] = LIT_NOT(p);
+
+    int kept = 1;
+    for (int i = 1; i < count; i++) {
+        if (!redundant(s, learnt[i])) {
+            learnt[kept++] = learnt[i];
+        }
+    }
+    count = kept;
+    for (int i = 0; i < analyzed; i++) {
+        s->seen[s->analyzed[i]] = 0;
+    }
+
+    *back_level = 0;
+    for (int i = 1; i < count; i++) {
+        int level = s->level[LIT_VAR(learnt[i])];
+        if (level > *back_level) {
+            *back_level = level;
+            int t = learnt[1];
+            learnt[1] = learnt[i];
+            learnt[i] = t;
+        }
+    }
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// Base de clauses apprises
+// ---------------------------------------------------------------------------
+
+static int compare_activity(const void* a, const void* b) {
+    float x = (*(Clause* const*)a)->activity, y = (*(Clause* const*)b)->activity;
+    return (x > y) - (x < y);
+}
+
+//au niveau 0 : oublier la moitié la moins active des clauses apprises et reconstruire les listes
+static void reduce_learnts(SatSolver* s) {
+    qsort(s->learnts.data, (size_t)s->learnts.count, sizeof(Clause*), compare_activity);
+    int half = s->learnts.count / 2;
+    int j = 0;
+    for (int i = 0; i < s->learnts.count; i++) {
+        Clause* c = s->learnts.data[i];
+        if (i < half && c->size > 2) {
+            free(c);
+        } else {
+            s->learnts.data[j++] = c;
+        }
+    }
+    s->learnts.count = j;
+    for (int i = 0; i < s->trail_count; i++) {
+        s->reason[LIT_VAR(s->trail[i])] = NULL; // au niveau 0 les raisons ne servent plus
+    }
+    for (int lit = 0; lit < 2 * s->vars; lit++) {
+        s->watches[lit].count = 0;
+    }
+    for (int i = 0; i < s->clauses.count; i++) {
+        attach(s, s->clauses.data[i]);
+    }
+    for (int i = 0; i < s->learnts.count; i++) {
+        attach(s, s->learnts.data[i]);
+    }
+    s->max_learnts += s->max_learnts / 10;
+}
+
+//suite de Luby : 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+static unsigned long long luby(int x) {
+    int size = 1, seq = 0;
+    while (size < x + 1) {
+        seq++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != x) {
+        size = (size - 1) >> 1;
+        seq--;
+        x = x % size;
+    }
+    return 1ULL << seq;
+}
+
+// ---------------------------------------------------------------------------
+// Interface
+// ---------------------------------------------------------------------------
+
+//créer un solveur pour var_count variables (numérotées 1..var_count)
+SatSolver* sat_new(int var_count) {
+    SatSolver* s = calloc(1, sizeof(SatSolver));
+    if (!s) {
+        return NULL;
+    }
+    size_t n = (size_t)(var_count > 0 ? var_count : 1);
+    s->vars = var_count;
+    s->value = calloc(n, sizeof(int8_t));
+    s->level = calloc(n, sizeof(int));
+    s->reason = calloc(n, sizeof(Clause*));
+    s->phase = calloc(n, sizeof(bool));
+    s->activity = calloc(n, sizeof(double));
+    s->heap = malloc(n * sizeof(int));
+    s->heap_index = malloc(n * sizeof(int));
+    s->watches = calloc(2 * n, sizeof(ClauseVec));
+    s->trail = malloc(n * sizeof(int));
+    s->trail_lim = malloc(n * sizeof(int));
+    s->seen = calloc(n, 1);
+    s->buffer = malloc(n * sizeof(int));
+    s->analyzed = malloc(n * sizeof(int));
+    s->model = calloc(n, sizeof(bool));
+    if (!s->value || !s->level || !s->reason || !s->phase || !s->activity || !s->heap || !s->heap_index ||
+        !s->watches || !s->trail || !s->trail_lim || !s->seen || !s->buffer || !s->analyzed || !s->model) {
+        printf("Erreur : memoire insuffisante pour le solveur SAT (%d variables)\n", var_count);
+        sat_free(s);
+        return NULL;
+    }
+    s->var_inc = 1;
+    s->clause_inc = 1;
+    for (int v = 0; v < var_count; v++) {
+        s->heap_index[v] = -1;
+        heap_insert(s, v);
+    }
+    return s;
+}
+
+void sat_free(SatSolver* s) {
+    if (!s) {
+        return;
+    }
+    for (int i = 0; i < s->clauses.count; i++) {
+        free(s->clauses.data[i]);
+    }
+    for (int i = 0; i < s->learnts.count; i++) {
+        free(s->learnts.data[i]);
+    }
+    if (s->watches) {
+        for (int lit = 0; lit < 2 * s->vars; lit++) {
+            free(s->watches[lit].data);
+        }
+    }
+    free(s->clauses.data);
+    free(s->learnts.data);
+    free(s->watches);
+    free(s->value);
+    free(s->level);
+    free(s->reason);
+    free(s->phase);
+    free(s->activity);
+    free(s->heap);
+    free(s->heap_index);
+    free(s->trail);
+    free(s->trail_lim);
+    free(s->seen);
+    free(s->buffer);
+    free(s->analyzed);
+    free(s->model);
+    free(s);
+}
+
+//ajouter une clause (littéraux DIMACS), false si la formule est devenue insatisfiable
+bool sat_add_clause(SatSolver* s, const int* lits, int count) {
+    if (s->inconsistent) {
+        return false;
+    }
+    backtrack(s, 0);
+    int* clause = s->buffer;
+    int size = 0;
+    for (int i = 0; i < count; i++) {
+        int lit = 2 * (abs(lits[i]) - 1) + (lits[i] < 0);
+        int value = lit_value(s, lit);
+        if (value > 0) {
+            return true; // déjà satisfaite au niveau 0
+        }
+        if (value < 0) {
+            continue;
+        }
+        bool duplicate = false;
+        for (int k = 0; k < size; k++) {
+            if (clause[k] == LIT_NOT(lit)) {
+                return true; // tautologie
+            }
+            duplicate |= clause[k] == lit;
+        }
+        if (!duplicate) {
+            clause[size++] = lit;
+        }
+    }
+    if (size == 0) {
+        s->inconsistent = true;
+        return false;
+    }
+    if (size == 1) {
+        enqueue(s, clause[0], NULL);
+        s->inconsistent = propagate(s) != NULL;
+        return !s->inconsistent;
+    }
+    Clause* c = clause_new(clause, size, false);
+    if (!c || !vec_push(&s->clauses, c) || !attach(s, c)) {
+        printf("Erreur : memoire insuffisante pour le solveur SAT\n");
+        s->inconsistent = true;
+        return false;
+    }
+    return true;
+}
+
+//chercher une affectation satisfaisant toutes les clauses
+SatResult sat_solve(SatSolver* s, const atomic_bool* cancel, unsigned long long max_decisions) {
+    if (s->inconsistent) {
+        return SAT_UNSATISFIABLE;
+    }
+    backtrack(s, 0);
+    if (s->max_learnts == 0) {
+        s->max_learnts = s->clauses.count / 3 + 2000;
+    }
+    int restarts = 0;
+    unsigned long long restart_limit = RESTART_BASE * luby(restarts);
+    unsigned long long since_restart = 0;
+    unsigned long long start_decisions = s->decisions;
+
+    for (;;) {
+        Clause* conflict = propagate(s);
+        if (conflict) {
+            s->conflicts++;
+            since_restart++;
+            if (s->level_count == 0) {
+                s->inconsistent = true;
+                return SAT_UNSATISFIABLE;
+            }
+            int back_level;
+            int size = analyze(s, conflict, &back_level);
+            backtrack(s, back_level);
+            if (size == 1) {
+                enqueue(s, s->buffer[0], NULL);
+            } else {
+                Clause* c = clause_new(s->buffer, size, true);
+                if (!c || !vec_push(&s->learnts, c) || !attach(s, c)) {
+                    printf("Erreur : memoire insuffisante pour le solveur SAT\n");
+                    backtrack(s, 0);
+                    return SAT_UNKNOWN;
+                }
+                bump_clause(s, c);
+                enqueue(s, c->lits[0], c);
+            }
+            s->var_inc /= VAR_DECAY;
+            s->clause_inc /= (float)CLAUSE_DECAY;
+            continue;
+        }
+
+        if (since_restart >= restart_limit) {
+            backtrack(s, 0);
+            if (s->learnts.count > s->max_learnts) {
+                reduce_learnts(s);
+            }
+            restart_limit = RESTART_BASE * luby(++restarts);
+            since_restart = 0;
+            continue;
+        }
+        if ((s->decisions & (CANCEL_CHECK - 1)) == 0 &&
+            ((max_decisions && s->decisions - start_decisions >= max_decisions) || (cancel && atomic_load(cancel)))) {
+            backtrack(s, 0);
+            return SAT_UNKNOWN;
+        }
+
+        int v = -1;
+        while (s->heap_count > 0) {
+            v = heap_pop(s);
+            if (s->value[v] == 0) {
+                break;
+            }
+            v = -1;
+        }
+        if (v < 0) {
+            for (int i = 0; i < s->vars; i++) {
+                s->model[i] = s->value[i] > 0;
+            }
+            backtrack(s, 0);
+            return SAT_SATISFIABLE;
+        }
+        s->decisions++;
+        s->trail_lim[s->level_count++] = s->trail_count;
+        enqueue(s, 2 * v + !s->phase[v], NULL);
+    }
+}
+
+//valeur d'une variable (1..var_count) dans la dernière solution trouvée
+bool sat_model_value(const SatSolver* s, int var) {
+    return s->model[var - 1];
+}
+
+unsigned long long sat_decisions(const SatSolver* s) {
+    return s->decisions;
+}
+
+unsigned long long sat_conflicts(const SatSolver* s) {
+    return s->conflicts;
+}
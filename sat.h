@@ -0,0 +1,29 @@
+#ifndef SAT_H
+#define SAT_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+// Petit solveur SAT CDCL : littéraux surveillés par deux pointeurs, apprentissage au
+// premier point d'implication unique, heuristique VSIDS, mémorisation des phases et
+// redémarrages selon la suite de Luby. Les variables sont numérotées à partir de 1 et
+// un littéral négatif est l'opposé de sa variable, comme dans le format DIMACS.
+// Des clauses peuvent être ajoutées entre deux appels à sat_solve().
+
+typedef enum {
+    SAT_UNKNOWN,        // interrompu ou limite atteinte
+    SAT_SATISFIABLE,
+    SAT_UNSATISFIABLE
+} SatResult;
+
+typedef struct SatSolver SatSolver;
+
+SatSolver* sat_new(int var_count);
+void sat_free(SatSolver* s);
+bool sat_add_clause(SatSolver* s, const int* lits, int count);
+SatResult sat_solve(SatSolver* s, const atomic_bool* cancel, unsigned long long max_decisions);
+bool sat_model_value(const SatSolver* s, int var);
+unsigned long long sat_decisions(const SatSolver* s);
+unsigned long long sat_conflicts(const SatSolver* s);
+
+#endif
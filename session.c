@@ -0,0 +1,128 @@
+#include "session.h"
+
+//convertir des coordonnées en indice de case compact
+static uint32_t cell_index(const Session* session, int x, int y) {
+    return (uint32_t)x * (uint32_t)session->board.size + (uint32_t)y;
+}
+
+//retrouver les coordonnées d'un indice de case
+static void cell_coords(const Session* session, uint32_t cell, int* x, int* y) {
+    *x = (int)(cell / (uint32_t)session->board.size);
+    *y = (int)(cell % (uint32_t)session->board.size);
+}
+
+//colorier une case de la chaîne courante et en faire la nouvelle tête ; false si les piles
+//ne peuvent pas grandir (la grille n'est alors pas modifiée)
+static bool advance_head(Session* session, int x, int y) {
+    uint32_t cell = cell_index(session, x, y);
+    if (!cell_stack_push(&session->moves, cell)) {
+        return false;
+    }
+    if (!cell_stack_set(&session->heads, (size_t)session->current_chain, cell)) {
+        cell_stack_pop(&session->moves);
+        return false;
+    }
+    set_cell_chain(&session->board, x, y, session->current_chain);
+    session->last_x = x;
+    session->last_y = y;
+    return true;
+}
+
+//vider l'historique pour le niveau qui vient d'être chargé
+void session_begin_level(Session* session) {
+    cell_stack_reset(&session->moves, session->board.size);
+    cell_stack_reset(&session->heads, session->board.size);
+}
+
+//commencer la première chaîne du niveau sur un 'x' libre
+SessionStatus session_start(Session* session, int x, int y) {
+    Board* board = &session->board;
+    if (!is_within_bounds(board, x, y) || cell_value(board, x, y) != 0 || cell_chain(board, x, y) != 0) {
+        return SESSION_BAD_START;
+    }
+    int previous = session->current_chain;
+    session->current_chain = session->chain_counter;
+    if (!advance_head(session, x, y)) {
+        session->current_chain = previous;
+        return SESSION_NO_MEMORY;
+    }
+    session->chain_counter++;
+    session->start_x = x;
+    session->start_y = y;
+    session->has_started = true;
+    return SESSION_OK;
+}
+
+//avancer la tête de la chaîne courante (N, S, E ou O)
+SessionStatus session_move(Session* session, char direction) {
+    int x = session->last_x, y = session->last_y;
+    switch (direction) {
+        case 'N': case 'n': x--; break;
+        case 'S': case 's': x++; break;
+        case 'E': case 'e': y++; break;
+        case 'O': case 'o': y--; break;
+        default: return SESSION_BAD_MOVE;
+    }
+    if (!is_valid_move(&session->board, session->last_x, session->last_y, x, y)) {
+        return SESSION_BAD_MOVE;
+    }
+    if (!advance_head(session, x, y)) {
+        return SESSION_NO_MEMORY;
+    }
+    return check_victory(&session->board) ? SESSION_VICTORY : SESSION_OK;
+}
+
+//annuler le dernier mouvement
+SessionStatus session_undo(Session* session) {
+    if (cell_value(&session->board, session->last_x, session->last_y) == 0) {
+        return SESSION_UNDO_ON_START;
+    }
+    if (session->moves.count == 0) {
+        return SESSION_NOTHING_TO_UNDO;
+    }
+    int x, y;
+    cell_coords(session, cell_stack_pop(&session->moves), &x, &y);
+    set_cell_chain(&session->board, x, y, 0);
+    if (session->moves.count > 0) {
+        cell_coords(session, cell_stack_top(&session->moves), &session->last_x, &session->last_y);
+    } else {
+        session->last_x = session->start_x;
+        session->last_y = session->start_y;
+    }
+    return SESSION_OK;
+}
+
+//effacer la chaîne courante et revenir à son départ
+void session_erase(Session* session) {
+    erase_chain(&session->board, session->current_chain);
+    session->last_x = session->start_x;
+    session->last_y = session->start_y;
+}
+
+//vider la grille : le niveau recommence par le choix d'un départ
+void session_restart(Session* session) {
+    reset_level(&session->board);
+    session->has_started = false;
+}
+
+//reprendre une chaîne existante, ou en commencer une nouvelle sur un 'x'
+SessionStatus session_select(Session* session, int x, int y) {
+    Board* board = &session->board;
+    if (!is_within_bounds(board, x, y) || (cell_value(board, x, y) != 0 && cell_chain(board, x, y) <= 0)) {
+        return SESSION_BAD_SELECT;
+    }
+    if (cell_chain(board, x, y) > 0) {
+        session->current_chain = cell_chain(board, x, y);
+        cell_coords(session, cell_stack_get(&session->heads, (size_t)session->current_chain),
+                    &session->last_x, &session->last_y);
+        return SESSION_CHAIN_RESUMED;
+    }
+    int previous = session->current_chain;
+    session->current_chain = session->chain_counter;
+    if (!advance_head(session, x, y)) {
+        session->current_chain = previous;
+        return SESSION_NO_MEMORY;
+    }
+    session->chain_counter++;
+    return SESSION_OK;
+}
@@ -0,0 +1,45 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stdbool.h>
+#include "board.h"
+#include "cellstack.h"
+
+// État complet d'une partie : grille, historique des mouvements et position du joueur.
+// Tout ce qui est nécessaire pour reprendre une partie tient dans cette structure.
+typedef struct {
+    Board board;
+    CellStack moves;       // Pour annuler les mouvements
+    CellStack heads;       // Dernière position de chaque chaîne, indexée par numéro de chaîne
+    int level_number;
+    int chain_counter;     // Numéro de la prochaine chaîne
+    int current_chain;
+    bool has_started;      // Le niveau courant est chargé et une chaîne a été commencée
+    int last_x, last_y;    // Tête de la chaîne courante
+    int start_x, start_y;  // Départ de la chaîne courante
+} Session;
+
+// Résultat d'une commande appliquée à la partie (l'affichage reste à l'appelant)
+typedef enum {
+    SESSION_OK,
+    SESSION_VICTORY,          // le mouvement a couvert la dernière case
+    SESSION_CHAIN_RESUMED,    // sélection d'une chaîne existante
+    SESSION_BAD_MOVE,         // direction inconnue ou refusée par is_valid_move()
+    SESSION_BAD_START,        // la case n'est pas un 'x' libre
+    SESSION_BAD_SELECT,       // ni un 'x' ni une case occupée
+    SESSION_UNDO_ON_START,    // la tête est sur un 'x'
+    SESSION_NOTHING_TO_UNDO,
+    SESSION_NO_MEMORY         // pile des mouvements pleine : grille inchangée
+} SessionStatus;
+
+// Commandes de jeu, celles de play_game() sans les entrées ni l'affichage.
+// Le niveau est chargé par l'appelant, qui appelle ensuite session_begin_level().
+void session_begin_level(Session* session);
+SessionStatus session_start(Session* session, int x, int y);
+SessionStatus session_move(Session* session, char direction);
+SessionStatus session_undo(Session* session);
+void session_erase(Session* session);
+void session_restart(Session* session);
+SessionStatus session_select(Session* session, int x, int y);
+
+#endif
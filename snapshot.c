@@ -0,0 +1,369 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "snapshot.h"
+#include "stats.h"
+#include "trace.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+typedef struct {
+    char magic[4];          // "CCSN"
+    uint32_t version;
+    uint32_t size;          // N, 0 si le niveau n'est pas commencé
+    int32_t level_number;
+    int32_t chain_counter;
+    int32_t current_chain;
+    int32_t last_x, last_y;
+    int32_t start_x, start_y;
+    uint32_t has_started;
+    uint32_t move_count;
+    uint32_t head_count;
+    uint32_t reserved;
+    uint64_t checksum;      // FNV-1a de tout ce qui suit l'en-tête
+} SnapshotHeader;
+
+_Static_assert(sizeof(SnapshotHeader) == 64, "en-tete de sauvegarde de 64 octets");
+_Static_assert(sizeof(int) == sizeof(int32_t), "les grilles sont copiees telles quelles en int32");
+
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* p = data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ p[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+//largeur des entrées de pile pour une grille NxN (celle choisie par cell_stack_reset)
+static size_t entry_width(uint32_t size) {
+    return (uint64_t)size * size < 0xFFFF ? 2 : 4;
+}
+
+static size_t payload_size(uint32_t size, size_t moves, size_t heads) {
+    return (size_t)size * size * 2 * sizeof(int32_t) + (moves + heads) * entry_width(size);
+}
+
+//taille de la sauvegarde d'une partie, 0 si elle ne peut pas être sauvegardée
+size_t snapshot_size(const Session* session) {
+    if (!session->has_started) {
+        return sizeof(SnapshotHeader);
+    }
+    if (session->board.tiles) {
+        return 0; // une grille tuilée vit déjà dans son propre fichier
+    }
+    return sizeof(SnapshotHeader) + payload_size((uint32_t)session->board.size, session->moves.count,
+                                                 session->heads.count);
+}
+
+static unsigned char* write_stack(unsigned char* out, const CellStack* stack, size_t width) {
+    for (size_t i = 0; i < stack->count; i++) {
+        uint32_t cell = cell_stack_get(stack, i);
+        if (width == 2) {
+            uint16_t v = cell == NO_CELL ? UINT16_MAX : (uint16_t)cell;
+            memcpy(out, &v, 2);
+        } else {
+            memcpy(out, &cell, 4);
+        }
+        out += width;
+    }
+    return out;
+}
+
+//écrire la sauvegarde dans un tampon de snapshot_size() octets
+bool snapshot_write(const Session* session, void* buffer, size_t size) {
+    if (size == 0 || size != snapshot_size(session)) {
+        return false;
+    }
+    SnapshotHeader header = {0};
+    memcpy(header.magic, "CCSN", 4);
+    header.version = SNAPSHOT_VERSION;
+    header.level_number = session->level_number;
+    header.chain_counter = session->chain_counter;
+    header.current_chain = session->current_chain;
+    header.last_x = session->last_x;
+    header.last_y = session->last_y;
+    header.start_x = session->start_x;
+    header.start_y = session->start_y;
+    header.has_started = session->has_started;
+
+    unsigned char* out = (unsigned char*)buffer + sizeof(header);
+    if (session->has_started) {
+        const Board* board = &session->board;
+        size_t cells = (size_t)board->size * board->size;
+        size_t width = entry_width((uint32_t)board->size);
+        header.size = (uint32_t)board->size;
+        header.move_count = (uint32_t)session->moves.count;
+        header.head_count = (uint32_t)session->heads.count;
+        board_copy_layers(board, out, out + cells * sizeof(int32_t));
+        out = write_stack(out + cells * 2 * sizeof(int32_t), &session->moves, width);
+        out = write_stack(out, &session->heads, width);
+    }
+    unsigned char* payload = (unsigned char*)buffer + sizeof(header);
+    header.checksum = fnv1a(14695981039346656037ull, payload, (size_t)(out - payload));
+    memcpy(buffer, &header, sizeof(header));
+    return true;
+}
+
+static bool fail(char* error, size_t error_size, const char* message) {
+    snprintf(error, error_size, "Sauvegarde invalide : %s", message);
+    return false;
+}
+
+static uint32_t read_entry(const unsigned char* p, size_t width) {
+    if (width == 2) {
+        uint16_t v;
+        memcpy(&v, p, 2);
+        return v == UINT16_MAX ? NO_CELL : v;
+    }
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+//reconstruire une partie depuis une sauvegarde (la session ne doit pas contenir de grille)
+bool snapshot_read(Session* session, const void* data, size_t size, char* error, size_t error_size) {
+    SnapshotHeader header;
+    if (size < sizeof(header)) {
+        return fail(error, error_size, "fichier tronque");
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, "CCSN", 4) != 0) {
+        return fail(error, error_size, "ce n'est pas une sauvegarde");
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+        return fail(error, error_size, "version non prise en charge");
+    }
+    uint32_t n = header.size;
+    if (header.has_started && (n < 1 || n > 46340)) {
+        return fail(error, error_size, "taille de grille incorrecte");
+    }
+    if (!header.has_started && (n != 0 || header.move_count || header.head_count)) {
+        return fail(error, error_size, "en-tete incoherent");
+    }
+    size_t expected = sizeof(header) + payload_size(n, header.move_count, header.head_count);
+    if (size != expected) {
+        return fail(error, error_size, "taille de fichier incorrecte");
+    }
+    const unsigned char* payload = (const unsigned char*)data + sizeof(header);
+    if (fnv1a(14695981039346656037ull, payload, size - sizeof(header)) != header.checksum) {
+        return fail(error, error_size, "somme de controle incorrecte");
+    }
+    if (header.has_started &&
+        (header.last_x < 0 || (uint32_t)header.last_x >= n || header.last_y < 0 || (uint32_t)header.last_y >= n ||
+         header.start_x < 0 || (uint32_t)header.start_x >= n || header.start_y < 0 || (uint32_t)header.start_y >= n)) {
+        return fail(error, error_size, "position hors de la grille");
+    }
+
+    size_t cells = (size_t)n * n;
+    size_t width = entry_width(n);
+    const unsigned char* stacks = payload + cells * 2 * sizeof(int32_t);
+    for (size_t i = 0; i < (size_t)header.move_count + header.head_count; i++) {
+        uint32_t cell = read_entry(stacks + i * width, width);
+        if (cell >= cells && !(cell == NO_CELL && i >= header.move_count)) {
+            return fail(error, error_size, "case hors de la grille");
+        }
+    }
+
+    // chaque chaîne a reçu un numéro de 1 à chain_counter - 1, et ne passe que sur des cases jouables
+    if (header.has_started && (header.current_chain < 0 || header.current_chain >= header.chain_counter)) {
+        return fail(error, error_size, "chaine courante incorrecte");
+    }
+    for (size_t c = 0; c < cells; c++) {
+        int32_t value, chain;
+        memcpy(&value, payload + c * sizeof(int32_t), sizeof(value));
+        memcpy(&chain, payload + (cells + c) * sizeof(int32_t), sizeof(chain));
+        if (value < -1) {
+            return fail(error, error_size, "valeur de case incorrecte");
+        }
+        if (chain < 0 || chain >= header.chain_counter) {
+            return fail(error, error_size, "numero de chaine incorrect");
+        }
+        if (chain != 0 && value < 0) {
+            return fail(error, error_size, "chaine sur une case vide");
+        }
+    }
+
+    session->level_number = header.level_number;
+    session->chain_counter = header.chain_counter;
+    session->current_chain = header.current_chain;
+    session->last_x = header.last_x;
+    session->last_y = header.last_y;
+    session->start_x = header.start_x;
+    session->start_y = header.start_y;
+    session->has_started = header.has_started != 0;
+    if (!session->has_started) {
+        return true;
+    }
+
+    allocate_grids(&session->board, (int)n, (const int*)payload);
+    const unsigned char* chains = payload + cells * sizeof(int32_t);
+    for (size_t c = 0; c < cells; c++) {
+        int32_t chain;
+        memcpy(&chain, chains + c * sizeof(int32_t), sizeof(chain));
+        if (chain != 0) {
+            set_cell_chain(&session->board, (int)(c / n), (int)(c % n), chain);
+        }
+    }
+    cell_stack_reset(&session->moves, (int)n);
+    cell_stack_reset(&session->heads, (int)n);
+    for (uint32_t i = 0; i < header.move_count; i++) {
+        cell_stack_push(&session->moves, read_entry(stacks + i * width, width));
+    }
+    stacks += (size_t)header.move_count * width;
+    for (uint32_t i = 0; i < header.head_count; i++) {
+        cell_stack_push(&session->heads, read_entry(stacks + i * width, width));
+    }
+    return true;
+}
+
+//sauvegarder une partie : écriture dans un fichier temporaire puis renommage,
+//pour qu'une interruption en cours d'écriture laisse l'ancienne sauvegarde intacte
+bool snapshot_save(const Session* session, const char* filename) {
+    STAT_TIMER_START(save_start);
+    TRACE_START(save_trace);
+    size_t size = snapshot_size(session);
+    if (size == 0) {
+        return false;
+    }
+    unsigned char* buffer = malloc(size);
+    if (!buffer || !snapshot_write(session, buffer, size)) {
+        free(buffer);
+        return false;
+    }
+
+    char temp[512];
+    snprintf(temp, sizeof(temp), "%s.tmp", filename);
+    FILE* file = fopen(temp, "wb");
+    bool ok = file && fwrite(buffer, 1, size, file) == size;
+    if (file && fclose(file) != 0) {
+        ok = false;
+    }
+    free(buffer);
+#ifdef _WIN32
+    if (ok) {
+        remove(filename); // rename() ne remplace pas un fichier existant sous Windows
+    }
+#endif
+    if (!ok || rename(temp, filename) != 0) {
+        printf("Erreur : impossible d'enregistrer la sauvegarde %s\n", filename);
+        remove(temp);
+        return false;
+    }
+    STAT_ADD(STAT_SNAPSHOT_SAVES, 1);
+    STAT_TIMER_ADD(save_start, STAT_SNAPSHOT_NS);
+    TRACE_END(save_trace, TRACE_SNAPSHOT);
+    return true;
+}
+
+//ouvrir (sans le vider) le fichier de sauvegarde automatique
+bool snapshot_writer_open(SnapshotWriter* writer, const char* filename) {
+    memset(writer, 0, sizeof(*writer));
+    writer->filename = filename;
+#ifndef _WIN32
+    writer->fd = open(filename, O_WRONLY | O_CREAT, 0644);
+    if (writer->fd < 0) {
+        printf("Erreur : impossible d'ouvrir la sauvegarde %s\n", filename);
+        return false;
+    }
+    struct stat st;
+    writer->written = fstat(writer->fd, &st) == 0 ? (size_t)st.st_size : 0;
+#else
+    writer->fd = -1;
+#endif
+    return true;
+}
+
+//réécrire la sauvegarde en place
+bool snapshot_writer_save(SnapshotWriter* writer, const Session* session) {
+#ifndef _WIN32
+    STAT_TIMER_START(save_start);
+    TRACE_START(save_trace);
+    size_t size = snapshot_size(session);
+    if (size == 0 || writer->fd < 0) {
+        return false;
+    }
+    if (size > writer->capacity) {
+        unsigned char* buffer = realloc(writer->buffer, size);
+        if (!buffer) {
+            return false;
+        }
+        writer->buffer = buffer;
+        writer->capacity = size;
+    }
+    snapshot_write(session, writer->buffer, size);
+    if (pwrite(writer->fd, writer->buffer, size, 0) != (ssize_t)size ||
+        (size < writer->written && ftruncate(writer->fd, (off_t)size) != 0)) {
+        printf("Erreur : impossible d'enregistrer la sauvegarde %s\n", writer->filename);
+        return false;
+    }
+    writer->written = size;
+    STAT_ADD(STAT_SNAPSHOT_SAVES, 1);
+    STAT_TIMER_ADD(save_start, STAT_SNAPSHOT_NS);
+    TRACE_END(save_trace, TRACE_SNAPSHOT);
+    return true;
+#else
+    return snapshot_save(session, writer->filename);
+#endif
+}
+
+void snapshot_writer_close(SnapshotWriter* writer) {
+#ifndef _WIN32
+    if (writer->fd >= 0) {
+        close(writer->fd);
+    }
+#endif
+    free(writer->buffer);
+    memset(writer, 0, sizeof(*writer));
+    writer->fd = -1;
+}
+
+//reprendre une partie depuis un fichier de sauvegarde (projeté en mémoire si possible)
+bool snapshot_restore(Session* session, const char* filename, char* error, size_t error_size) {
+#ifndef _WIN32
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        snprintf(error, error_size, "Impossible d'ouvrir la sauvegarde %s", filename);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return fail(error, error_size, "fichier vide");
+    }
+    size_t size = (size_t)st.st_size;
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        snprintf(error, error_size, "Impossible de lire la sauvegarde %s", filename);
+        return false;
+    }
+    bool ok = snapshot_read(session, data, size, error, error_size);
+    munmap(data, size);
+    return ok;
+#else
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        snprintf(error, error_size, "Impossible d'ouvrir la sauvegarde %s", filename);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    void* data = size > 0 ? malloc((size_t)size) : NULL;
+    bool ok = data && fread(data, 1, (size_t)size, file) == (size_t)size;
+    if (ok) {
+        ok = snapshot_read(session, data, (size_t)size, error, error_size);
+    } else {
+        fail(error, error_size, "fichier illisible");
+    }
+    free(data);
+    fclose(file);
+    return ok;
+#endif
+}
@@ -0,0 +1,41 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "session.h"
+
+// Sauvegarde binaire d'une partie (grille dense uniquement) :
+//   en-tête de 64 octets "CCSN", version, taille N, position du joueur, nombre d'entrées
+//   des piles et somme de contrôle FNV-1a du contenu ;
+//   puis valeurs et chaînes (int32, N*N chacune) et les deux piles de cases
+//   (2 ou 4 octets par entrée selon N, comme en mémoire).
+// Les entiers sont écrits dans l'ordre des octets de la machine.
+// Une partie dont le niveau n'est pas commencé ne sauvegarde que l'en-tête.
+
+#define SNAPSHOT_VERSION 1
+
+size_t snapshot_size(const Session* session);
+bool snapshot_write(const Session* session, void* buffer, size_t size);
+bool snapshot_read(Session* session, const void* data, size_t size, char* error, size_t error_size);
+
+bool snapshot_save(const Session* session, const char* filename);
+bool snapshot_restore(Session* session, const char* filename, char* error, size_t error_size);
+
+// Sauvegarde automatique : le fichier reste ouvert et chaque sauvegarde le réécrit en place
+// en un seul appel système. Une écriture interrompue est détectée à la reprise par la somme
+// de contrôle (la partie repart alors de zéro) ; snapshot_save() passe par un fichier
+// temporaire pour les sauvegardes qui ne doivent jamais être perdues.
+typedef struct {
+    const char* filename;
+    int fd;
+    unsigned char* buffer;
+    size_t capacity;
+    size_t written;   // taille du fichier après la dernière sauvegarde
+} SnapshotWriter;
+
+bool snapshot_writer_open(SnapshotWriter* writer, const char* filename);
+bool snapshot_writer_save(SnapshotWriter* writer, const Session* session);
+void snapshot_writer_close(SnapshotWriter* writer);
+
+#endif
@@ -0,0 +1,1113 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cnf.h"
+#include "morton.h"
+#include "solver.h"
+#include "stats.h"
+#include "trace.h"
+
+// Ordre des directions : celui des commandes N, S, E, O de play_game()
+static const int dir_dx[4] = {-1, 1, 0, 0};
+static const int dir_dy[4] = {0, 0, 1, -1};
+static const char dir_names[4] = {'N', 'S', 'E', 'O'};
+
+// Trame de la pile explicite de la recherche générale : une par case occupée, plus la racine.
+// La pile ne dépasse donc jamais N*N + 1 trames, quelle que soit la longueur des chaînes.
+typedef struct {
+    int32_t head;         // case occupée en entrant dans la trame, -1 pour la racine
+    int32_t next_start;   // premier indice de starts permis à la chaîne suivante
+    int32_t start_index;  // prochain départ à essayer une fois les mouvements épuisés
+    int32_t to[4];        // mouvements candidats, dans l'ordre d'essai
+    uint8_t count;
+    uint8_t index;        // prochain candidat
+    uint8_t flags;
+    uint8_t unused;
+} SearchFrame;
+
+#define SEARCH_FRESH 1        // chaîne réduite à son départ : elle doit avancer avant d'en commencer une autre
+#define SEARCH_CHAIN_START 2  // la trame a commencé une chaîne (séparateur dans le chemin)
+#define SEARCH_PENDING 4      // mouvements pas encore calculés (interruption à l'entrée)
+
+typedef struct {
+    const Level* level;
+    const SolveOptions* options;
+    SolveResult* result;
+    const int* values;
+    int cells;            // cases rangées (N*N, ou blocs complétés en ordre de Morton)
+    const MortonLayout* morton;  // grandes grilles : cases numérotées par morton_index()
+    int* cell_of;         // ordre de Morton : case ligne par ligne de chaque indice (-1 hors grille)
+    int32_t (*next)[4];   // voisin de chaque case dans chaque direction, -1 si hors grille ou vide
+    uint8_t* occupied;
+    int* starts;          // cases 'x', dans l'ordre des indices
+    int* start_rank;      // indice de chaque case 'x' dans starts
+    int start_count;
+    uint32_t* marks;      // coupes : composante de chaque case au dernier parcours des régions
+    uint32_t epoch;
+    int* fill;            // pile du parcours des régions
+    int uncovered;        // cases non nulles encore libres
+    CellStack path;       // solution en cours de construction
+    SearchFrame* frames;
+    size_t depth;
+    unsigned long long save_at;  // prochain contrôle de l'écriture périodique du point de reprise
+    uint64_t saved_ns;
+    uint64_t deadline;           // échéance (horloge de stats_now_ns()), 0 : aucune
+    int required;                // cases non nulles du niveau
+    size_t best_prefix;          // début du chemin en cours déjà recopié dans result->best
+    bool stop;
+} Search;
+
+//indice de recherche de la case (x, y)
+static int cell_at(const Search* s, int x, int y) {
+    return s->morton ? (int)morton_index(s->morton, x, y) : x * s->level->size + y;
+}
+
+//case ligne par ligne (x * N + y) d'un indice de recherche, pour les chemins rendus
+static uint32_t row_major(const Search* s, uint32_t cell) {
+    return s->morton && cell != NO_CELL ? (uint32_t)s->cell_of[cell] : cell;
+}
+
+//options par défaut : première solution, sans interruption
+void solve_options_default(SolveOptions* options) {
+    options->max_solutions = 1;
+    options->cancel = NULL;
+    options->allow_bitboard = true;
+    options->max_nodes = 0;
+    options->scratch = NULL;
+    options->order = ORDER_FIXED;
+    options->engine = ENGINE_SEARCH;
+    options->checkpoint = NULL;
+    options->checkpoint_seconds = 60;
+    options->resume = false;
+    options->time_limit = 0;
+    options->anytime = false;
+    options->prune = true;
+}
+
+static const char* order_names[ORDER_COUNT] = {"fixe", "contrainte", "valeur", "warnsdorff"};
+
+//nom d'une heuristique d'ordre (celui accepté par move_order_parse)
+const char* move_order_name(MoveOrder order) {
+    return order >= 0 && order < ORDER_COUNT ? order_names[order] : "?";
+}
+
+//retrouver une heuristique d'après son nom
+bool move_order_parse(const char* name, MoveOrder* order) {
+    for (int o = 0; o < ORDER_COUNT; o++) {
+        if (strcmp(name, order_names[o]) == 0) {
+            *order = (MoveOrder)o;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Mouvement candidat et son score : les plus petits scores sont essayés d'abord
+typedef struct {
+    int to;
+    int score;
+} Candidate;
+
+//tri par insertion stable (au plus 4 candidats) : à score égal l'ordre N, S, E, O est gardé
+static void sort_candidates(Candidate* moves, int count) {
+    for (int i = 1; i < count; i++) {
+        Candidate m = moves[i];
+        int j = i;
+        for (; j > 0 && moves[j - 1].score > m.score; j--) {
+            moves[j] = moves[j - 1];
+        }
+        moves[j] = m;
+    }
+}
+
+static void occupy(Search* s, int cell) {
+    s->occupied[cell] = 1;
+    if (s->values[cell] > 0) {
+        s->uncovered--;
+    }
+    cell_stack_push(&s->path, (uint32_t)cell);
+}
+
+static void release(Search* s, int cell) {
+    s->occupied[cell] = 0;
+    if (s->values[cell] > 0) {
+        s->uncovered++;
+    }
+    cell_stack_pop(&s->path);
+}
+
+static void record_solution(Search* s) {
+    SolveResult* r = s->result;
+    if (r->solutions++ == 0) {
+        cell_stack_reset(&r->path, s->level->size);
+        for (size_t i = 0; i < s->path.count; i++) {
+            cell_stack_push(&r->path, row_major(s, cell_stack_get(&s->path, i)));
+        }
+    }
+    if (r->solutions >= s->options->max_solutions) {
+        s->stop = true;
+    }
+}
+
+//interruption demandée, limite de noeuds dépassée ou échéance passée (horloge lue tous les 1024 noeuds)
+static bool check_cancel(SolveResult* r, const SolveOptions* options, uint64_t deadline) {
+    if ((options->max_nodes && r->nodes > options->max_nodes) ||
+        ((r->nodes & 1023) == 0 && ((options->cancel && atomic_load(options->cancel)) ||
+                                    (deadline && stats_now_ns() >= deadline)))) {
+        r->status = SOLVE_CANCELLED;
+        return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Point de reprise de la recherche générale : la pile de trames suffit à retrouver le chemin
+// et l'occupation des cases. En-tête "CCSK", puis les trames et la première solution trouvée ;
+// entiers dans l'ordre des octets de la machine, comme les sauvegardes de partie.
+// ---------------------------------------------------------------------------
+
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_CHECK_NODES 65536  // noeuds entre deux lectures de l'horloge
+
+typedef struct {
+    char magic[4];          // "CCSK"
+    uint32_t version;
+    uint32_t size;
+    uint32_t order;
+    uint64_t level_hash;    // FNV-1a des valeurs : un point de reprise ne sert qu'à son niveau
+    uint64_t nodes;
+    uint32_t max_solutions;
+    uint32_t solutions;
+    uint32_t depth;
+    uint32_t solution_count;
+    uint64_t checksum;      // FNV-1a de tout ce qui suit l'en-tête
+} CheckpointHeader;
+
+_Static_assert(sizeof(SearchFrame) == 32, "trame de recherche de 32 octets");
+
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t level_hash(const Level* level) {
+    uint64_t hash = fnv1a(14695981039346656037ull, &level->size, sizeof(level->size));
+    return fnv1a(hash, level->values, (size_t)level->size * level->size * sizeof(int));
+}
+
+//les trames du point de reprise désignent les cases ligne par ligne, quel que soit le rangement
+static void frame_to_rows(const Search* s, SearchFrame* f) {
+    if (f->head >= 0) {
+        f->head = (int32_t)row_major(s, (uint32_t)f->head);
+    }
+    for (int i = 0; i < f->count; i++) {
+        f->to[i] = (int32_t)row_major(s, (uint32_t)f->to[i]);
+    }
+}
+
+static bool frame_from_rows(const Search* s, SearchFrame* f) {
+    int n = s->level->size;
+    if (f->head >= n * n || f->count > 4) {
+        return false;
+    }
+    if (f->head >= 0) {
+        f->head = cell_at(s, f->head / n, f->head % n);
+    }
+    for (int i = 0; i < f->count; i++) {
+        if (f->to[i] < 0 || f->to[i] >= n * n) {
+            return false;
+        }
+        f->to[i] = cell_at(s, f->to[i] / n, f->to[i] % n);
+    }
+    return true;
+}
+
+//écrire le point de reprise : fichier temporaire puis renommage, comme snapshot_save()
+static bool save_checkpoint(Search* s) {
+    const SolveResult* r = s->result;
+    size_t frames_size = s->depth * sizeof(SearchFrame);
+    size_t size = sizeof(CheckpointHeader) + frames_size + r->path.count * sizeof(uint32_t);
+    unsigned char* buffer = malloc(size);
+    if (!buffer) {
+        return false;
+    }
+    CheckpointHeader header = {{'C', 'C', 'S', 'K'}, CHECKPOINT_VERSION, (uint32_t)s->level->size,
+                               (uint32_t)s->options->order, level_hash(s->level), r->nodes,
+                               (uint32_t)s->options->max_solutions, (uint32_t)r->solutions, (uint32_t)s->depth,
+                               (uint32_t)(r->solutions > 0 ? r->path.count : 0), 0};
+    unsigned char* payload = buffer + sizeof(header);
+    for (size_t d = 0; d < s->depth; d++) {
+        SearchFrame f = s->frames[d];
+        frame_to_rows(s, &f);
+        memcpy(payload + d * sizeof(SearchFrame), &f, sizeof(f));
+    }
+    for (uint32_t i = 0; i < header.solution_count; i++) {
+        uint32_t cell = cell_stack_get(&r->path, i);
+        memcpy(payload + frames_size + i * sizeof(uint32_t), &cell, sizeof(cell));
+    }
+    size = sizeof(header) + frames_size + header.solution_count * sizeof(uint32_t);
+    header.checksum = fnv1a(14695981039346656037ull, payload, size - sizeof(header));
+    memcpy(buffer, &header, sizeof(header));
+
+    char temp[512];
+    snprintf(temp, sizeof(temp), "%s.tmp", s->options->checkpoint);
+    FILE* file = fopen(temp, "wb");
+    bool ok = file && fwrite(buffer, 1, size, file) == size;
+    if (file && fclose(file) != 0) {
+        ok = false;
+    }
+    free(buffer);
+#ifdef _WIN32
+    if (ok) {
+        remove(s->options->checkpoint);
+    }
+#endif
+    if (!ok || rename(temp, s->options->checkpoint) != 0) {
+        printf("Erreur : impossible d'ecrire le point de reprise %s\n", s->options->checkpoint);
+        remove(temp);
+        return false;
+    }
+    s->saved_ns = stats_now_ns();
+    return true;
+}
+
+static void periodic_checkpoint(Search* s) {
+    s->save_at = s->result->nodes + CHECKPOINT_CHECK_NODES;
+    if (stats_now_ns() - s->saved_ns >= (uint64_t)(s->options->checkpoint_seconds * 1e9)) {
+        TRACE_START(save_trace);
+        save_checkpoint(s);
+        TRACE_END(save_trace, TRACE_SOLVE_CHECKPOINT);
+    }
+}
+
+//relire un point de reprise du même niveau et reconstruire chemin et occupation ;
+//false (recherche depuis le début) si le fichier manque ou ne correspond pas
+static bool load_checkpoint(Search* s) {
+    FILE* file = fopen(s->options->checkpoint, "rb");
+    if (!file) {
+        return false;
+    }
+    CheckpointHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, "CCSK", 4) == 0 &&
+              header.version == CHECKPOINT_VERSION && header.size == (uint32_t)s->level->size &&
+              header.level_hash == level_hash(s->level) && header.order == (uint32_t)s->options->order &&
+              header.max_solutions == (uint32_t)s->options->max_solutions && header.depth >= 1 &&
+              header.depth <= (uint32_t)s->level->size * s->level->size + 1 &&
+              header.solution_count <= 2u * s->level->size * s->level->size;
+    size_t frames_size = ok ? header.depth * sizeof(SearchFrame) : 0;
+    size_t size = frames_size + (ok ? header.solution_count * sizeof(uint32_t) : 0);
+    unsigned char* payload = ok ? malloc(size) : NULL;
+    ok = payload && fread(payload, 1, size, file) == size &&
+         fnv1a(14695981039346656037ull, payload, size) == header.checksum;
+    fclose(file);
+    if (!ok) {
+        free(payload);
+        return false;
+    }
+
+    memcpy(s->frames, payload, frames_size);
+    int uncovered = s->uncovered;
+    for (uint32_t d = 0; ok && d < header.depth; d++) {
+        SearchFrame* f = &s->frames[d];
+        ok = (d == 0) == (f->head < 0) && frame_from_rows(s, f) && f->index <= f->count &&
+             f->next_start >= 0 && f->start_index >= 0 && f->start_index <= s->start_count;
+        if (ok && d > 0) {
+            ok = s->values[f->head] != -1 && !s->occupied[f->head];
+            if (f->flags & SEARCH_CHAIN_START) {
+                cell_stack_push(&s->path, NO_CELL);
+            }
+            occupy(s, f->head);
+        }
+    }
+    SolveResult* r = s->result;
+    cell_stack_reset(&r->path, s->level->size);
+    for (uint32_t i = 0; ok && i < header.solution_count; i++) {
+        uint32_t cell;
+        memcpy(&cell, payload + frames_size + i * sizeof(uint32_t), sizeof(cell));
+        cell_stack_push(&r->path, cell);
+    }
+    free(payload);
+    if (!ok) {
+        // trames incohérentes malgré la somme de contrôle : tout reprendre de zéro
+        memset(s->occupied, 0, (size_t)s->cells);
+        s->uncovered = uncovered;
+        cell_stack_reset(&s->path, s->level->size);
+        cell_stack_reset(&r->path, s->level->size);
+        return false;
+    }
+    s->depth = header.depth;
+    r->nodes = header.nodes;
+    r->solutions = (int)header.solutions;
+    return true;
+}
+
+//une chaîne peut-elle avancer de `from` à `to` (voisins, `to` non vide)
+static bool can_step(const int* values, int from, int to) {
+    return values[from] == 0 || values[to] >= values[from];
+}
+
+//score de la case `to` pour l'heuristique choisie (la tête est déjà occupée)
+static int move_score(const Search* s, MoveOrder order, int to) {
+    if (order == ORDER_LOW_VALUE) {
+        return s->values[to];
+    }
+    int count = 0;
+    for (int d = 0; d < 4; d++) {
+        int other = s->next[to][d];
+        if (other < 0 || s->occupied[other]) {
+            continue;
+        }
+        // contrainte : voisins libres qui peuvent encore entrer ; Warnsdorff : sorties possibles
+        if (order == ORDER_CONSTRAINED ? can_step(s->values, other, to) : can_step(s->values, to, other)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+//calculer les mouvements de la tête d'une trame, dans l'ordre d'essai
+//(insertion stable : à score égal l'ordre N, S, E, O est gardé)
+static void expand(Search* s, SearchFrame* f) {
+    MoveOrder order = s->options->order;
+    const int32_t* next = s->next[f->head];
+    int scores[4];
+    int count = 0;
+    for (int d = 0; d < 4; d++) {
+        int to = next[d];
+        if (to < 0 || s->occupied[to] || !can_step(s->values, f->head, to)) {
+            continue;
+        }
+        int score = order == ORDER_FIXED ? 0 : move_score(s, order, to);
+        int j = count++;
+        for (; j > 0 && scores[j - 1] > score; j--) {
+            scores[j] = scores[j - 1];
+            f->to[j] = f->to[j - 1];
+        }
+        scores[j] = score;
+        f->to[j] = to;
+    }
+    f->count = (uint8_t)count;
+    f->index = 0;
+    f->flags &= (uint8_t)~SEARCH_PENDING;
+}
+
+// ---------------------------------------------------------------------------
+// Coupes : une chaîne ne reprend jamais après le départ de la suivante, donc seules les cases
+// libres et la tête de la chaîne en cours peuvent encore mener à une case non couverte, et
+// seuls les départs d'indice >= next_start peuvent encore commencer une chaîne. Une branche est
+// abandonnée dès qu'une case non nulle ne peut plus être atteinte. Les mêmes règles, évaluées
+// aux mêmes noeuds, servent la recherche sur mot de 64 bits : les deux arbres restent égaux.
+// ---------------------------------------------------------------------------
+
+//une chaîne peut-elle encore entrer sur la case libre c (depuis une case libre ou la tête)
+static bool can_enter(const Search* s, int c, int head) {
+    for (int d = 0; d < 4; d++) {
+        int from = s->next[c][d];
+        if (from >= 0 && (from == head || !s->occupied[from]) && can_step(s->values, from, c)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//occuper une case coupe-t-elle localement ses voisins libres en plusieurs groupes ?
+//ring : les 8 voisins dans l'ordre N, NE, E, SE, S, SO, O, NO (true : case libre)
+static bool ring_splits(const bool ring[8]) {
+    int groups = 0;
+    for (int i = 0; i < 8; i += 2) {
+        // un voisin libre ouvre un groupe, sauf s'il rejoint le précédent par la diagonale
+        if (ring[i] && !(ring[(i + 6) & 7] && ring[(i + 7) & 7])) {
+            groups++;
+        }
+    }
+    return groups >= 2;
+}
+
+static bool is_free(const Search* s, int x, int y) {
+    int n = s->level->size;
+    if (x < 0 || x >= n || y < 0 || y >= n) {
+        return false;
+    }
+    int cell = cell_at(s, x, y);
+    return s->values[cell] != -1 && !s->occupied[cell];
+}
+
+static bool may_split(const Search* s, int cell) {
+    static const int ring_dx[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+    static const int ring_dy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+    int n = s->level->size;
+    int x = (int)row_major(s, (uint32_t)cell) / n, y = (int)row_major(s, (uint32_t)cell) % n;
+    bool ring[8];
+    for (int i = 0; i < 8; i++) {
+        ring[i] = is_free(s, x + ring_dx[i], y + ring_dy[i]);
+    }
+    return ring_splits(ring);
+}
+
+#define REGION_FULL_CELLS 1024   // jusqu'à ce nombre de cases, toutes les régions sont vérifiées
+#define REGION_LOCAL_LIMIT 1024  // au-delà : régions voisines des têtes seulement, de cette taille au plus
+
+//parcourir la région de cases libres de seed (marquée id) ; false si elle dépasse limit cases,
+//elle est alors supposée sûre. usable : départ d'indice >= next_start ; required : case non nulle
+static bool flood_region(Search* s, int seed, uint32_t id, int next_start, int limit, bool* usable, bool* required) {
+    int top = 0, visited = 1;
+    s->fill[top++] = seed;
+    s->marks[seed] = id;
+    *usable = false;
+    *required = false;
+    while (top > 0) {
+        int cell = s->fill[--top];
+        if (s->values[cell] == 0 && s->start_rank[cell] >= next_start) {
+            *usable = true;
+        }
+        *required |= s->values[cell] > 0;
+        for (int d = 0; d < 4; d++) {
+            int other = s->next[cell][d];
+            if (other >= 0 && !s->occupied[other] && s->marks[other] != id) {
+                if (++visited > limit) {
+                    return false;
+                }
+                s->marks[other] = id;
+                s->fill[top++] = other;
+            }
+        }
+    }
+    return true;
+}
+
+//une région parcourue sans départ utilisable doit recevoir la tête, qui n'entre que dans une
+static bool region_lost(const Search* s, uint32_t id, int head, int* served) {
+    bool entered = false;
+    for (int d = 0; head >= 0 && d < 4 && !entered; d++) {
+        int to = s->next[head][d];
+        entered = to >= 0 && s->marks[to] == id && can_step(s->values, head, to);
+    }
+    return !entered || ++(*served) > 1;
+}
+
+//régions de cases libres : chacune qui contient une case non nulle doit garder un départ
+//utilisable, ou recevoir la tête (head < 0 : tête bloquée). Sur les grandes grilles, seules
+//les régions qui touchent la case occupée et l'ancienne tête sont parcourues, et une région
+//trop grande pour être parcourue vite est laissée de côté : la coupe reste sûre, moins complète.
+static bool regions_doomed(Search* s, int head, int cell, int prev, int next_start) {
+    int cells = s->cells;
+    if (s->epoch > UINT32_MAX - (uint32_t)cells) {
+        memset(s->marks, 0, (size_t)cells * sizeof(uint32_t));
+        s->epoch = 0;
+    }
+    uint32_t first = s->epoch + 1;
+    int served = 0;
+    bool usable, required;
+    if (s->level->size * s->level->size <= REGION_FULL_CELLS) { // mêmes coupes quel que soit le rangement
+        for (int c = 0; c < cells; c++) {
+            if (s->values[c] <= 0 || s->occupied[c] || s->marks[c] >= first) {
+                continue;
+            }
+            uint32_t id = ++s->epoch;
+            flood_region(s, c, id, next_start, cells, &usable, &required);
+            if (!usable && region_lost(s, id, head, &served)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    int around[2] = {cell, prev};
+    for (int a = 0; a < 2; a++) {
+        for (int d = 0; around[a] >= 0 && d < 4; d++) {
+            int c = s->next[around[a]][d];
+            if (c < 0 || s->occupied[c] || s->marks[c] >= first) {
+                continue;
+            }
+            uint32_t id = ++s->epoch;
+            if (flood_region(s, c, id, next_start, REGION_LOCAL_LIMIT, &usable, &required) && required &&
+                !usable && region_lost(s, id, head, &served)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+//la trame f (mouvements calculés) peut-elle encore mener à une solution ?
+static bool doomed(Search* s, SearchFrame* f) {
+    int head = f->head;
+    int prev = s->frames[s->depth - 2].head;
+    // la tête précédente n'est plus une tête : ses voisins doivent garder une entrée
+    for (int d = 0; prev >= 0 && d < 4; d++) {
+        int c = s->next[prev][d];
+        if (c >= 0 && !s->occupied[c] && s->values[c] > 0 && !can_enter(s, c, head)) {
+            return true;
+        }
+    }
+    // la tête n'entre que dans un voisin : deux voisins qu'elle seule peut atteindre, c'est trop
+    int only_head = 0;
+    for (int d = 0; d < 4; d++) {
+        int c = s->next[head][d];
+        if (c >= 0 && !s->occupied[c] && s->values[c] > 0 && can_step(s->values, head, c) &&
+            !can_enter(s, c, -1) && ++only_head > 1) {
+            return true;
+        }
+    }
+    // régions : seulement si elles ont pu changer (départ occupé, tête bloquée, case qui sépare)
+    bool boxed = f->count == 0;
+    if (s->values[head] == 0 || boxed || may_split(s, head)) {
+        return regions_doomed(s, boxed ? -1 : head, head, prev, f->next_start);
+    }
+    return false;
+}
+
+//mémoriser le chemin en cours s'il couvre plus de cases que la meilleure couverture connue :
+//seule la fin qui a changé depuis la dernière copie est recopiée
+static void record_best(Search* s) {
+    SolveResult* r = s->result;
+    cell_stack_truncate(&r->best, s->best_prefix);
+    for (size_t i = s->best_prefix; i < s->path.count; i++) {
+        cell_stack_push(&r->best, row_major(s, cell_stack_get(&s->path, i)));
+    }
+    s->best_prefix = s->path.count;
+    r->best_covered = s->required - s->uncovered;
+}
+
+//développer une trame : solution si tout est couvert, sinon calcul de ses mouvements
+static void develop(Search* s, SearchFrame* f) {
+    if (s->options->anytime && s->required - s->uncovered > s->result->best_covered) {
+        record_best(s);
+    }
+    if (s->uncovered == 0) {
+        record_solution(s);
+        // feuille : ni mouvement ni nouvelle chaîne
+        f->flags = (uint8_t)((f->flags & SEARCH_CHAIN_START) | SEARCH_FRESH);
+        return;
+    }
+    expand(s, f);
+    if (s->options->prune && doomed(s, f)) {
+        s->result->pruned++;
+        f->count = 0;
+        f->flags |= SEARCH_FRESH; // ni mouvement ni nouvelle chaîne : la branche est abandonnée
+    }
+}
+
+//entrer sur la case `head` (déjà occupée) : un noeud de plus dans l'arbre
+static void enter(Search* s, int head, int next_start, uint8_t flags) {
+    SearchFrame* f = &s->frames[s->depth++];
+    f->head = head;
+    f->next_start = next_start;
+    f->start_index = next_start;
+    f->count = 0;
+    f->index = 0;
+    f->flags = flags | SEARCH_PENDING;
+    s->result->nodes++;
+    if (check_cancel(s->result, s->options, s->deadline)) {
+        s->stop = true; // la trame reste à développer : une reprise repart d'ici
+        return;
+    }
+    develop(s, f);
+}
+
+//quitter la trame du sommet en libérant sa case
+static void leave(Search* s) {
+    SearchFrame* f = &s->frames[--s->depth];
+    if (f->head >= 0) {
+        release(s, f->head);
+    }
+    if (f->flags & SEARCH_CHAIN_START) {
+        cell_stack_pop(&s->path);
+    }
+    if (s->path.count < s->best_prefix) {
+        s->best_prefix = s->path.count;
+    }
+}
+
+//parcours en profondeur sur la pile explicite : chaque trame essaie ses mouvements, puis
+//(sauf une chaîne réduite à son départ) les départs libres d'indice >= next_start ; les
+//chaînes sont construites par départ croissant pour ne pas énumérer les permutations
+static void run_search(Search* s) {
+    while (s->depth > 0 && !s->stop) {
+        if (s->save_at && s->result->nodes >= s->save_at) {
+            periodic_checkpoint(s);
+        }
+        SearchFrame* f = &s->frames[s->depth - 1];
+        if (f->flags & SEARCH_PENDING) {
+            develop(s, f); // trame interrompue avant d'être développée
+            continue;
+        }
+        if (f->index < f->count) {
+            int to = f->to[f->index++];
+            occupy(s, to);
+            enter(s, to, f->next_start, 0);
+            continue;
+        }
+        if (!(f->flags & SEARCH_FRESH)) {
+            int k = f->start_index;
+            while (k < s->start_count && s->occupied[s->starts[k]]) {
+                k++;
+            }
+            if (k < s->start_count) {
+                f->start_index = k + 1;
+                cell_stack_push(&s->path, NO_CELL);
+                occupy(s, s->starts[k]);
+                enter(s, s->starts[k], k + 1, SEARCH_FRESH | SEARCH_CHAIN_START);
+                continue;
+            }
+        }
+        leave(s);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Grilles jusqu'à 8x8 : chaque case est un bit d'un mot de 64 bits (indice x*8+y),
+// la victoire se teste sur un seul masque et les voisins accessibles depuis chaque case
+// sont précalculés. L'arbre parcouru est le même que celui de la recherche générale.
+// ---------------------------------------------------------------------------
+
+#define SMALL_STRIDE 8
+#define SMALL_MARKER 0xFF
+static const int small_offset[4] = {-SMALL_STRIDE, SMALL_STRIDE, 1, -1}; // N, S, E, O
+
+typedef struct {
+    const SolveOptions* options;
+    SolveResult* result;
+    int size;
+    uint64_t cells;       // cases non vides
+    uint64_t required;    // cases non nulles
+    uint64_t starts;      // cases 'x'
+    uint64_t occupied;
+    uint64_t reach[64];   // voisins où une chaîne peut avancer depuis chaque case
+    uint64_t enter[64];   // voisins d'où une chaîne peut entrer dans chaque case
+    int values[64];
+    uint8_t path[128];    // au plus 64 cases et 64 séparateurs de chaîne
+    int path_count;
+    unsigned long long nodes;
+    unsigned long long next_check;  // prochain contrôle d'interruption ou de limite
+    uint64_t deadline;
+    bool stop;
+} SmallSearch;
+
+//nombre de bits à 1
+static int count_bits(uint64_t bits) {
+#ifdef __GNUC__
+    return __builtin_popcountll(bits);
+#else
+    int count = 0;
+    for (; bits; bits &= bits - 1) {
+        count++;
+    }
+    return count;
+#endif
+}
+
+//indice du bit de poids faible (bits != 0)
+static int lowest_bit(uint64_t bits) {
+#ifdef __GNUC__
+    return __builtin_ctzll(bits);
+#else
+    int b = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        b++;
+    }
+    return b;
+#endif
+}
+
+static void small_store(SmallSearch* s) {
+    SolveResult* r = s->result;
+    if (r->solutions++ == 0) {
+        cell_stack_reset(&r->path, s->size);
+        for (int i = 0; i < s->path_count; i++) {
+            int b = s->path[i];
+            uint32_t cell = b == SMALL_MARKER ? NO_CELL : (uint32_t)((b / SMALL_STRIDE) * s->size + b % SMALL_STRIDE);
+            cell_stack_push(&r->path, cell);
+        }
+    }
+    if (r->solutions >= s->options->max_solutions) {
+        s->stop = true;
+    }
+}
+
+//cases voisines d'un ensemble de cases (les bits hors de la grille sont à retirer ensuite)
+static uint64_t small_neighbors(uint64_t bits) {
+    const uint64_t first_column = 0x0101010101010101ull;
+    return (bits << SMALL_STRIDE) | (bits >> SMALL_STRIDE) | ((bits << 1) & ~first_column) |
+           ((bits >> 1) & ~(first_column << (SMALL_STRIDE - 1)));
+}
+
+//mêmes coupes que doomed() et regions_doomed(), sur les masques
+static bool small_doomed(const SmallSearch* s, int head, int prev, int next_start, bool boxed) {
+    uint64_t free = s->cells & ~s->occupied;
+    uint64_t head_bit = (uint64_t)1 << head;
+    if (prev >= 0) {
+        for (uint64_t around = small_neighbors((uint64_t)1 << prev) & s->required & free; around; around &= around - 1) {
+            if (!(s->enter[lowest_bit(around)] & (free | head_bit))) {
+                return true;
+            }
+        }
+    }
+    int only_head = 0;
+    for (uint64_t next = s->reach[head] & s->required & free; next; next &= next - 1) {
+        if (!(s->enter[lowest_bit(next)] & free) && ++only_head > 1) {
+            return true;
+        }
+    }
+
+    static const int ring_dx[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+    static const int ring_dy[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+    bool ring[8];
+    for (int i = 0; i < 8; i++) {
+        int x = head / SMALL_STRIDE + ring_dx[i], y = head % SMALL_STRIDE + ring_dy[i];
+        ring[i] = x >= 0 && x < s->size && y >= 0 && y < s->size && (free >> (x * SMALL_STRIDE + y) & 1);
+    }
+    if (!(s->starts & head_bit) && !boxed && !ring_splits(ring)) {
+        return false;
+    }
+    uint64_t usable = next_start < 64 ? s->starts & free & (~(uint64_t)0 << next_start) : 0;
+    uint64_t entry = boxed ? 0 : s->reach[head] & free;
+    int served = 0;
+    for (uint64_t todo = s->required & free; todo;) {
+        uint64_t region = todo & (~todo + 1);
+        for (uint64_t grown = region;; region = grown) {
+            grown = (region | small_neighbors(region)) & free;
+            if (grown == region) {
+                break;
+            }
+        }
+        todo &= ~region;
+        if (!(region & usable) && (!(region & entry) || ++served > 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void small_extend(SmallSearch* s, int head, int prev, int next_start, bool fresh);
+
+//démarrer une chaîne sur un 'x' libre de bit >= next_start (même ordre que start_chain) ;
+//prev : tête de la chaîne précédente
+static void small_start(SmallSearch* s, int prev, int next_start) {
+    uint64_t free_starts = s->starts & ~s->occupied & (~(uint64_t)0 << next_start);
+    while (free_starts && !s->stop) {
+        int start = lowest_bit(free_starts);
+        uint64_t bit = (uint64_t)1 << start;
+        free_starts &= ~bit;
+        s->path[s->path_count++] = SMALL_MARKER;
+        s->path[s->path_count++] = (uint8_t)start;
+        s->occupied |= bit;
+        small_extend(s, start, prev, start + 1, true);
+        s->occupied &= ~bit;
+        s->path_count -= 2;
+    }
+}
+
+static void small_extend(SmallSearch* s, int head, int prev, int next_start, bool fresh) {
+    if (++s->nodes >= s->next_check) {
+        s->result->nodes = s->nodes;
+        if (check_cancel(s->result, s->options, s->deadline)) {
+            s->stop = true;
+            return;
+        }
+        // contrôle suivant : prochain multiple de 1024, ou juste après la limite de noeuds
+        unsigned long long limit = s->options->max_nodes;
+        s->next_check = s->nodes + 1024 - (s->nodes & 1023);
+        if (limit && limit + 1 < s->next_check) {
+            s->next_check = limit + 1;
+        }
+    }
+    if ((s->required & ~s->occupied) == 0) {
+        small_store(s);
+        return;
+    }
+
+    uint64_t open = s->reach[head] & ~s->occupied;
+    if (s->options->prune && small_doomed(s, head, prev, next_start, open == 0)) {
+        s->result->pruned++;
+        return;
+    }
+    MoveOrder order = s->options->order;
+    Candidate moves[4];
+    int count = 0;
+    for (int d = 0; d < 4 && open; d++) {
+        int to = head + small_offset[d];
+        if (to < 0 || to >= 64 || !(open & ((uint64_t)1 << to))) {
+            continue;
+        }
+        // mêmes scores que move_score(), sur les masques ; pas de tri pour l'ordre fixe
+        moves[count].to = to;
+        moves[count].score = order == ORDER_FIXED ? 0
+                           : order == ORDER_LOW_VALUE ? s->values[to]
+                           : count_bits((order == ORDER_CONSTRAINED ? s->enter[to] : s->reach[to]) & ~s->occupied);
+        count++;
+    }
+    if (order != ORDER_FIXED) {
+        sort_candidates(moves, count);
+    }
+    for (int i = 0; i < count && !s->stop; i++) {
+        int to = moves[i].to;
+        uint64_t bit = (uint64_t)1 << to;
+        s->occupied |= bit;
+        s->path[s->path_count++] = (uint8_t)to;
+        small_extend(s, to, head, next_start, false);
+        s->path_count--;
+        s->occupied &= ~bit;
+    }
+
+    if (!fresh && !s->stop && next_start < 64) {
+        small_start(s, head, next_start);
+    }
+}
+
+static void solve_small(const Level* level, const SolveOptions* options, SolveResult* result, uint64_t deadline) {
+    int n = level->size;
+    SmallSearch s = {0};
+    s.options = options;
+    s.result = result;
+    s.size = n;
+    s.next_check = 1;
+    s.deadline = deadline;
+
+    for (int x = 0; x < n; x++) {
+        for (int y = 0; y < n; y++) {
+            int b = x * SMALL_STRIDE + y;
+            int value = level->values[x * n + y];
+            s.values[b] = value;
+            if (value != -1) {
+                s.cells |= (uint64_t)1 << b;
+            }
+            if (value == 0) {
+                s.starts |= (uint64_t)1 << b;
+            } else if (value > 0) {
+                s.required |= (uint64_t)1 << b;
+            }
+            for (int d = 0; d < 4 && value != -1; d++) {
+                int nx = x + dir_dx[d], ny = y + dir_dy[d];
+                if (nx < 0 || nx >= n || ny < 0 || ny >= n) {
+                    continue;
+                }
+                int to_value = level->values[nx * n + ny];
+                if (to_value != -1 && (value == 0 || to_value >= value)) {
+                    s.reach[b] |= (uint64_t)1 << (nx * SMALL_STRIDE + ny);
+                    s.enter[nx * SMALL_STRIDE + ny] |= (uint64_t)1 << b;
+                }
+            }
+        }
+    }
+
+    TRACE_START(search_trace);
+    if (s.required == 0) {
+        small_store(&s);
+    } else {
+        small_start(&s, -1, 0);
+    }
+    result->nodes = s.nodes;
+    TRACE_END_ARG(search_trace, TRACE_SOLVE_SEARCH, s.nodes);
+}
+
+//recherche générale, sur un tableau de voisins précalculé
+static void solve_generic(const Level* level, const SolveOptions* options, SolveResult* result, uint64_t deadline) {
+    int n = level->size;
+    int cells = n * n;
+    // tableaux de travail découpés dans une arène, rendus d'un coup à la fin
+    Arena local = {0};
+    Arena* arena = options->scratch ? options->scratch : &local;
+    ArenaMark mark = arena_mark(arena);
+    TRACE_START(setup_trace);
+    Search s = {0};
+    s.level = level;
+    s.options = options;
+    s.result = result;
+    s.values = level->values;
+    // les indices de case sont des int : au-delà (côté 46337 et plus, blocs complétés), la
+    // recherche reste en ordre des lignes
+    if (morton_wanted(n) && morton_cells(n) <= INT_MAX) {
+        // grandes grilles : valeurs, occupation, voisins et régions en ordre de Morton
+        MortonLayout* layout = arena_alloc(arena, sizeof(MortonLayout));
+        morton_init(layout, n, arena);
+        int* values = arena_alloc(arena, layout->cells * sizeof(int));
+        s.cell_of = arena_alloc(arena, layout->cells * sizeof(int));
+        for (size_t c = 0; c < layout->cells; c++) {
+            values[c] = -1;
+            s.cell_of[c] = -1;
+        }
+        for (int c = 0; c < n * n; c++) {
+            uint32_t i = morton_index(layout, c / n, c % n);
+            values[i] = level->values[c];
+            s.cell_of[i] = c;
+        }
+        s.morton = layout;
+        s.values = values;
+        cells = (int)layout->cells;
+    }
+    s.cells = cells;
+    s.next = arena_alloc(arena, (size_t)cells * sizeof(*s.next));
+    s.occupied = arena_calloc(arena, (size_t)cells, 1);
+    s.starts = arena_alloc(arena, (size_t)cells * sizeof(int));
+    s.start_rank = arena_alloc(arena, (size_t)cells * sizeof(int));
+    if (options->prune) {
+        s.marks = arena_calloc(arena, (size_t)cells, sizeof(uint32_t));
+        s.fill = arena_alloc(arena, (size_t)cells * sizeof(int));
+    }
+    s.path.arena = arena;
+    cell_stack_reset(&s.path, n);
+
+    for (int c = 0; c < cells; c++) {
+        s.start_rank[c] = -1;
+    }
+    // départs pris dans l'ordre des lignes, quel que soit le rangement : même arbre de recherche
+    for (int rc = 0; rc < n * n; rc++) {
+        int x = rc / n, y = rc % n;
+        int c = cell_at(&s, x, y);
+        for (int d = 0; d < 4; d++) {
+            int nx = x + dir_dx[d], ny = y + dir_dy[d];
+            bool inside = nx >= 0 && nx < n && ny >= 0 && ny < n;
+            s.next[c][d] = inside && s.values[cell_at(&s, nx, ny)] != -1 ? cell_at(&s, nx, ny) : -1;
+        }
+        if (s.values[c] == 0) {
+            s.start_rank[c] = s.start_count;
+            s.starts[s.start_count++] = c;
+        } else if (s.values[c] > 0) {
+            s.uncovered++;
+        }
+    }
+    s.required = s.uncovered;
+    s.deadline = deadline;
+
+    // pile explicite : une trame par case au plus, plus la racine (aucune case, départs dès 0)
+    s.frames = arena_alloc(arena, ((size_t)n * n + 1) * sizeof(SearchFrame));
+    TRACE_END(setup_trace, TRACE_SOLVE_SETUP);
+    TRACE_START(load_trace);
+    result->resumed = options->checkpoint && options->resume && load_checkpoint(&s);
+    if (options->checkpoint && options->resume) {
+        TRACE_END(load_trace, TRACE_SOLVE_CHECKPOINT);
+    }
+    if (!result->resumed) {
+        memset(&s.frames[0], 0, sizeof(SearchFrame));
+        s.frames[0].head = -1;
+        s.depth = 1;
+    }
+    if (options->checkpoint && options->checkpoint_seconds > 0) {
+        s.saved_ns = stats_now_ns();
+        s.save_at = result->nodes + CHECKPOINT_CHECK_NODES;
+    }
+
+    TRACE_START(search_trace);
+    if (s.uncovered == 0 && !result->resumed) {
+        record_solution(&s); // rien à couvrir
+    } else {
+        run_search(&s);
+    }
+    TRACE_END_ARG(search_trace, TRACE_SOLVE_SEARCH, result->nodes);
+    if (options->checkpoint) {
+        // interrompue : la pile est gardée telle quelle ; terminée : plus rien à reprendre
+        if (result->status == SOLVE_CANCELLED) {
+            TRACE_START(save_trace);
+            save_checkpoint(&s);
+            TRACE_END(save_trace, TRACE_SOLVE_CHECKPOINT);
+        } else {
+            remove(options->checkpoint);
+        }
+    }
+
+    arena_rewind(arena, mark);
+}
+
+//chercher une (ou plusieurs) solutions d'un niveau
+SolveStatus solve_level(const Level* level, const SolveOptions* options, SolveResult* result) {
+    STAT_TIMER_START(solve_start);
+    TRACE_START(solve_trace);
+    result->status = SOLVE_NONE;
+    result->solutions = 0;
+    result->nodes = 0;
+    result->pruned = 0;
+    result->resumed = false;
+    result->required = 0;
+    result->best_covered = 0;
+    result->optimal = false;
+    cell_stack_reset(&result->best, level->size);
+    for (int c = 0; c < level->size * level->size; c++) {
+        result->required += level->values[c] > 0;
+    }
+    uint64_t deadline = options->time_limit > 0 ? stats_now_ns() + (uint64_t)(options->time_limit * 1e9) : 0;
+    // mode anytime : une branche coupée peut encore contenir la meilleure couverture partielle
+    SolveOptions effective = *options;
+    effective.prune = options->prune && !options->anytime;
+    options = &effective;
+
+    // recherche : choix à la taille de la grille, mot de 64 bits jusqu'à 8x8 ; la meilleure
+    // couverture partielle et le point de reprise ne sont suivis que par la recherche générale
+    if (options->engine == ENGINE_SAT) {
+        solve_level_sat(level, options, result);
+    } else if (level->size <= SMALL_STRIDE && options->allow_bitboard && !options->checkpoint && !options->anytime) {
+        solve_small(level, options, result, deadline);
+    } else {
+        solve_generic(level, options, result, deadline);
+    }
+    if (result->status != SOLVE_CANCELLED) {
+        result->status = result->solutions > 0 ? SOLVE_FOUND : SOLVE_NONE;
+    }
+    // optimum prouvé : couverture complète, ou arbre entier parcouru sans coupe (une reprise ne
+    // connaît pas les couvertures partielles vues avant le point de reprise)
+    if (result->solutions > 0) {
+        result->best_covered = result->required;
+        result->optimal = true;
+    } else {
+        result->optimal = options->anytime && options->engine == ENGINE_SEARCH &&
+                          result->status == SOLVE_NONE && !result->resumed && result->pruned == 0;
+    }
+
+    STAT_ADD(STAT_SOLVER_RUNS, 1);
+    STAT_ADD(STAT_SOLVER_NODES, result->nodes);
+    STAT_TIMER_ADD(solve_start, STAT_SOLVER_NS);
+    TRACE_END_ARG(solve_trace, TRACE_SOLVE, result->nodes);
+    return result->status;
+}
+
+//libérer la solution mémorisée
+void solve_result_free(SolveResult* result) {
+    cell_stack_free(&result->path);
+    cell_stack_free(&result->best);
+}
+
+//afficher des chaînes : départ de chaque chaîne puis directions à jouer
+static void print_chains(const Level* level, const CellStack* path) {
+    int n = level->size;
+    int chain = 0;
+    int prev = -1;
+    for (size_t i = 0; i < path->count; i++) {
+        uint32_t cell = cell_stack_get(path, i);
+        if (cell == NO_CELL) {
+            if (chain > 0) {
+                printf("\n");
+            }
+            prev = -1;
+            continue;
+        }
+        int x = (int)cell / n, y = (int)cell % n;
+        if (prev < 0) {
+            printf("Chaine %d : depart (%d %d)", ++chain, x, y);
+        } else {
+            int px = prev / n, py = prev % n;
+            for (int d = 0; d < 4; d++) {
+                if (px + dir_dx[d] == x && py + dir_dy[d] == y) {
+                    printf(" %c", dir_names[d]);
+                }
+            }
+        }
+        prev = (int)cell;
+    }
+    if (chain > 0) {
+        printf("\n");
+    }
+}
+
+//afficher la première solution trouvée
+void print_solution(const Level* level, const SolveResult* result) {
+    print_chains(level, &result->path);
+}
+
+//afficher la meilleure couverture partielle (mode anytime)
+void print_best(const Level* level, const SolveResult* result) {
+    print_chains(level, &result->best);
+}
@@ -0,0 +1,80 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include "arena.h"
+#include "cellstack.h"
+#include "level.h"
+
+// Recherche exhaustive d'un ensemble de chaînes couvrant toutes les cases non nulles.
+// Chaque chaîne part d'un 'x' (0) et suit les règles de is_valid_move().
+
+typedef enum {
+    SOLVE_NONE,       // aucune solution
+    SOLVE_FOUND,      // au moins une solution
+    SOLVE_CANCELLED   // recherche interrompue (ou limite de noeuds atteinte)
+} SolveStatus;
+
+// Ordre d'essai des directions depuis la tête d'une chaîne (à score égal : N, S, E, O).
+// Les départs de chaînes restent pris par indice croissant.
+typedef enum {
+    ORDER_FIXED,        // N, S, E, O comme les commandes de play_game()
+    ORDER_CONSTRAINED,  // d'abord la case que le moins de voisins libres peuvent encore atteindre
+    ORDER_LOW_VALUE,    // d'abord le voisin de plus petite valeur
+    ORDER_WARNSDORFF,   // d'abord la case d'où partent le moins de mouvements (règle de Warnsdorff)
+    ORDER_COUNT
+} MoveOrder;
+
+typedef enum {
+    ENGINE_SEARCH,      // recherche en profondeur
+    ENGINE_SAT          // codage CNF et solveur CDCL (cnf.h), pour les grilles trop dures à parcourir
+} SolveEngine;
+
+typedef struct {
+    int max_solutions;          // arrêt après ce nombre de solutions (2 pour tester l'unicité)
+    const atomic_bool* cancel;  // interruption demandée par un autre thread (optionnel)
+    bool allow_bitboard;        // recherche sur mot de 64 bits pour les grilles jusqu'à 8x8
+    unsigned long long max_nodes; // abandon (SOLVE_CANCELLED) au-delà de ce nombre de noeuds, 0 = sans limite
+    Arena* scratch;             // mémoire de travail réutilisée d'une résolution à l'autre (optionnel)
+    MoveOrder order;            // heuristique d'ordre des mouvements
+    SolveEngine engine;         // ENGINE_SAT : noeuds = décisions du solveur SAT
+    // Point de reprise (recherche générale seulement, même sur les petites grilles) : la pile de
+    // la recherche est écrite dans ce fichier toutes les checkpoint_seconds et à l'interruption,
+    // et effacée quand la recherche se termine. resume : repartir du fichier s'il correspond
+    // au niveau, à l'ordre et au nombre de solutions demandés.
+    const char* checkpoint;
+    double checkpoint_seconds;  // 0 : seulement à l'interruption
+    bool resume;
+    double time_limit;          // secondes avant abandon (SOLVE_CANCELLED), 0 = sans limite (recherche)
+    // Mode anytime (recherche générale) : garder dans best la couverture partielle qui couvre le
+    // plus de cases non nulles, pour répondre même si l'échéance arrive avant la fin.
+    bool anytime;
+    // Coupes (recherche) : abandon d'une branche dès qu'une case non nulle ne peut plus être
+    // atteinte. Solutions inchangées, moins de noeuds. Sans effet en mode anytime : une branche
+    // sans solution peut encore porter la meilleure couverture partielle.
+    bool prune;
+} SolveOptions;
+
+typedef struct {
+    SolveStatus status;
+    int solutions;
+    unsigned long long nodes;
+    unsigned long long pruned;  // noeuds abandonnés par les coupes
+    CellStack path;   // première solution : cases de chaque chaîne, chaînes séparées par NO_CELL
+    bool resumed;     // la recherche est repartie d'un point de reprise (nodes compte aussi les noeuds d'avant)
+    int required;     // cases non nulles du niveau (celles que check_victory() demande de couvrir)
+    int best_covered; // cases couvertes par la meilleure couverture (required si une solution est trouvée)
+    CellStack best;   // mode anytime : chaînes de la meilleure couverture partielle, comme path
+    bool optimal;     // best_covered est prouvé maximal : solution trouvée, ou arbre entier parcouru
+} SolveResult;
+
+void solve_options_default(SolveOptions* options);
+const char* move_order_name(MoveOrder order);
+bool move_order_parse(const char* name, MoveOrder* order);
+SolveStatus solve_level(const Level* level, const SolveOptions* options, SolveResult* result);
+void solve_result_free(SolveResult* result);
+void print_solution(const Level* level, const SolveResult* result);
+void print_best(const Level* level, const SolveResult* result);
+
+#endif
@@ -0,0 +1,588 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "spectate.h"
+#include "level.h"
+#include "queue.h"
+#include "rng.h"
+#include "stats.h"
+#include "trace.h"
+
+// ---------------------------------------------------------------------------
+// Trames
+// ---------------------------------------------------------------------------
+
+//allouer une trame et son contenu d'un seul bloc (items cases ou N*N valeurs et chaînes)
+static Frame* frame_new(FrameKind kind, size_t items) {
+    size_t item_size = kind == FRAME_DIFF ? sizeof(FrameCell) : 2 * sizeof(int32_t);
+    Frame* frame = malloc(sizeof(Frame) + items * item_size);
+    if (!frame) {
+        return NULL;
+    }
+    memset(frame, 0, sizeof(*frame));
+    atomic_init(&frame->refs, 1);
+    frame->kind = kind;
+    if (kind == FRAME_DIFF) {
+        frame->cells = (FrameCell*)(frame + 1);
+    } else {
+        frame->values = (int32_t*)(frame + 1);
+        frame->chains = frame->values + items / 2;
+    }
+    return frame;
+}
+
+void frame_retain(Frame* frame) {
+    atomic_fetch_add_explicit(&frame->refs, 1, memory_order_relaxed);
+}
+
+//rendre une référence ; la dernière libère la trame
+void frame_release(Frame* frame) {
+    if (frame && atomic_fetch_sub_explicit(&frame->refs, 1, memory_order_acq_rel) == 1) {
+        free(frame);
+    }
+}
+
+//position et état de la partie après la dernière commande
+static void frame_fill(Frame* frame, const Broadcast* b, const Session* session) {
+    const Board* board = &session->board;
+    frame->sequence = b->sequence;
+    frame->level_number = session->level_number;
+    frame->size = board->size;
+    frame->head = session->has_started ? (uint32_t)session->last_x * (uint32_t)board->size + (uint32_t)session->last_y
+                                       : NO_CELL;
+    frame->current_chain = session->current_chain;
+    frame->victory = session->has_started && check_victory(board);
+}
+
+//image complète de l'état courant, partagée par tous les spectateurs qui en ont besoin
+static Frame* current_snapshot(Broadcast* b, const Session* session) {
+    if (b->snapshot) {
+        return b->snapshot;
+    }
+    const Board* board = &session->board;
+    size_t cells = (size_t)board->size * board->size;
+    Frame* frame = frame_new(FRAME_SNAPSHOT, 2 * cells);
+    if (!frame) {
+        return NULL;
+    }
+    frame_fill(frame, b, session);
+    if (cells > 0) {
+        board_copy_layers(board, frame->values, frame->chains);
+    }
+    b->snapshot = frame;
+    b->snapshots++;
+    return frame;
+}
+
+//l'état a changé : l'image gardée n'est plus à jour
+static void drop_snapshot(Broadcast* b) {
+    frame_release(b->snapshot);
+    b->snapshot = NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Files des spectateurs (un écrivain, un lecteur)
+// ---------------------------------------------------------------------------
+
+static bool has_room(const Spectator* s) {
+    size_t tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&s->head, memory_order_acquire);
+    return tail - head <= s->mask;
+}
+
+static bool spectator_push(Spectator* s, Frame* frame) {
+    if (!has_room(s)) {
+        return false;
+    }
+    size_t tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+    frame_retain(frame);
+    s->slots[tail & s->mask] = frame;
+    atomic_store_explicit(&s->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+//prendre la trame suivante, NULL si la file est vide
+Frame* spectator_poll(Spectator* s) {
+    size_t head = atomic_load_explicit(&s->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&s->tail, memory_order_acquire)) {
+        return NULL;
+    }
+    Frame* frame = s->slots[head & s->mask];
+    atomic_store_explicit(&s->head, head + 1, memory_order_release);
+    return frame;
+}
+
+//remettre à jour un spectateur décroché dès que sa file a de la place
+static void resync(Broadcast* b, Spectator* s, const Session* session) {
+    Frame* snapshot = has_room(s) ? current_snapshot(b, session) : NULL;
+    if (snapshot && spectator_push(s, snapshot)) {
+        s->lagging = false;
+        s->resyncs++;
+    }
+}
+
+//envoyer une trame à un spectateur ; file pleine : il décroche jusqu'à sa prochaine image
+static void deliver(Broadcast* b, Spectator* s, Frame* frame, const Session* session) {
+    if (s->lagging) {
+        s->dropped++;
+        resync(b, s, session); // l'image contient déjà cette commande
+    } else if (spectator_push(s, frame)) {
+        s->delivered++;
+    } else {
+        s->lagging = true;
+        s->dropped++;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Diffusion
+// ---------------------------------------------------------------------------
+
+void broadcast_init(Broadcast* b, size_t buffer) {
+    memset(b, 0, sizeof(*b));
+    b->buffer = buffer ? buffer : 1;
+}
+
+void broadcast_free(Broadcast* b) {
+    while (b->count > 0) {
+        broadcast_leave(b, b->spectators[b->count - 1]);
+    }
+    free(b->spectators);
+    drop_snapshot(b);
+    cell_stack_free(&b->touched);
+    memset(b, 0, sizeof(*b));
+}
+
+//ajouter un spectateur ; sa file commence par une image de la partie
+Spectator* broadcast_join(Broadcast* b, const Session* session) {
+    if (session->board.tiles) {
+        return NULL; // pas d'image complète d'une grille tuilée
+    }
+    if (b->count == b->capacity) {
+        size_t capacity = b->capacity ? b->capacity * 2 : 16;
+        Spectator** spectators = realloc(b->spectators, capacity * sizeof(Spectator*));
+        if (!spectators) {
+            return NULL;
+        }
+        b->spectators = spectators;
+        b->capacity = capacity;
+    }
+    size_t slots = 1;
+    while (slots < b->buffer) {
+        slots *= 2;
+    }
+    Spectator* s = aligned_alloc(64, (sizeof(Spectator) + 63) / 64 * 64);
+    if (!s) {
+        return NULL;
+    }
+    memset(s, 0, sizeof(*s));
+    s->slots = malloc(slots * sizeof(Frame*));
+    if (!s->slots) {
+        free(s);
+        return NULL;
+    }
+    s->mask = slots - 1;
+    atomic_init(&s->head, 0);
+    atomic_init(&s->tail, 0);
+    s->lagging = true;
+    resync(b, s, session);
+    b->spectators[b->count++] = s;
+    return s;
+}
+
+//retirer un spectateur dont le lecteur s'est arrêté, et rendre ses trames en attente
+void broadcast_leave(Broadcast* b, Spectator* spectator) {
+    for (size_t i = 0; i < b->count; i++) {
+        if (b->spectators[i] == spectator) {
+            b->spectators[i] = b->spectators[--b->count];
+            break;
+        }
+    }
+    Frame* frame;
+    while ((frame = spectator_poll(spectator))) {
+        frame_release(frame);
+    }
+    free(spectator->slots);
+    free(spectator);
+}
+
+//nouveau niveau (ou partie rechargée) : tous les spectateurs reçoivent une image
+void broadcast_level(Broadcast* b, const Session* session) {
+    b->sequence++;
+    drop_snapshot(b);
+    for (size_t i = 0; i < b->count; i++) {
+        b->spectators[i]->lagging = true;
+        resync(b, b->spectators[i], session);
+    }
+}
+
+//noter, avant une commande, les cases qu'elle peut libérer : seules les cases de la pile
+//des mouvements ont pu être occupées, la grille n'est jamais parcourue en entier
+void broadcast_prepare(Broadcast* b, const Session* session, HistoryCommand command) {
+    const Board* board = &session->board;
+    const CellStack* moves = &session->moves;
+    cell_stack_reset(&b->touched, board->size);
+    b->moves_before = moves->count;
+    if (command == HISTORY_UNDO && moves->count > 0) {
+        cell_stack_push(&b->touched, cell_stack_top(moves));
+    } else if (command == HISTORY_ERASE || command == HISTORY_RESTART) {
+        for (size_t i = 0; i < moves->count; i++) {
+            uint32_t cell = cell_stack_get(moves, i);
+            int chain = cell_chain(board, (int)cell / board->size, (int)cell % board->size);
+            if (chain != 0 && (command == HISTORY_RESTART || chain == session->current_chain)) {
+                cell_stack_push(&b->touched, cell);
+            }
+        }
+    }
+}
+
+static int compare_cells(const void* a, const void* b) {
+    uint32_t x = ((const FrameCell*)a)->cell, y = ((const FrameCell*)b)->cell;
+    return (x > y) - (x < y);
+}
+
+//publier la commande acceptée depuis broadcast_prepare() : une trame pour tous
+void broadcast_publish(Broadcast* b, const Session* session) {
+    const Board* board = &session->board;
+    const CellStack* moves = &session->moves;
+    size_t added = moves->count > b->moves_before ? moves->count - b->moves_before : 0;
+    Frame* frame = frame_new(FRAME_DIFF, b->touched.count + added);
+    if (!frame) {
+        return;
+    }
+
+    // une case peut figurer plusieurs fois dans la pile (effacée puis reprise) : tri et dédoublonnage
+    uint32_t count = 0;
+    for (size_t i = 0; i < b->touched.count; i++) {
+        frame->cells[count++].cell = cell_stack_get(&b->touched, i);
+    }
+    qsort(frame->cells, count, sizeof(FrameCell), compare_cells);
+    uint32_t unique = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (unique == 0 || frame->cells[unique - 1].cell != frame->cells[i].cell) {
+            frame->cells[unique++].cell = frame->cells[i].cell;
+        }
+    }
+    for (size_t i = b->moves_before; i < moves->count; i++) {
+        frame->cells[unique++].cell = cell_stack_get(moves, i);
+    }
+    for (uint32_t i = 0; i < unique; i++) {
+        uint32_t cell = frame->cells[i].cell;
+        frame->cells[i].chain = cell_chain(board, (int)cell / board->size, (int)cell % board->size);
+    }
+    frame->count = unique;
+    cell_stack_reset(&b->touched, board->size);
+
+    b->sequence++;
+    drop_snapshot(b);
+    frame_fill(frame, b, session);
+    b->frames++;
+    b->frame_cells += unique;
+    for (size_t i = 0; i < b->count; i++) {
+        deliver(b, b->spectators[i], frame, session);
+    }
+    frame_release(frame);
+}
+
+//remettre à jour les spectateurs décrochés qui ont de nouveau de la place (partie au repos) ;
+//renvoie le nombre de ceux qui attendent encore
+size_t broadcast_flush(Broadcast* b, const Session* session) {
+    size_t waiting = 0;
+    for (size_t i = 0; i < b->count; i++) {
+        Spectator* s = b->spectators[i];
+        if (s->lagging) {
+            resync(b, s, session);
+            waiting += s->lagging;
+        }
+    }
+    return waiting;
+}
+
+// ---------------------------------------------------------------------------
+// Grille d'un spectateur
+// ---------------------------------------------------------------------------
+
+//appliquer une trame ; false si elle ne suit pas l'état du spectateur (trame manquante)
+bool spectator_view_apply(SpectatorView* view, const Frame* frame) {
+    if (frame->kind == FRAME_SNAPSHOT) {
+        if (frame->sequence < view->sequence) {
+            return false;
+        }
+        size_t cells = (size_t)frame->size * frame->size;
+        if (frame->size != view->size) {
+            int32_t* values = realloc(view->values, 2 * cells * sizeof(int32_t));
+            if (!values && cells > 0) {
+                return false;
+            }
+            view->values = values;
+            view->chains = values + cells;
+            view->size = frame->size;
+        }
+        memcpy(view->values, frame->values, cells * sizeof(int32_t));
+        memcpy(view->chains, frame->chains, cells * sizeof(int32_t));
+    } else {
+        if (frame->sequence != view->sequence + 1 || frame->size != view->size || !view->values) {
+            return false;
+        }
+        for (uint32_t i = 0; i < frame->count; i++) {
+            view->chains[frame->cells[i].cell] = frame->cells[i].chain;
+        }
+    }
+    view->sequence = frame->sequence;
+    view->level_number = frame->level_number;
+    view->head = frame->head;
+    view->current_chain = frame->current_chain;
+    view->victory = frame->victory;
+    return true;
+}
+
+//comparer la grille reconstruite à celle de la partie
+bool spectator_view_matches(const SpectatorView* view, const Session* session) {
+    const Board* board = &session->board;
+    size_t cells = (size_t)board->size * board->size;
+    uint32_t head = session->has_started ? (uint32_t)(session->last_x * board->size + session->last_y) : NO_CELL;
+    if (view->size != board->size || view->level_number != session->level_number || view->head != head ||
+        view->current_chain != session->current_chain ||
+        view->victory != (session->has_started && check_victory(board))) {
+        return false;
+    }
+    if (!board->morton) {
+        return memcmp(view->values, board->grid[0], cells * sizeof(int32_t)) == 0 &&
+               memcmp(view->chains, board->chain_grid[0], cells * sizeof(int32_t)) == 0;
+    }
+    for (size_t c = 0; c < cells; c++) {
+        int x = (int)(c / board->size), y = (int)(c % board->size);
+        if (view->values[c] != cell_value(board, x, y) || view->chains[c] != cell_chain(board, x, y)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void spectator_view_free(SpectatorView* view) {
+    free(view->values);
+    memset(view, 0, sizeof(*view));
+}
+
+// ---------------------------------------------------------------------------
+// Banc d'essai : une partie jouée au hasard, des spectateurs lus par quelques threads
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    Spectator* spectator;
+    SpectatorView view;
+    bool slow;
+    bool broken;        // trame hors séquence
+    uint64_t frames;
+} Watcher;
+
+typedef struct {
+    Watcher* watchers;
+    int count;
+    const atomic_bool* done;
+    pthread_t thread;
+} Reader;
+
+void spectate_options_default(SpectateOptions* options) {
+    options->spectators = 1000;
+    options->threads = 2;
+    options->buffer = 64;
+    options->slow_rate = 0.01;
+    options->commands = 100000;
+    options->level_file = NULL;
+    options->seed = 1;
+}
+
+//lire toutes les trames arrivées pour un spectateur
+static bool drain(Watcher* w) {
+    bool read = false;
+    Frame* frame;
+    while ((frame = spectator_poll(w->spectator))) {
+        if (!spectator_view_apply(&w->view, frame)) {
+            w->broken = true;
+        }
+        w->frames++;
+        frame_release(frame);
+        read = true;
+    }
+    return read;
+}
+
+//un lecteur sert ses spectateurs à tour de rôle ; les lents ne sont lus qu'un tour sur
+//SPECTATE_SLOW_PERIOD tant que la partie continue
+static void* reader_loop(void* arg) {
+    Reader* reader = arg;
+    trace_thread_name("spectateurs");
+    int idle = 0;
+    for (uint64_t round = 0;; round++) {
+        bool finished = atomic_load_explicit(reader->done, memory_order_acquire);
+        bool read = false;
+        for (int i = 0; i < reader->count; i++) {
+            Watcher* w = &reader->watchers[i];
+            if (finished || !w->slow || round % SPECTATE_SLOW_PERIOD == 0) {
+                read |= drain(w);
+            }
+        }
+        if (finished) {
+            return NULL; // dernier passage après la fin de la partie
+        }
+        idle = read ? 0 : idle + 1;
+        if (idle > 0) {
+            queue_backoff(idle);
+        }
+    }
+}
+
+//commande tirée au hasard, diffusée si la partie l'accepte
+static bool random_command(Session* s, Broadcast* b, const uint32_t* starts, int start_count, uint32_t* rng) {
+    static const char directions[4] = {'N', 'S', 'E', 'O'};
+    int n = s->board.size;
+    uint32_t r = rng_next(rng) % 100;
+    SessionStatus status = SESSION_OK;
+    if (!s->has_started) {
+        uint32_t cell = starts[rng_next(rng) % (uint32_t)start_count];
+        broadcast_prepare(b, s, HISTORY_START);
+        status = session_start(s, (int)cell / n, (int)cell % n);
+    } else if (r < 60) {
+        broadcast_prepare(b, s, HISTORY_MOVE);
+        status = session_move(s, directions[rng_next(rng) % 4]);
+    } else if (r < 78) {
+        broadcast_prepare(b, s, HISTORY_UNDO);
+        status = session_undo(s);
+    } else if (r < 82) {
+        broadcast_prepare(b, s, HISTORY_ERASE);
+        session_erase(s);
+    } else if (r < 97) {
+        uint32_t cell = rng_next(rng) % (uint32_t)(n * n);
+        broadcast_prepare(b, s, HISTORY_SELECT);
+        status = session_select(s, (int)cell / n, (int)cell % n);
+    } else {
+        broadcast_prepare(b, s, HISTORY_RESTART);
+        session_restart(s);
+        session_begin_level(s); // comme play_game(), qui recharge alors le niveau
+    }
+    if (status != SESSION_OK && status != SESSION_VICTORY && status != SESSION_CHAIN_RESUMED) {
+        return false;
+    }
+    broadcast_publish(b, s);
+    return true;
+}
+
+int run_spectate(const SpectateOptions* options) {
+    Level level;
+    char error[160];
+    if (!level_load_file(options->level_file, &level, error, sizeof(error))) {
+        printf("%s\n", error);
+        return 1;
+    }
+    int n = level.size;
+    uint32_t* starts = malloc((size_t)n * n * sizeof(uint32_t));
+    int start_count = 0;
+    for (int c = 0; starts && c < n * n; c++) {
+        if (level.values[c] == 0) {
+            starts[start_count++] = (uint32_t)c;
+        }
+    }
+    if (start_count == 0) {
+        printf("Erreur : le niveau n'a aucune case de depart\n");
+        free(starts);
+        level_free(&level);
+        return 1;
+    }
+
+    Session session;
+    memset(&session, 0, sizeof(session));
+    allocate_grids(&session.board, n, level.values);
+    session.chain_counter = 1;
+    session.start_x = session.start_y = -1;
+    session.level_number = 1;
+    session_begin_level(&session);
+
+    Broadcast b;
+    broadcast_init(&b, (size_t)options->buffer);
+    int spectators = options->spectators > 0 ? options->spectators : 1;
+    int threads = options->threads > 0 ? options->threads : 1;
+    Watcher* watchers = calloc((size_t)spectators, sizeof(Watcher));
+    Reader* readers = calloc((size_t)threads, sizeof(Reader));
+    int slow = 0;
+    for (int i = 0; i < spectators; i++) {
+        watchers[i].spectator = broadcast_join(&b, &session);
+        if (!watchers[i].spectator) {
+            printf("Erreur : memoire insuffisante pour %d spectateurs\n", spectators);
+            return 1;
+        }
+        watchers[i].slow = i < (int)(options->slow_rate * spectators + 0.5);
+        slow += watchers[i].slow;
+    }
+
+    // chaque lecteur prend une tranche contiguë des spectateurs
+    atomic_bool done;
+    atomic_init(&done, false);
+    int started = 0;
+    for (; started < threads; started++) {
+        Reader* r = &readers[started];
+        int first = (int)((long)spectators * started / threads);
+        r->watchers = watchers + first;
+        r->count = (int)((long)spectators * (started + 1) / threads) - first;
+        r->done = &done;
+        if (pthread_create(&r->thread, NULL, reader_loop, r) != 0) {
+            break;
+        }
+    }
+
+    uint32_t rng = options->seed ? options->seed : 1;
+    long accepted = 0, attempts = 0;
+    uint64_t start = stats_now_ns();
+    while (accepted < options->commands) {
+        attempts++;
+        accepted += random_command(&session, &b, starts, start_count, &rng);
+    }
+    uint64_t played = stats_now_ns() - start;
+    // partie au repos : les spectateurs décrochés reçoivent leur image avant la fin
+    for (int attempt = 0; broadcast_flush(&b, &session) > 0; attempt++) {
+        queue_backoff(attempt);
+    }
+    atomic_store_explicit(&done, true, memory_order_release);
+    for (int t = 0; t < started; t++) {
+        pthread_join(readers[t].thread, NULL);
+    }
+
+    uint64_t delivered = 0, dropped = 0, resyncs = 0;
+    int matching = 0;
+    for (int i = 0; i < spectators; i++) {
+        Spectator* s = watchers[i].spectator;
+        delivered += s->delivered;
+        dropped += s->dropped;
+        resyncs += s->resyncs;
+        matching += !watchers[i].broken && spectator_view_matches(&watchers[i].view, &session);
+    }
+
+    double ms = played / 1e6;
+    double cells = b.frames ? (double)b.frame_cells / b.frames : 0;
+    double diff_bytes = sizeof(Frame) + cells * sizeof(FrameCell);
+    double render_bytes = (double)n * (3 * n + 1); // print_grid() sans couleurs
+    printf("Spectateurs : %d (%d lents), %d thread(s) de lecture, file de %d trames\n", spectators, slow, started,
+           options->buffer);
+    printf("Commandes   : %ld acceptees sur %ld en %.1f ms (%.0f/s), %.2f case(s) par trame\n", accepted, attempts, ms,
+           ms > 0 ? accepted * 1000.0 / ms : 0.0, cells);
+    printf("Livraisons  : %llu trames (%.0f/s), %llu perdues, %llu images de reprise (%llu construites)\n",
+           (unsigned long long)delivered, ms > 0 ? delivered * 1000.0 / ms : 0.0, (unsigned long long)dropped,
+           (unsigned long long)resyncs, (unsigned long long)b.snapshots);
+    printf("Memoire     : une trame par commande pour %d files, %.0f octets contre %.0f pour la grille affichee\n",
+           spectators, diff_bytes, render_bytes);
+    printf("Verification : %d spectateur(s) sur %d identiques a la partie\n", matching, spectators);
+
+    for (int i = 0; i < spectators; i++) {
+        spectator_view_free(&watchers[i].view);
+    }
+    broadcast_free(&b);
+    free(watchers);
+    free(readers);
+    free(starts);
+    free_grids(&session.board);
+    cell_stack_free(&session.moves);
+    cell_stack_free(&session.heads);
+    level_free(&level);
+    return matching == spectators ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+#ifndef SPECTATE_H
+#define SPECTATE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cellstack.h"
+#include "history.h"
+#include "session.h"
+
+// Diffusion d'une partie à des spectateurs. Chaque commande acceptée produit une seule trame
+// immuable (cases de chain_grid modifiées, tête de la chaîne courante, victoire), comptée par
+// référence et déposée telle quelle dans la file de chaque spectateur : ni copie ni rendu par
+// spectateur. Les files sont bornées, un seul écrivain (le thread de la partie) et un seul
+// lecteur (la connexion du spectateur). Un spectateur dont la file est pleine décroche : les
+// trames suivantes ne lui sont plus envoyées et, dès que sa file a de la place, il reçoit une
+// image complète de la grille qui remplace les différences perdues.
+// Les images complètes recopient la grille : elles sont réservées aux grilles en mémoire.
+
+typedef enum {
+    FRAME_DIFF,      // cases modifiées par une commande
+    FRAME_SNAPSHOT   // grille entière (nouveau niveau, nouveau spectateur, spectateur décroché)
+} FrameKind;
+
+typedef struct {
+    uint32_t cell;   // x * N + y
+    int32_t chain;   // chaîne après la commande, 0 si la case est libérée
+} FrameCell;
+
+typedef struct {
+    atomic_int refs;
+    FrameKind kind;
+    uint64_t sequence;     // numéro de la commande ; une image porte celui de la dernière appliquée
+    int level_number;
+    int size;
+    uint32_t head;         // tête de la chaîne courante, NO_CELL avant le premier départ
+    int current_chain;
+    bool victory;
+    uint32_t count;        // FRAME_DIFF : nombre de cases de cells
+    FrameCell* cells;
+    int32_t* values;       // FRAME_SNAPSHOT : valeurs puis chaînes, N*N chacune
+    int32_t* chains;
+} Frame;
+
+typedef struct {
+    Frame** slots;
+    size_t mask;
+    _Alignas(64) atomic_size_t tail;  // prochaine case à écrire (thread de la partie)
+    _Alignas(64) atomic_size_t head;  // prochaine case à lire (lecteur)
+    // champs du thread de la partie
+    bool lagging;          // trames perdues : une image complète est due
+    uint64_t delivered;
+    uint64_t dropped;
+    uint64_t resyncs;
+} Spectator;
+
+typedef struct {
+    Spectator** spectators;
+    size_t count;
+    size_t capacity;
+    size_t buffer;         // trames au plus dans la file d'un spectateur
+    uint64_t sequence;
+    Frame* snapshot;       // image de l'état courant, construite au plus une fois par trame
+    CellStack touched;     // cases que la commande en cours peut libérer
+    size_t moves_before;   // hauteur de la pile des mouvements avant la commande
+    uint64_t frames;       // trames de différences publiées
+    uint64_t frame_cells;
+    uint64_t snapshots;
+} Broadcast;
+
+void broadcast_init(Broadcast* b, size_t buffer);
+void broadcast_free(Broadcast* b);
+Spectator* broadcast_join(Broadcast* b, const Session* session);
+void broadcast_leave(Broadcast* b, Spectator* spectator);
+void broadcast_level(Broadcast* b, const Session* session);
+void broadcast_prepare(Broadcast* b, const Session* session, HistoryCommand command);
+void broadcast_publish(Broadcast* b, const Session* session);
+size_t broadcast_flush(Broadcast* b, const Session* session);
+
+// Côté lecteur : la trame renvoyée appartient à l'appelant jusqu'à frame_release()
+Frame* spectator_poll(Spectator* spectator);
+void frame_retain(Frame* frame);
+void frame_release(Frame* frame);
+
+// Grille reconstruite par un spectateur à partir de ses trames
+typedef struct {
+    int size;
+    int level_number;
+    uint64_t sequence;
+    int32_t* values;
+    int32_t* chains;
+    uint32_t head;
+    int current_chain;
+    bool victory;
+} SpectatorView;
+
+bool spectator_view_apply(SpectatorView* view, const Frame* frame);
+bool spectator_view_matches(const SpectatorView* view, const Session* session);
+void spectator_view_free(SpectatorView* view);
+
+typedef struct {
+    int spectators;
+    int threads;           // lecteurs, chacun servant une part des spectateurs
+    int buffer;            // trames par spectateur
+    double slow_rate;      // part des spectateurs lus seulement un tour sur SPECTATE_SLOW_PERIOD
+    long commands;
+    const char* level_file;
+    unsigned seed;
+} SpectateOptions;
+
+#define SPECTATE_SLOW_PERIOD 64
+
+void spectate_options_default(SpectateOptions* options);
+int run_spectate(const SpectateOptions* options);
+
+#endif
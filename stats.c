@@ -0,0 +1,125 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "stats.h"
+
+static StatsFormat dump_format = STATS_OFF;
+
+//horloge monotone en nanosecondes
+uint64_t stats_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+#ifdef CC_STATS
+
+_Thread_local StatBlock* stats_block = NULL;
+
+// Blocs de tous les threads ; un bloc survit à son thread pour être compté à la fin
+static StatBlock* all_blocks = NULL;
+static pthread_mutex_t blocks_lock = PTHREAD_MUTEX_INITIALIZER;
+
+//créer le bloc de compteurs du thread courant (une seule fois par thread)
+StatBlock* stats_register(void) {
+    StatBlock* block = calloc(1, sizeof(StatBlock));
+    pthread_mutex_lock(&blocks_lock);
+    block->next = all_blocks;
+    all_blocks = block;
+    pthread_mutex_unlock(&blocks_lock);
+    stats_block = block;
+    return block;
+}
+
+//additionner les compteurs de tous les threads
+static int stats_collect(uint64_t totals[STAT_COUNT]) {
+    int threads = 0;
+    for (int i = 0; i < STAT_COUNT; i++) {
+        totals[i] = 0;
+    }
+    pthread_mutex_lock(&blocks_lock);
+    for (StatBlock* block = all_blocks; block; block = block->next) {
+        for (int i = 0; i < STAT_COUNT; i++) {
+            if (i == STAT_LEVEL_LOAD_MAX_NS) {
+                totals[i] = block->values[i] > totals[i] ? block->values[i] : totals[i];
+            } else {
+                totals[i] += block->values[i];
+            }
+        }
+        threads++;
+    }
+    pthread_mutex_unlock(&blocks_lock);
+    return threads;
+}
+
+static void stats_dump(void) {
+    uint64_t t[STAT_COUNT];
+    int threads = stats_collect(t);
+    uint64_t rejected = t[STAT_REJECT_NOT_ALIGNED] + t[STAT_REJECT_BOUNDS] + t[STAT_REJECT_VOID] +
+                        t[STAT_REJECT_OCCUPIED] + t[STAT_REJECT_DECREASING];
+    double load_avg_ms = t[STAT_LEVELS_LOADED] ? t[STAT_LEVEL_LOAD_NS] / 1e6 / t[STAT_LEVELS_LOADED] : 0.0;
+    double load_max_ms = t[STAT_LEVEL_LOAD_MAX_NS] / 1e6;
+    double solver_ms = t[STAT_SOLVER_NS] / 1e6;
+    double nodes_per_sec = t[STAT_SOLVER_NS] ? t[STAT_SOLVER_NODES] * 1e9 / t[STAT_SOLVER_NS] : 0.0;
+    double save_avg_us = t[STAT_SNAPSHOT_SAVES] ? t[STAT_SNAPSHOT_NS] / 1e3 / t[STAT_SNAPSHOT_SAVES] : 0.0;
+
+    if (dump_format == STATS_JSON) {
+        fprintf(stderr,
+                "{\"threads\": %d, \"moves_accepted\": %llu, \"moves_rejected\": {\"total\": %llu, "
+                "\"not_aligned\": %llu, \"bounds\": %llu, \"void\": %llu, \"occupied\": %llu, \"decreasing\": %llu}, "
+                "\"renders\": %llu, \"render_bytes\": %llu, \"keys\": %llu, \"levels_loaded\": %llu, \"level_load_avg_ms\": %.3f, "
+                "\"level_load_max_ms\": %.3f, \"solver_runs\": %llu, \"solver_nodes\": %llu, \"solver_ms\": %.3f, "
+                "\"solver_nodes_per_sec\": %.0f, \"snapshots\": %llu, \"snapshot_avg_us\": %.1f}\n",
+                threads, (unsigned long long)t[STAT_MOVES_ACCEPTED], (unsigned long long)rejected,
+                (unsigned long long)t[STAT_REJECT_NOT_ALIGNED], (unsigned long long)t[STAT_REJECT_BOUNDS],
+                (unsigned long long)t[STAT_REJECT_VOID], (unsigned long long)t[STAT_REJECT_OCCUPIED],
+                (unsigned long long)t[STAT_REJECT_DECREASING], (unsigned long long)t[STAT_RENDERS],
+                (unsigned long long)t[STAT_RENDER_BYTES], (unsigned long long)t[STAT_KEYS],
+                (unsigned long long)t[STAT_LEVELS_LOADED], load_avg_ms,
+                load_max_ms, (unsigned long long)t[STAT_SOLVER_RUNS], (unsigned long long)t[STAT_SOLVER_NODES],
+                solver_ms, nodes_per_sec, (unsigned long long)t[STAT_SNAPSHOT_SAVES], save_avg_us);
+        return;
+    }
+
+    fprintf(stderr, "\n--- Statistiques (%d threads) ---\n", threads);
+    fprintf(stderr, "Mouvements acceptes  : %llu\n", (unsigned long long)t[STAT_MOVES_ACCEPTED]);
+    fprintf(stderr, "Mouvements refuses   : %llu (non alignes %llu, hors grille %llu, case vide %llu, "
+                    "case occupee %llu, valeur decroissante %llu)\n",
+            (unsigned long long)rejected, (unsigned long long)t[STAT_REJECT_NOT_ALIGNED],
+            (unsigned long long)t[STAT_REJECT_BOUNDS], (unsigned long long)t[STAT_REJECT_VOID],
+            (unsigned long long)t[STAT_REJECT_OCCUPIED], (unsigned long long)t[STAT_REJECT_DECREASING]);
+    fprintf(stderr, "Affichage            : %llu grilles, %llu octets, %llu touches lues\n",
+            (unsigned long long)t[STAT_RENDERS], (unsigned long long)t[STAT_RENDER_BYTES],
+            (unsigned long long)t[STAT_KEYS]);
+    fprintf(stderr, "Chargement niveaux   : %llu (moyenne %.3f ms, max %.3f ms)\n",
+            (unsigned long long)t[STAT_LEVELS_LOADED], load_avg_ms, load_max_ms);
+    fprintf(stderr, "Solveur              : %llu resolutions, %llu noeuds en %.3f ms (%.0f noeuds/s)\n",
+            (unsigned long long)t[STAT_SOLVER_RUNS], (unsigned long long)t[STAT_SOLVER_NODES], solver_ms,
+            nodes_per_sec);
+    fprintf(stderr, "Sauvegardes          : %llu (moyenne %.1f us)\n",
+            (unsigned long long)t[STAT_SNAPSHOT_SAVES], save_avg_us);
+}
+
+static void stats_dump_at_exit(void) {
+    stats_dump();
+}
+
+//afficher les statistiques sur stderr à la fin du programme
+void stats_enable_dump(StatsFormat format) {
+    if (dump_format == STATS_OFF && format != STATS_OFF) {
+        atexit(stats_dump_at_exit);
+    }
+    dump_format = format;
+}
+
+#else
+
+void stats_enable_dump(StatsFormat format) {
+    dump_format = format;
+    if (format != STATS_OFF) {
+        fprintf(stderr, "Statistiques desactivees a la compilation (option CMake ENABLE_STATS)\n");
+    }
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Compteurs de performance par thread, additionnés à l'affichage.
+// Sans CC_STATS (option CMake ENABLE_STATS=OFF), les macros ne génèrent aucun code.
+
+typedef enum {
+    STAT_MOVES_ACCEPTED,
+    STAT_REJECT_NOT_ALIGNED,
+    STAT_REJECT_BOUNDS,
+    STAT_REJECT_VOID,
+    STAT_REJECT_OCCUPIED,
+    STAT_REJECT_DECREASING,
+    STAT_RENDERS,
+    STAT_RENDER_BYTES,
+    STAT_KEYS,
+    STAT_LEVELS_LOADED,
+    STAT_LEVEL_LOAD_NS,
+    STAT_LEVEL_LOAD_MAX_NS,
+    STAT_SOLVER_RUNS,
+    STAT_SOLVER_NODES,
+    STAT_SOLVER_NS,
+    STAT_SNAPSHOT_SAVES,
+    STAT_SNAPSHOT_NS,
+    STAT_COUNT
+} StatId;
+
+typedef enum {
+    STATS_OFF,
+    STATS_TEXT,
+    STATS_JSON
+} StatsFormat;
+
+typedef struct StatBlock {
+    uint64_t values[STAT_COUNT];
+    struct StatBlock* next;
+} StatBlock;
+
+uint64_t stats_now_ns(void);
+static inline double stats_now_ms(void) {
+    return (double)stats_now_ns() / 1e6;
+}
+void stats_enable_dump(StatsFormat format);
+
+#ifdef CC_STATS
+
+extern _Thread_local StatBlock* stats_block;
+StatBlock* stats_register(void);
+
+static inline StatBlock* stats_local(void) {
+    return stats_block ? stats_block : stats_register();
+}
+
+#define STAT_ADD(id, n) (stats_local()->values[(id)] += (uint64_t)(n))
+#define STAT_MAX(id, v)                                  \
+    do {                                                 \
+        StatBlock* stat_block_ = stats_local();          \
+        if ((uint64_t)(v) > stat_block_->values[(id)]) { \
+            stat_block_->values[(id)] = (uint64_t)(v);   \
+        }                                                \
+    } while (0)
+#define STAT_TIMER_START(var) uint64_t var = stats_now_ns()
+#define STAT_TIMER_ADD(var, id) STAT_ADD(id, stats_now_ns() - (var))
+#define STAT_TIMER_RECORD(var, sum_id, max_id)           \
+    do {                                                 \
+        uint64_t stat_elapsed_ = stats_now_ns() - (var); \
+        STAT_ADD(sum_id, stat_elapsed_);                 \
+        STAT_MAX(max_id, stat_elapsed_);                 \
+    } while (0)
+
+#else
+
+#define STAT_ADD(id, n) ((void)(n)) // argument évalué : il peut avoir un effet (affichage)
+#define STAT_MAX(id, v) ((void)0)
+#define STAT_TIMER_START(var) ((void)0)
+#define STAT_TIMER_ADD(var, id) ((void)0)
+#define STAT_TIMER_RECORD(var, sum_id, max_id) ((void)0)
+
+#endif
+
+#endif
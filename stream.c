@@ -0,0 +1,160 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include "stream.h"
+#include "level.h"
+#include "solver.h"
+#include "stats.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#define STREAM_BUFFER_SIZE (1 << 16)
+#define STREAM_MAX_NODES 1000000ULL  // au-delà, la recherche passe la main au solveur SAT
+
+static const char* const mode_names[] = {"valider", "resoudre", "afficher", "texte", "binaire"};
+
+static Arena solver_scratch; // mémoire de travail du solveur, gardée d'un niveau à l'autre
+
+bool stream_mode_parse(const char* name, StreamMode* mode) {
+    for (int m = 0; m <= STREAM_BINARY; m++) {
+        if (strcmp(name, mode_names[m]) == 0) {
+            *mode = (StreamMode)m;
+            return true;
+        }
+    }
+    return false;
+}
+
+//sauter les blancs entre deux niveaux, renvoie le premier caractère suivant (EOF en fin de flux)
+static int peek_level(FILE* in) {
+    int c;
+    while ((c = getc(in)) != EOF && isspace(c)) {
+    }
+    if (c != EOF) {
+        ungetc(c, in);
+    }
+    return c;
+}
+
+//résoudre par la recherche, puis par le solveur SAT si elle s'épuise
+static void stream_solve(const Level* level, size_t number) {
+    SolveOptions options;
+    solve_options_default(&options);
+    options.max_nodes = STREAM_MAX_NODES;
+    options.scratch = &solver_scratch;
+    SolveResult result = {0};
+    SolveStatus status = solve_level(level, &options, &result);
+    unsigned long long nodes = result.nodes;
+    if (status == SOLVE_CANCELLED) {
+        solve_result_free(&result);
+        options.engine = ENGINE_SAT;
+        status = solve_level(level, &options, &result);
+        nodes += result.nodes;
+    }
+    if (status == SOLVE_FOUND) {
+        printf("niveau %zu : %dx%d, soluble (%llu noeuds)\n", number, level->size, level->size, nodes);
+        print_solution(level, &result);
+    } else if (status == SOLVE_NONE) {
+        printf("niveau %zu : %dx%d, aucune solution (%llu noeuds)\n", number, level->size, level->size, nodes);
+    } else {
+        printf("niveau %zu : %dx%d, abandon (%llu noeuds)\n", number, level->size, level->size, nodes);
+    }
+    solve_result_free(&result);
+}
+
+//afficher la grille comme print_grid_region(), sans couleurs ni chaînes
+static void stream_render(const Level* level, size_t number) {
+    int n = level->size;
+    printf("niveau %zu : %dx%d\n", number, n, n);
+    for (int x = 0; x < n; x++) {
+        for (int y = 0; y < n; y++) {
+            int value = level_value(level, x, y);
+            if (value == -1) {
+                fputs("   ", stdout);
+            } else if (value == 0) {
+                fputs(" x ", stdout);
+            } else {
+                printf(" %d ", value);
+            }
+        }
+        putchar('\n');
+    }
+}
+
+//traiter un niveau selon le mode : une ligne d'en-tête puis le détail, séparés par une ligne vide
+static bool stream_level(StreamMode mode, const Level* level, size_t number) {
+    char error[160];
+    switch (mode) {
+        case STREAM_TEXT:
+            return level_write(stdout, level);
+        case STREAM_BINARY:
+            return level_write_binary(stdout, level);
+        case STREAM_RENDER:
+            stream_render(level, number);
+            break;
+        case STREAM_VALIDATE:
+        case STREAM_SOLVE:
+            if (!level_validate(level, error, sizeof(error))) {
+                printf("niveau %zu : %dx%d, non valide : %s\n", number, level->size, level->size, error);
+            } else if (mode == STREAM_SOLVE) {
+                stream_solve(level, number);
+            } else {
+                printf("niveau %zu : %dx%d, valide\n", number, level->size, level->size);
+            }
+            break;
+    }
+    putchar('\n');
+    return !ferror(stdout);
+}
+
+//lire les niveaux de stdin jusqu'à la fin du flux et écrire chaque résultat sur stdout
+int run_stream(StreamMode mode) {
+    static char in_buffer[STREAM_BUFFER_SIZE];
+    static char out_buffer[STREAM_BUFFER_SIZE];
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    // de grands tampons : un débit de plusieurs milliers de niveaux par seconde dans un tube
+    setvbuf(stdin, in_buffer, _IOFBF, sizeof(in_buffer));
+    setvbuf(stdout, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    double start = stats_now_ms();
+    size_t count = 0;
+    int status = 0;
+    int c;
+    while ((c = peek_level(stdin)) != EOF) {
+        Level level;
+        char error[160];
+        // un niveau binaire commence par "CCLV", un niveau texte par sa taille
+        bool binary = c == LEVEL_BINARY_MAGIC[0];
+        bool read = binary ? level_read_binary(stdin, &level, error, sizeof(error))
+                           : level_read(stdin, &level, error, sizeof(error));
+        count++;
+        if (!read) {
+            // la fin du niveau est inconnue : impossible de se recaler sur le suivant
+            printf("niveau %zu : illisible (%s)\n", count, error);
+            status = 1;
+            break;
+        }
+        STAT_ADD(STAT_LEVELS_LOADED, 1);
+        bool written = stream_level(mode, &level, count);
+        level_free(&level);
+        if (!written) {
+            status = 1; // lecteur parti (tube fermé) : inutile de continuer
+            break;
+        }
+    }
+    if (fflush(stdout) != 0) {
+        status = 1;
+    }
+    arena_free(&solver_scratch);
+
+    double elapsed = stats_now_ms() - start;
+    fprintf(stderr, "%zu niveau(x) traite(s) en %.1f ms (%.0f niveaux/s)\n", count, elapsed,
+            elapsed > 0 ? count * 1000.0 / elapsed : 0.0);
+    return status;
+}
@@ -0,0 +1,22 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdbool.h>
+
+// Mode flux : lit sur l'entrée standard une suite de niveaux (format texte de level_read(),
+// ou binaire "CCLV", mélangeables) et écrit le résultat de chacun sur la sortie standard,
+// sans fichier temporaire ni processus par niveau. Le résumé part sur stderr pour ne pas
+// se mêler aux résultats.
+
+typedef enum {
+    STREAM_VALIDATE,  // valide ou non, avec la raison
+    STREAM_SOLVE,     // solution (commandes de play_game()) ou absence de solution
+    STREAM_RENDER,    // grille affichée comme dans le jeu, sans couleurs
+    STREAM_TEXT,      // niveau réécrit au format texte
+    STREAM_BINARY     // niveau réécrit au format binaire
+} StreamMode;
+
+bool stream_mode_parse(const char* name, StreamMode* mode);
+int run_stream(StreamMode mode);
+
+#endif
@@ -0,0 +1,591 @@
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "tiles.h"
+#include "rng.h"
+
+#ifdef _WIN32
+#define fseeko _fseeki64
+#endif
+
+// Format binaire d'une grille tuilée :
+//   "CCTL", version, taille N, côté des tuiles T (uint32)
+//   nombre de cases à couvrir de chaque tuile (uint32 x nombre de tuiles)
+//   valeurs des tuiles (int8, T*T par tuile, tuiles rangées ligne par ligne,
+//   cases hors grille à -1)
+#define TILES_MAGIC "CCTL"
+#define TILES_VERSION 1
+#define TILES_HEADER_SIZE 16
+
+typedef struct {
+    int32_t tile_id;   // -1 si l'emplacement est libre
+    int8_t* values;
+    int32_t* chains;
+    bool dirty;        // chaînes modifiées depuis le chargement
+    bool referenced;   // bit de l'algorithme de l'horloge
+} TileSlot;
+
+struct TileStore {
+    FILE* source;
+    FILE* scratch;     // chaînes des tuiles évincées
+    int size;
+    int tile;
+    int shift;         // log2(tile)
+    int per_side;
+    size_t tile_count;
+    long long data_offset;
+
+    uint32_t* required;  // cases à couvrir par tuile
+    uint32_t* occupied;  // cases occupées par une chaîne, par tuile
+    uint8_t* spilled;    // 1 si les chaînes de la tuile sont dans scratch
+    int32_t* slot_of;    // emplacement mémoire de chaque tuile, -1 sinon
+    uint64_t uncovered;  // cases restant à couvrir sur toute la grille
+
+    TileSlot* slots;
+    size_t slot_count;
+    size_t hand;
+    int32_t last_tile;
+    TileSlot* last_slot;
+
+    unsigned long long loads, evictions, spills;
+};
+
+static int tile_shift(int tile) {
+    int shift = 0;
+    while ((1 << shift) < tile) {
+        shift++;
+    }
+    return (1 << shift) == tile ? shift : -1;
+}
+
+//vérifier si un fichier est une grille tuilée binaire
+bool tiles_is_tiled_file(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        return false;
+    }
+    char magic[4];
+    bool tiled = fread(magic, 1, 4, file) == 4 && memcmp(magic, TILES_MAGIC, 4) == 0;
+    fclose(file);
+    return tiled;
+}
+
+//ouvrir une grille tuilée avec un plafond mémoire pour les tuiles chargées
+TileStore* tiles_open(const char* filename, size_t memory_cap) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        printf("Erreur : Impossible d'ouvrir le fichier %s\n", filename);
+        return NULL;
+    }
+    TileStore* ts = tiles_open_file(file, memory_cap);
+    if (!ts) {
+        printf("Erreur : %s n'est pas une grille tuilee valide\n", filename);
+    }
+    return ts;
+}
+
+//ouvrir une grille tuilée depuis un fichier déjà ouvert, qui sera fermé avec elle
+TileStore* tiles_open_file(FILE* file, size_t memory_cap) {
+    char magic[4];
+    uint32_t header[3];
+    if (fseeko(file, 0, SEEK_SET) != 0 ||
+        fread(magic, 1, 4, file) != 4 || memcmp(magic, TILES_MAGIC, 4) != 0 ||
+        fread(header, sizeof(uint32_t), 3, file) != 3 || header[0] != TILES_VERSION) {
+        fclose(file);
+        return NULL;
+    }
+    int shift = tile_shift((int)header[2]);
+    if (header[1] == 0 || header[1] > INT32_MAX / 2 || shift < 0) {
+        fclose(file);
+        return NULL;
+    }
+
+    TileStore* ts = calloc(1, sizeof(TileStore));
+    ts->source = file;
+    ts->size = (int)header[1];
+    ts->tile = (int)header[2];
+    ts->shift = shift;
+    ts->per_side = (ts->size + ts->tile - 1) / ts->tile;
+    ts->tile_count = (size_t)ts->per_side * ts->per_side;
+    ts->data_offset = TILES_HEADER_SIZE + (long long)ts->tile_count * sizeof(uint32_t);
+
+    ts->required = malloc(ts->tile_count * sizeof(uint32_t));
+    ts->occupied = calloc(ts->tile_count, sizeof(uint32_t));
+    ts->spilled = calloc(ts->tile_count, 1);
+    ts->slot_of = malloc(ts->tile_count * sizeof(int32_t));
+    if (fread(ts->required, sizeof(uint32_t), ts->tile_count, file) != ts->tile_count) {
+        tiles_close(ts);
+        return NULL;
+    }
+    for (size_t i = 0; i < ts->tile_count; i++) {
+        ts->slot_of[i] = -1;
+        ts->uncovered += ts->required[i];
+    }
+
+    size_t cells = (size_t)ts->tile * ts->tile;
+    size_t slot_bytes = cells * (sizeof(int8_t) + sizeof(int32_t));
+    ts->slot_count = memory_cap / slot_bytes;
+    if (ts->slot_count < 4) {
+        ts->slot_count = 4;
+    }
+    if (ts->slot_count > ts->tile_count) {
+        ts->slot_count = ts->tile_count;
+    }
+    ts->slots = calloc(ts->slot_count, sizeof(TileSlot));
+    for (size_t i = 0; i < ts->slot_count; i++) {
+        ts->slots[i].tile_id = -1;
+        ts->slots[i].values = malloc(cells * sizeof(int8_t));
+        ts->slots[i].chains = malloc(cells * sizeof(int32_t));
+    }
+    ts->last_tile = -1;
+    return ts;
+}
+
+//fermer une grille tuilée
+void tiles_close(TileStore* ts) {
+    if (!ts) {
+        return;
+    }
+    for (size_t i = 0; i < ts->slot_count; i++) {
+        free(ts->slots[i].values);
+        free(ts->slots[i].chains);
+    }
+    free(ts->slots);
+    free(ts->required);
+    free(ts->occupied);
+    free(ts->spilled);
+    free(ts->slot_of);
+    if (ts->scratch) {
+        fclose(ts->scratch);
+    }
+    fclose(ts->source);
+    free(ts);
+}
+
+int tiles_size(const TileStore* ts) {
+    return ts->size;
+}
+
+//sauvegarder les chaînes d'une tuile avant de libérer son emplacement
+static void tile_evict(TileStore* ts, TileSlot* slot) {
+    int32_t id = slot->tile_id;
+    size_t cells = (size_t)ts->tile * ts->tile;
+    if (slot->dirty) {
+        if (ts->occupied[id] == 0) {
+            ts->spilled[id] = 0; // plus aucune chaîne : inutile d'écrire des zéros
+        } else {
+            if (!ts->scratch) {
+                ts->scratch = tmpfile();
+            }
+            if (!ts->scratch ||
+                fseeko(ts->scratch, (long long)id * cells * sizeof(int32_t), SEEK_SET) != 0 ||
+                fwrite(slot->chains, sizeof(int32_t), cells, ts->scratch) != cells) {
+                printf("Erreur : impossible de sauvegarder la tuile %d\n", id);
+            } else {
+                ts->spilled[id] = 1;
+                ts->spills++;
+            }
+        }
+    }
+    ts->slot_of[id] = -1;
+    if (ts->last_tile == id) {
+        ts->last_tile = -1;
+    }
+    slot->tile_id = -1;
+    ts->evictions++;
+}
+
+//choisir un emplacement libre (algorithme de l'horloge)
+static TileSlot* tile_victim(TileStore* ts) {
+    for (;;) {
+        TileSlot* slot = &ts->slots[ts->hand];
+        ts->hand = (ts->hand + 1) % ts->slot_count;
+        if (slot->tile_id < 0) {
+            return slot;
+        }
+        if (slot->referenced) {
+            slot->referenced = false;
+        } else {
+            tile_evict(ts, slot);
+            return slot;
+        }
+    }
+}
+
+//charger une tuile depuis le fichier source (et ses chaînes sauvegardées)
+static TileSlot* tile_load(TileStore* ts, int32_t id) {
+    TileSlot* slot = tile_victim(ts);
+    size_t cells = (size_t)ts->tile * ts->tile;
+
+    if (fseeko(ts->source, ts->data_offset + (long long)id * cells, SEEK_SET) != 0 ||
+        fread(slot->values, 1, cells, ts->source) != cells) {
+        printf("Erreur de lecture de la tuile %d\n", id);
+        memset(slot->values, -1, cells);
+    }
+    if (ts->spilled[id] &&
+        fseeko(ts->scratch, (long long)id * cells * sizeof(int32_t), SEEK_SET) == 0 &&
+        fread(slot->chains, sizeof(int32_t), cells, ts->scratch) == cells) {
+        // chaînes restaurées
+    } else {
+        memset(slot->chains, 0, cells * sizeof(int32_t));
+    }
+
+    slot->tile_id = id;
+    slot->dirty = false;
+    ts->slot_of[id] = (int32_t)(slot - ts->slots);
+    ts->loads++;
+    return slot;
+}
+
+static TileSlot* tile_fetch(TileStore* ts, int32_t id) {
+    TileSlot* slot;
+    if (id == ts->last_tile) {
+        slot = ts->last_slot;
+    } else if (ts->slot_of[id] >= 0) {
+        slot = &ts->slots[ts->slot_of[id]];
+    } else {
+        slot = tile_load(ts, id);
+    }
+    slot->referenced = true;
+    ts->last_tile = id;
+    ts->last_slot = slot;
+    return slot;
+}
+
+static int32_t tile_of(const TileStore* ts, int x, int y) {
+    return (x >> ts->shift) * ts->per_side + (y >> ts->shift);
+}
+
+static size_t offset_in_tile(const TileStore* ts, int x, int y) {
+    int mask = ts->tile - 1;
+    return ((size_t)(x & mask) << ts->shift) + (size_t)(y & mask);
+}
+
+int tiles_value(TileStore* ts, int x, int y) {
+    return tile_fetch(ts, tile_of(ts, x, y))->values[offset_in_tile(ts, x, y)];
+}
+
+int tiles_chain(TileStore* ts, int x, int y) {
+    return tile_fetch(ts, tile_of(ts, x, y))->chains[offset_in_tile(ts, x, y)];
+}
+
+//modifier la chaîne d'une case en tenant à jour les compteurs de couverture
+void tiles_set_chain(TileStore* ts, int x, int y, int chain) {
+    int32_t id = tile_of(ts, x, y);
+    TileSlot* slot = tile_fetch(ts, id);
+    size_t i = offset_in_tile(ts, x, y);
+    int old = slot->chains[i];
+    if (old == chain) {
+        return;
+    }
+    if (old == 0) {
+        ts->occupied[id]++;
+        if (slot->values[i] > 0) {
+            ts->uncovered--;
+        }
+    } else if (chain == 0) {
+        ts->occupied[id]--;
+        if (slot->values[i] > 0) {
+            ts->uncovered++;
+        }
+    }
+    slot->chains[i] = chain;
+    slot->dirty = true;
+}
+
+//mêmes règles que level_validate(), tuile par tuile : seules la tuile parcourue et ses
+//voisines sont lues, et le nombre de cases à couvrir de l'en-tête est vérifié au passage
+bool tiles_validate(TileStore* ts, char* error, size_t error_size) {
+    static const int dx[4] = {-1, 1, 0, 0};
+    static const int dy[4] = {0, 0, 1, -1};
+    int n = ts->size;
+    uint64_t starts = 0, required = 0;
+    for (int32_t id = 0; id < (int32_t)ts->tile_count; id++) {
+        int top = (id / ts->per_side) * ts->tile, left = (id % ts->per_side) * ts->tile;
+        uint32_t tile_required = 0;
+        for (int i = top; i < top + ts->tile && i < n; i++) {
+            for (int j = left; j < left + ts->tile && j < n; j++) {
+                int value = tiles_value(ts, i, j);
+                if (value < -1) {
+                    snprintf(error, error_size, "valeur %d invalide en (%d, %d)", value, i, j);
+                    return false;
+                }
+                if (value == 0) {
+                    starts++;
+                } else if (value > 0) {
+                    tile_required++;
+                    bool reachable = false;
+                    for (int d = 0; d < 4 && !reachable; d++) {
+                        int x = i + dx[d], y = j + dy[d];
+                        if (x >= 0 && x < n && y >= 0 && y < n) {
+                            int from = tiles_value(ts, x, y);
+                            reachable = from == 0 || (from > 0 && from <= value);
+                        }
+                    }
+                    if (!reachable) {
+                        snprintf(error, error_size, "la case (%d, %d) ne peut etre atteinte par aucune chaine", i, j);
+                        return false;
+                    }
+                }
+            }
+        }
+        if (tile_required != ts->required[id]) {
+            snprintf(error, error_size, "en-tete incorrect : %u cases a couvrir annoncees pour la tuile %d, %u trouvees",
+                     ts->required[id], id, tile_required);
+            return false;
+        }
+        required += tile_required;
+    }
+    if (required > 0 && starts == 0) {
+        snprintf(error, error_size, "aucune case de depart 'x'");
+        return false;
+    }
+    return true;
+}
+
+//toutes les cases à couvrir le sont-elles ?
+bool tiles_all_covered(const TileStore* ts) {
+    return ts->uncovered == 0;
+}
+
+//nombre de cases à couvrir encore libres
+size_t tiles_uncovered(const TileStore* ts) {
+    return (size_t)ts->uncovered;
+}
+
+//effacer une chaîne en ne parcourant que les tuiles qui contiennent des chaînes
+void tiles_erase_chain(TileStore* ts, int chain_id) {
+    size_t cells = (size_t)ts->tile * ts->tile;
+    for (size_t id = 0; id < ts->tile_count; id++) {
+        if (ts->occupied[id] == 0) {
+            continue;
+        }
+        TileSlot* slot = tile_fetch(ts, (int32_t)id);
+        for (size_t i = 0; i < cells; i++) {
+            if (slot->chains[i] == chain_id && slot->values[i] > 0) {
+                slot->chains[i] = 0;
+                ts->occupied[id]--;
+                ts->uncovered++;
+                slot->dirty = true;
+            }
+        }
+    }
+}
+
+//retirer toutes les chaînes de la grille
+void tiles_reset(TileStore* ts) {
+    size_t cells = (size_t)ts->tile * ts->tile;
+    for (size_t i = 0; i < ts->slot_count; i++) {
+        if (ts->slots[i].tile_id >= 0) {
+            memset(ts->slots[i].chains, 0, cells * sizeof(int32_t));
+            ts->slots[i].dirty = false;
+        }
+    }
+    memset(ts->spilled, 0, ts->tile_count);
+    memset(ts->occupied, 0, ts->tile_count * sizeof(uint32_t));
+    ts->uncovered = 0;
+    for (size_t id = 0; id < ts->tile_count; id++) {
+        ts->uncovered += ts->required[id];
+    }
+}
+
+//afficher l'état du cache de tuiles
+void tiles_print_stats(const TileStore* ts) {
+    size_t resident = 0;
+    for (size_t i = 0; i < ts->slot_count; i++) {
+        if (ts->slots[i].tile_id >= 0) {
+            resident++;
+        }
+    }
+    printf("Tuiles : %zu en memoire sur %zu (max %zu), %llu chargements, %llu evictions, %llu sauvegardes\n",
+           resident, ts->tile_count, ts->slot_count, ts->loads, ts->evictions, ts->spills);
+}
+
+// Écriture d'une grille tuilée : les lignes arrivent par bandes de T lignes,
+// chaque bande produit une rangée complète de tuiles.
+typedef struct {
+    FILE* file;
+    int size;
+    int tile;
+    int per_side;
+    uint32_t* required;
+    size_t next_tile;
+    int8_t* buffer;
+} TileWriter;
+
+static bool tile_writer_begin(TileWriter* w, FILE* file, int size, int tile) {
+    if (size <= 0 || tile_shift(tile) < 0) {
+        printf("Erreur : taille de grille ou de tuile invalide (%d, %d)\n", size, tile);
+        return false;
+    }
+    w->file = file;
+    w->size = size;
+    w->tile = tile;
+    w->per_side = (size + tile - 1) / tile;
+    w->required = calloc((size_t)w->per_side * w->per_side, sizeof(uint32_t));
+    w->next_tile = 0;
+    w->buffer = malloc((size_t)tile * tile);
+
+    uint32_t header[3] = {TILES_VERSION, (uint32_t)size, (uint32_t)tile};
+    fwrite(TILES_MAGIC, 1, 4, w->file);
+    fwrite(header, sizeof(uint32_t), 3, w->file);
+    // table des cases à couvrir, complétée à la fin
+    fwrite(w->required, sizeof(uint32_t), (size_t)w->per_side * w->per_side, w->file);
+    return true;
+}
+
+//écrire une bande de `rows` lignes (rows <= tile) de largeur size
+static void tile_writer_band(TileWriter* w, const int8_t* band, int rows) {
+    for (int t = 0; t < w->per_side; t++) {
+        uint32_t required = 0;
+        for (int r = 0; r < w->tile; r++) {
+            for (int c = 0; c < w->tile; c++) {
+                int col = t * w->tile + c;
+                int8_t v = (r < rows && col < w->size) ? band[(size_t)r * w->size + col] : -1;
+                w->buffer[r * w->tile + c] = v;
+                if (v > 0) {
+                    required++;
+                }
+            }
+        }
+        w->required[w->next_tile++] = required;
+        fwrite(w->buffer, 1, (size_t)w->tile * w->tile, w->file);
+    }
+}
+
+static bool tile_writer_end(TileWriter* w) {
+    bool ok = fseeko(w->file, TILES_HEADER_SIZE, SEEK_SET) == 0 &&
+              fwrite(w->required, sizeof(uint32_t), (size_t)w->per_side * w->per_side, w->file) ==
+                  (size_t)w->per_side * w->per_side;
+    ok = fflush(w->file) == 0 && ok;
+    free(w->required);
+    free(w->buffer);
+    if (!ok) {
+        printf("Erreur d'ecriture de la grille tuilee\n");
+    }
+    return ok;
+}
+
+//convertir une grille texte en grille tuilée binaire
+bool tiles_pack_text(const char* text_file, const char* out_file, int tile) {
+    FILE* in = fopen(text_file, "r");
+    if (!in) {
+        printf("Erreur : Impossible d'ouvrir le fichier %s\n", text_file);
+        return false;
+    }
+    int size;
+    if (fscanf(in, "%d", &size) != 1) {
+        printf("Erreur : taille de grille illisible dans %s\n", text_file);
+        fclose(in);
+        return false;
+    }
+    FILE* out = fopen(out_file, "wb");
+    if (!out) {
+        printf("Erreur : Impossible de creer le fichier %s\n", out_file);
+        fclose(in);
+        return false;
+    }
+    TileWriter w;
+    if (!tile_writer_begin(&w, out, size, tile)) {
+        fclose(out);
+        fclose(in);
+        return false;
+    }
+
+    int8_t* band = malloc((size_t)tile * size);
+    bool ok = true;
+    for (int row = 0; row < size && ok; row += tile) {
+        int rows = size - row < tile ? size - row : tile;
+        for (int r = 0; r < rows && ok; r++) {
+            for (int j = 0; j < size; j++) {
+                int v;
+                if (fscanf(in, "%d", &v) != 1 || v < -1 || v > INT8_MAX) {
+                    printf("Erreur de lecture à la position (%d, %d)\n", row + r, j);
+                    ok = false;
+                    break;
+                }
+                band[(size_t)r * size + j] = (int8_t)v;
+            }
+        }
+        if (ok) {
+            tile_writer_band(&w, band, rows);
+        }
+    }
+    free(band);
+    fclose(in);
+    ok = tile_writer_end(&w) && ok;
+    return fclose(out) == 0 && ok;
+}
+
+//écrire un niveau en mémoire au format tuilé dans un fichier ouvert
+bool tiles_write_level(FILE* out, const Level* level, int tile) {
+    TileWriter w;
+    for (int v = 0; v < level->size * level->size; v++) {
+        if (level->values[v] < -1 || level->values[v] > INT8_MAX) {
+            printf("Erreur : valeur %d hors limites pour une grille tuilee\n", level->values[v]);
+            return false;
+        }
+    }
+    if (!tile_writer_begin(&w, out, level->size, tile)) {
+        return false;
+    }
+    int8_t* band = malloc((size_t)tile * level->size);
+    for (int row = 0; row < level->size; row += tile) {
+        int rows = level->size - row < tile ? level->size - row : tile;
+        for (int r = 0; r < rows; r++) {
+            for (int j = 0; j < level->size; j++) {
+                band[(size_t)r * level->size + j] = (int8_t)level_value(level, row + r, j);
+            }
+        }
+        tile_writer_band(&w, band, rows);
+    }
+    free(band);
+    return tile_writer_end(&w);
+}
+
+//générer une grille tuilée de test : chaque ligne est une suite de chaînes
+//croissantes vers l'est, séparées par des cases vides
+bool tiles_generate(const char* out_file, int size, unsigned seed, int tile) {
+    FILE* out = fopen(out_file, "wb");
+    if (!out) {
+        printf("Erreur : Impossible de creer le fichier %s\n", out_file);
+        return false;
+    }
+    TileWriter w;
+    if (!tile_writer_begin(&w, out, size, tile)) {
+        fclose(out);
+        return false;
+    }
+    int8_t* band = malloc((size_t)tile * size);
+    for (int row = 0; row < size; row += tile) {
+        int rows = size - row < tile ? size - row : tile;
+        for (int r = 0; r < rows; r++) {
+            uint32_t state = (seed ^ (uint32_t)(row + r) * 2654435761u) | 1u;
+            bool restart = true;
+            int8_t value = 1;
+            int8_t* line = band + (size_t)r * size;
+            for (int j = 0; j < size; j++) {
+                uint32_t dice = rng_next(&state) % 100;
+                if (restart) {
+                    line[j] = 0;
+                    value = 1;
+                    restart = false;
+                } else if (dice < 3 && j < size - 1) {
+                    line[j] = -1;
+                    restart = true;
+                } else {
+                    line[j] = value;
+                    if (dice < 25 && value < 9) {
+                        value++;
+                    }
+                }
+            }
+        }
+        tile_writer_band(&w, band, rows);
+    }
+    free(band);
+    bool ok = tile_writer_end(&w);
+    return fclose(out) == 0 && ok;
+}
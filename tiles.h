@@ -0,0 +1,40 @@
+#ifndef TILES_H
+#define TILES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "level.h"
+
+// Grille découpée en tuiles carrées chargées à la demande depuis un fichier binaire.
+// Seules les tuiles récemment utilisées restent en mémoire ; les autres sont évincées
+// (les chaînes modifiées sont recopiées dans un fichier temporaire) pour respecter
+// le plafond mémoire donné à l'ouverture.
+
+#define TILE_DEFAULT_SIZE 64
+#define TILE_DEFAULT_MEMORY (64u * 1024u * 1024u)
+
+typedef struct TileStore TileStore;
+
+bool tiles_is_tiled_file(const char* filename);
+TileStore* tiles_open(const char* filename, size_t memory_cap);
+TileStore* tiles_open_file(FILE* file, size_t memory_cap);
+void tiles_close(TileStore* ts);
+
+int tiles_size(const TileStore* ts);
+int tiles_value(TileStore* ts, int x, int y);
+int tiles_chain(TileStore* ts, int x, int y);
+void tiles_set_chain(TileStore* ts, int x, int y, int chain);
+
+bool tiles_validate(TileStore* ts, char* error, size_t error_size);
+bool tiles_all_covered(const TileStore* ts);
+size_t tiles_uncovered(const TileStore* ts);
+void tiles_erase_chain(TileStore* ts, int chain_id);
+void tiles_reset(TileStore* ts);
+void tiles_print_stats(const TileStore* ts);
+
+bool tiles_pack_text(const char* text_file, const char* out_file, int tile);
+bool tiles_write_level(FILE* out, const Level* level, int tile);
+bool tiles_generate(const char* out_file, int size, unsigned seed, int tile);
+
+#endif
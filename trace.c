@@ -0,0 +1,189 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "trace.h"
+
+#ifdef CC_TRACE
+
+// Intervalle terminé
+typedef struct {
+    uint64_t start_ns;
+    uint64_t end_ns;
+    int64_t arg;             // -1 : aucun
+    uint32_t span;
+} TraceEvent;
+
+// Anneau d'un thread : seul son thread y écrit ; head n'est publié qu'une fois l'intervalle
+// rangé, et un anneau survit à son thread pour être écrit à la fin
+typedef struct TraceRing {
+    _Atomic uint64_t head;   // intervalles rangés depuis le début (le suivant va en head % TRACE_RING_EVENTS)
+    int tid;
+    char name[32];
+    struct TraceRing* next;
+    TraceEvent events[TRACE_RING_EVENTS];
+} TraceRing;
+
+static const struct {
+    const char* name;
+    const char* category;
+    const char* arg;         // nom de l'argument, NULL si aucun
+} span_info[TRACE_COUNT] = {
+    [TRACE_LEVEL_LOAD] = {"chargement niveau", "jeu", NULL},
+    [TRACE_RENDER] = {"affichage", "jeu", NULL},
+    [TRACE_INPUT_WAIT] = {"attente saisie", "jeu", NULL},
+    [TRACE_MOVE_CHECK] = {"mouvement", "jeu", "refus"},
+    [TRACE_VICTORY_CHECK] = {"victoire", "jeu", "gagne"},
+    [TRACE_SNAPSHOT] = {"sauvegarde", "jeu", NULL},
+    [TRACE_SOLVE] = {"resolution", "solveur", "noeuds"},
+    [TRACE_SOLVE_SETUP] = {"preparation", "solveur", NULL},
+    [TRACE_SOLVE_SEARCH] = {"recherche", "solveur", "noeuds"},
+    [TRACE_SOLVE_CHECKPOINT] = {"point de reprise", "solveur", NULL},
+    [TRACE_SAT_ENCODE] = {"codage CNF", "solveur", NULL},
+    [TRACE_SAT_SOLVE] = {"CDCL", "solveur", "decisions"},
+};
+
+bool trace_enabled = false;
+static FILE* trace_file = NULL;
+static const char* trace_filename = NULL;
+static uint64_t trace_origin_ns;  // instant zéro du fichier
+
+static _Thread_local TraceRing* local_ring = NULL;
+static TraceRing* all_rings = NULL;
+static int ring_count = 0;
+static pthread_mutex_t rings_lock = PTHREAD_MUTEX_INITIALIZER;
+
+//créer l'anneau du thread courant (une seule fois par thread, seul moment verrouillé)
+static TraceRing* trace_register(void) {
+    TraceRing* ring = calloc(1, sizeof(TraceRing));
+    if (!ring) {
+        return NULL;
+    }
+    pthread_mutex_lock(&rings_lock);
+    ring->tid = ++ring_count;
+    ring->next = all_rings;
+    all_rings = ring;
+    pthread_mutex_unlock(&rings_lock);
+    snprintf(ring->name, sizeof(ring->name), "thread %d", ring->tid);
+    local_ring = ring;
+    return ring;
+}
+
+//ranger un intervalle commencé à start_ns et terminé maintenant
+void trace_record(TraceSpan span, uint64_t start_ns, int64_t arg) {
+    TraceRing* ring = local_ring ? local_ring : trace_register();
+    if (!ring) {
+        return;
+    }
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    TraceEvent* event = &ring->events[head & (TRACE_RING_EVENTS - 1)];
+    event->start_ns = start_ns;
+    event->end_ns = stats_now_ns();
+    event->arg = arg;
+    event->span = (uint32_t)span;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+//nommer le thread courant dans la trace
+void trace_thread_name(const char* name) {
+    if (!trace_enabled) {
+        return;
+    }
+    TraceRing* ring = local_ring ? local_ring : trace_register();
+    if (ring) {
+        snprintf(ring->name, sizeof(ring->name), "%s", name);
+    }
+}
+
+//écrire un anneau : copie des intervalles publiés, puis abandon de ceux que le thread a pu
+//remplacer pendant la copie (il peut encore tourner à la sortie du programme)
+static uint64_t write_ring(FILE* out, TraceRing* ring, TraceEvent* copy) {
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint64_t begin = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+    for (uint64_t i = begin; i < head; i++) {
+        copy[i - begin] = ring->events[i & (TRACE_RING_EVENTS - 1)];
+    }
+    uint64_t now = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint64_t safe = now >= TRACE_RING_EVENTS ? now - TRACE_RING_EVENTS + 1 : 0;
+
+    fprintf(out, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+            ring->tid, ring->name);
+    uint64_t written = 0;
+    for (uint64_t i = begin > safe ? begin : safe; i < head; i++) {
+        const TraceEvent* e = &copy[i - begin];
+        if (e->span >= TRACE_COUNT || e->start_ns < trace_origin_ns) {
+            continue;
+        }
+        fprintf(out, ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                     "\"ts\": %.3f, \"dur\": %.3f",
+                span_info[e->span].name, span_info[e->span].category, ring->tid,
+                (e->start_ns - trace_origin_ns) / 1e3, (e->end_ns - e->start_ns) / 1e3);
+        if (span_info[e->span].arg && e->arg >= 0) {
+            fprintf(out, ", \"args\": {\"%s\": %lld}", span_info[e->span].arg, (long long)e->arg);
+        }
+        fprintf(out, "}");
+        written++;
+    }
+    return written;
+}
+
+static void trace_write_at_exit(void) {
+    TraceEvent* copy = malloc(TRACE_RING_EVENTS * sizeof(TraceEvent));
+    if (!copy) {
+        fclose(trace_file);
+        return;
+    }
+    uint64_t written = 0, dropped = 0;
+    fprintf(trace_file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+    fprintf(trace_file, "\n{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"CardinalChain\"}}");
+    pthread_mutex_lock(&rings_lock);
+    for (TraceRing* ring = all_rings; ring; ring = ring->next) {
+        uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        written += write_ring(trace_file, ring, copy);
+        dropped += head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+    }
+    pthread_mutex_unlock(&rings_lock);
+    fprintf(trace_file, "\n]}\n");
+    bool ok = fclose(trace_file) == 0;
+    free(copy);
+    if (!ok) {
+        fprintf(stderr, "Erreur : trace incomplete dans %s\n", trace_filename);
+    } else if (dropped) {
+        fprintf(stderr, "Trace : %llu intervalles dans %s (%llu plus anciens remplaces)\n",
+                (unsigned long long)written, trace_filename, (unsigned long long)dropped);
+    } else {
+        fprintf(stderr, "Trace : %llu intervalles dans %s\n", (unsigned long long)written, trace_filename);
+    }
+}
+
+//activer les traces ; le fichier est ouvert tout de suite et écrit à la fin du programme
+bool trace_open(const char* filename) {
+    if (trace_file) {
+        return true;
+    }
+    trace_file = fopen(filename, "w");
+    if (!trace_file) {
+        printf("Erreur : impossible d'ecrire la trace %s\n", filename);
+        return false;
+    }
+    trace_filename = filename;
+    trace_origin_ns = stats_now_ns();
+    trace_enabled = true;
+    trace_thread_name("principal");
+    atexit(trace_write_at_exit);
+    return true;
+}
+
+#else
+
+bool trace_open(const char* filename) {
+    (void)filename;
+    fprintf(stderr, "Traces desactivees a la compilation (option CMake ENABLE_TRACE)\n");
+    return true;
+}
+
+void trace_thread_name(const char* name) {
+    (void)name;
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "stats.h"
+
+// Traces d'activité (--trace FICHIER) : chaque thread range ses intervalles datés dans son
+// propre anneau, sans verrou ; à la fin du programme, ils sont écrits au format JSON
+// "trace events" de Chrome, lisible dans Perfetto (ui.perfetto.dev) ou chrome://tracing.
+// Un anneau plein remplace ses intervalles les plus anciens.
+// Sans CC_TRACE (option CMake ENABLE_TRACE=OFF), les macros ne génèrent aucun code.
+
+#define TRACE_RING_EVENTS 65536 // intervalles gardés par thread (puissance de 2)
+
+typedef enum {
+    TRACE_LEVEL_LOAD,
+    TRACE_RENDER,
+    TRACE_INPUT_WAIT,
+    TRACE_MOVE_CHECK,        // argument : MoveCheck
+    TRACE_VICTORY_CHECK,     // argument : 1 si gagné
+    TRACE_SNAPSHOT,
+    TRACE_SOLVE,             // résolution complète, argument : noeuds
+    TRACE_SOLVE_SETUP,       // tableaux de la recherche générale
+    TRACE_SOLVE_SEARCH,      // parcours de l'arbre, argument : noeuds
+    TRACE_SOLVE_CHECKPOINT,  // écriture ou lecture d'un point de reprise
+    TRACE_SAT_ENCODE,        // codage CNF et clauses du solveur SAT
+    TRACE_SAT_SOLVE,         // recherche CDCL, argument : décisions
+    TRACE_COUNT
+} TraceSpan;
+
+bool trace_open(const char* filename);
+void trace_thread_name(const char* name);
+
+#ifdef CC_TRACE
+
+extern bool trace_enabled;
+void trace_record(TraceSpan span, uint64_t start_ns, int64_t arg);
+
+#define TRACE_START(var) uint64_t var = trace_enabled ? stats_now_ns() : 0
+#define TRACE_END(var, span) TRACE_END_ARG(var, span, -1)
+#define TRACE_END_ARG(var, span, arg)                          \
+    do {                                                       \
+        if (trace_enabled) {                                   \
+            trace_record((span), (var), (int64_t)(arg));       \
+        }                                                      \
+    } while (0)
+
+#else
+
+#define TRACE_START(var) ((void)0)
+#define TRACE_END(var, span) ((void)0)
+#define TRACE_END_ARG(var, span, arg) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+#include <stdlib.h>
+#include "varint.h"
+
+//agrandir un tampon pour qu'il puisse recevoir extra octets de plus
+bool byte_buffer_reserve(ByteBuffer* b, size_t extra) {
+    if (b->size + extra <= b->capacity) {
+        return true;
+    }
+    size_t capacity = b->capacity ? b->capacity : 256;
+    while (capacity < b->size + extra) {
+        capacity *= 2;
+    }
+    unsigned char* bytes = realloc(b->bytes, capacity);
+    if (!bytes) {
+        return false;
+    }
+    b->bytes = bytes;
+    b->capacity = capacity;
+    return true;
+}
+
+//écrire un entier variable
+bool varint_put(ByteBuffer* b, uint64_t v) {
+    if (!byte_buffer_reserve(b, 10)) {
+        return false;
+    }
+    while (v >= 0x80) {
+        b->bytes[b->size++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    b->bytes[b->size++] = (unsigned char)v;
+    return true;
+}
+
+bool varint_put_signed(ByteBuffer* b, int64_t v) {
+    return varint_put(b, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+uint64_t varint_read(const unsigned char** p) {
+    uint64_t v = 0;
+    int shift = 0;
+    while (**p & 0x80) {
+        v |= (uint64_t)(*(*p)++ & 0x7F) << shift;
+        shift += 7;
+    }
+    return v | (uint64_t)(*(*p)++) << shift;
+}
+
+int64_t varint_read_signed(const unsigned char** p) {
+    return varint_unzigzag(varint_read(p));
+}
+
+bool varint_read_checked(const unsigned char** p, const unsigned char* end, uint64_t* v) {
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*p == end) {
+            break;
+        }
+        unsigned char byte = *(*p)++;
+        *v |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    *v = 0;
+    return false;
+}
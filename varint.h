@@ -0,0 +1,34 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Entiers variables de l'historique et du protocole binaire : 7 bits par octet, poids faible
+// d'abord, bit de poids fort à 1 si un octet suit ; les entiers signés passent en zigzag
+// pour que les petites valeurs négatives restent courtes.
+
+// Tampon d'octets extensible
+typedef struct {
+    unsigned char* bytes;
+    size_t size;
+    size_t capacity;
+} ByteBuffer;
+
+bool byte_buffer_reserve(ByteBuffer* b, size_t extra);
+bool varint_put(ByteBuffer* b, uint64_t v);
+bool varint_put_signed(ByteBuffer* b, int64_t v);
+
+// Lecture d'octets écrits par le programme lui-même (aucune vérification)
+uint64_t varint_read(const unsigned char** p);
+int64_t varint_read_signed(const unsigned char** p);
+
+// Lecture d'octets non fiables : false si l'entier dépasse end ou 64 bits
+bool varint_read_checked(const unsigned char** p, const unsigned char* end, uint64_t* v);
+
+static inline int64_t varint_unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+#endif
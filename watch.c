@@ -0,0 +1,302 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "watch.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "level.h"
+#include "solver.h"
+#include "stats.h"
+
+#define WATCH_MAX_NODES 1000000ULL // au-delà, l'analyse est abandonnée : la surveillance continue
+#define WATCH_BATCH 64             // fichiers distincts par lot d'événements, rescan complet au-delà
+
+// Résultat de l'analyse d'un fichier de niveau
+typedef struct {
+    bool loaded;
+    bool valid;
+    char error[160];
+    int size;
+    SolveStatus status;
+    int solutions;
+    unsigned long long nodes;
+} LevelReport;
+
+typedef struct {
+    char name[256];
+    uint64_t hash;        // empreinte du contenu : un fichier réenregistré à l'identique n'est pas réanalysé
+    bool present;
+    LevelReport report;
+} IndexEntry;
+
+static IndexEntry* entries = NULL;
+static size_t entry_count = 0;
+static Arena solver_scratch; // mémoire de travail du solveur, gardée d'une analyse à l'autre
+
+static bool is_level_file(const char* name) {
+    size_t len = strlen(name);
+    return name[0] != '.' && len > 4 && strcmp(name + len - 4, ".txt") == 0;
+}
+
+//empreinte FNV-1a du contenu d'un fichier ouvert
+static uint64_t file_hash(FILE* file) {
+    uint64_t hash = 1469598103934665603ull;
+    unsigned char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            hash = (hash ^ buffer[i]) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+static IndexEntry* find_entry(const char* name) {
+    for (size_t i = 0; i < entry_count; i++) {
+        if (strcmp(entries[i].name, name) == 0) {
+            return &entries[i];
+        }
+    }
+    entries = realloc(entries, (entry_count + 1) * sizeof(IndexEntry));
+    IndexEntry* entry = &entries[entry_count++];
+    memset(entry, 0, sizeof(*entry));
+    snprintf(entry->name, sizeof(entry->name), "%s", name);
+    return entry;
+}
+
+//lire, valider et résoudre un niveau (recherche de deux solutions pour signaler l'unicité)
+static void analyze_level(FILE* file, LevelReport* report) {
+    Level level;
+    memset(report, 0, sizeof(*report));
+    report->loaded = level_read(file, &level, report->error, sizeof(report->error));
+    if (!report->loaded) {
+        return;
+    }
+    report->size = level.size;
+    report->valid = level_validate(&level, report->error, sizeof(report->error));
+    if (report->valid) {
+        SolveOptions options;
+        SolveResult result = {0};
+        solve_options_default(&options);
+        options.max_solutions = 2;
+        options.max_nodes = WATCH_MAX_NODES;
+        options.scratch = &solver_scratch;
+        report->status = solve_level(&level, &options, &result);
+        report->solutions = result.solutions;
+        report->nodes = result.nodes;
+        solve_result_free(&result);
+    }
+    level_free(&level);
+}
+
+static void print_report(const IndexEntry* entry, double elapsed_ms) {
+    const LevelReport* r = &entry->report;
+    if (elapsed_ms >= 0) {
+        printf("[%7.2f ms] ", elapsed_ms);
+    }
+    printf("%s : ", entry->name);
+    if (!entry->present) {
+        printf("supprime\n");
+    } else if (!r->loaded) {
+        printf("illisible (%s)\n", r->error);
+    } else if (!r->valid) {
+        printf("%dx%d, non valide : %s\n", r->size, r->size, r->error);
+    } else if (r->status == SOLVE_CANCELLED) {
+        printf("%dx%d, %s (abandon apres %llu noeuds)\n", r->size, r->size,
+               r->solutions > 0 ? "soluble, unicite non verifiee" : "indetermine", r->nodes);
+    } else if (r->status == SOLVE_FOUND) {
+        printf("%dx%d, soluble, solution %s (%llu noeuds)\n", r->size, r->size,
+               r->solutions > 1 ? "multiple" : "unique", r->nodes);
+    } else {
+        printf("%dx%d, aucune solution (%llu noeuds)\n", r->size, r->size, r->nodes);
+    }
+}
+
+//réanalyser un fichier du répertoire si son contenu a changé ; verbose : afficher le résultat,
+//report_unchanged : signaler aussi un fichier inchangé
+static void refresh_entry(const char* directory, const char* name, bool verbose, bool report_unchanged) {
+    double start = stats_now_ms();
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", directory, name);
+    IndexEntry* entry = find_entry(name);
+
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        if (entry->present) {
+            entry->present = false;
+            entry->hash = 0;
+            print_report(entry, stats_now_ms() - start);
+        }
+        return;
+    }
+    uint64_t hash = file_hash(file);
+    if (entry->present && hash == entry->hash) {
+        fclose(file);
+        if (verbose && report_unchanged) {
+            printf("[%7.2f ms] %s : inchange\n", stats_now_ms() - start, name);
+        }
+        return;
+    }
+    rewind(file);
+    LevelReport report;
+    analyze_level(file, &report);
+    fclose(file);
+
+    // remplacement de l'entrée de l'index : les autres niveaux ne sont pas touchés
+    entry->report = report;
+    entry->hash = hash;
+    entry->present = true;
+    if (verbose) {
+        print_report(entry, stats_now_ms() - start);
+    }
+}
+
+//comparer deux noms de fichiers en tenant compte des nombres (level2 avant level10)
+static int natural_compare(const void* a, const void* b) {
+    const char* s = ((const IndexEntry*)a)->name;
+    const char* t = ((const IndexEntry*)b)->name;
+    while (*s && *t) {
+        if (*s >= '0' && *s <= '9' && *t >= '0' && *t <= '9') {
+            long u = strtol(s, (char**)&s, 10);
+            long v = strtol(t, (char**)&t, 10);
+            if (u != v) {
+                return u < v ? -1 : 1;
+            }
+        } else if (*s != *t) {
+            return (unsigned char)*s - (unsigned char)*t;
+        } else {
+            s++;
+            t++;
+        }
+    }
+    return (unsigned char)*s - (unsigned char)*t;
+}
+
+//relire tout le répertoire : fichiers nouveaux ou modifiés, et fichiers de l'index disparus
+static void rescan_directory(const char* directory) {
+    DIR* dir = opendir(directory);
+    if (dir) {
+        struct dirent* item;
+        while ((item = readdir(dir)) != NULL) {
+            if (is_level_file(item->d_name)) {
+                refresh_entry(directory, item->d_name, true, false);
+            }
+        }
+        closedir(dir);
+    }
+    for (size_t i = 0; i < entry_count; i++) {
+        if (entries[i].present) {
+            char name[sizeof(entries[i].name)];
+            memcpy(name, entries[i].name, sizeof(name)); // find_entry() peut déplacer l'index
+            refresh_entry(directory, name, true, false);
+        }
+    }
+}
+
+//surveiller un répertoire de niveaux jusqu'à ce que l'utilisateur entre 'q'
+int watch_levels(const char* directory) {
+    DIR* dir = opendir(directory);
+    if (!dir) {
+        printf("Erreur : Impossible d'ouvrir le repertoire %s\n", directory);
+        return 1;
+    }
+    double start = stats_now_ms();
+    struct dirent* item;
+    while ((item = readdir(dir)) != NULL) {
+        if (is_level_file(item->d_name)) {
+            refresh_entry(directory, item->d_name, false, false);
+        }
+    }
+    closedir(dir);
+    qsort(entries, entry_count, sizeof(IndexEntry), natural_compare);
+    for (size_t i = 0; i < entry_count; i++) {
+        print_report(&entries[i], -1);
+    }
+    printf("%zu niveaux analyses en %.2f ms.\n", entry_count, stats_now_ms() - start);
+
+    int fd = inotify_init1(IN_CLOEXEC);
+    if (fd < 0 || inotify_add_watch(fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0) {
+        printf("Erreur : impossible de surveiller %s\n", directory);
+        if (fd >= 0) {
+            close(fd);
+        }
+        free(entries);
+        arena_free(&solver_scratch);
+        return 1;
+    }
+    printf("Surveillance de %s. Entrez q pour quitter.\n", directory);
+    fflush(stdout);
+
+    struct pollfd fds[2] = {{.fd = fd, .events = POLLIN}, {.fd = STDIN_FILENO, .events = POLLIN}};
+    char buffer[16384] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool running = true;
+    while (running) {
+        if (poll(fds, 2, -1) < 0) {
+            continue;
+        }
+        if (fds[1].revents & (POLLIN | POLLHUP)) {
+            char line[64];
+            if (!fgets(line, sizeof(line), stdin)) {
+                fds[1].fd = -1; // entrée fermée : on continue à surveiller
+            } else if (line[0] == 'q' || line[0] == 'Q') {
+                running = false;
+            }
+        }
+        if (!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        // regrouper les événements d'un même lot : un fichier n'est relu qu'une fois
+        ssize_t len = read(fd, buffer, sizeof(buffer));
+        char pending[WATCH_BATCH][256];
+        int pending_count = 0;
+        bool overflow = false;
+        for (ssize_t offset = 0; offset < len;) {
+            const struct inotify_event* event = (const struct inotify_event*)(buffer + offset);
+            offset += sizeof(struct inotify_event) + event->len;
+            if (event->len == 0 || !is_level_file(event->name)) {
+                continue;
+            }
+            bool seen = false;
+            for (int i = 0; i < pending_count && !seen; i++) {
+                seen = strcmp(pending[i], event->name) == 0;
+            }
+            if (!seen && pending_count < WATCH_BATCH) {
+                snprintf(pending[pending_count++], sizeof(pending[0]), "%s", event->name);
+            } else if (!seen) {
+                overflow = true;
+            }
+        }
+        if (overflow) {
+            // trop de fichiers d'un coup (git checkout...) : tout le répertoire est relu
+            printf("Nombreuses modifications : relecture du repertoire.\n");
+            rescan_directory(directory);
+        } else {
+            for (int i = 0; i < pending_count; i++) {
+                refresh_entry(directory, pending[i], true, true);
+            }
+        }
+        fflush(stdout);
+    }
+
+    close(fd);
+    free(entries);
+    arena_free(&solver_scratch);
+    entries = NULL;
+    entry_count = 0;
+    return 0;
+}
+
+#else
+
+int watch_levels(const char* directory) {
+    printf("Erreur : la surveillance de %s necessite inotify (Linux)\n", directory);
+    return 1;
+}
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include <stdbool.h>
+
+// Mode surveillance : garde un index des niveaux d'un répertoire et, à chaque
+// enregistrement d'un fichier, le relit, le revalide et le résout à nouveau.
+int watch_levels(const char* directory);
+
+#endif
@@ -0,0 +1,672 @@
+#include <stdlib.h>
+#include <string.h>
+#include "wire.h"
+#include "board.h"
+#include "level.h"
+#include "session.h"
+#include "spectate.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#define read _read
+#else
+#include <unistd.h>
+#endif
+
+#define WIRE_MAX_COMMAND 64          // une commande tient largement en 64 octets
+#define WIRE_READ_CHUNK (1 << 16)
+
+// ---------------------------------------------------------------------------
+// Écriture
+// ---------------------------------------------------------------------------
+
+static bool put_byte(WireBuffer* b, unsigned char v) {
+    if (!byte_buffer_reserve(b, 1)) {
+        return false;
+    }
+    b->bytes[b->size++] = v;
+    return true;
+}
+
+static bool put_u64(WireBuffer* b, uint64_t v) {
+    if (!byte_buffer_reserve(b, 8)) {
+        return false;
+    }
+    for (int i = 0; i < 8; i++) {
+        b->bytes[b->size++] = (unsigned char)(v >> (8 * i));
+    }
+    return true;
+}
+
+//ajouter à out un message dont le contenu a été écrit dans payload
+static bool put_message(WireBuffer* out, WireType type, const WireBuffer* payload) {
+    if (!put_byte(out, (unsigned char)type) || !varint_put(out, payload->size) ||
+        !byte_buffer_reserve(out, payload->size)) {
+        return false;
+    }
+    if (payload->size > 0) {
+        memcpy(out->bytes + out->size, payload->bytes, payload->size);
+    }
+    out->size += payload->size;
+    return true;
+}
+
+//écrire une commande : a et b sont la case (départ, sélection) ou la direction (mouvement)
+bool wire_put_command(WireBuffer* out, WireType type, int a, int b) {
+    unsigned char bytes[32];
+    WireBuffer payload = {bytes, 0, sizeof(bytes)};
+    bool ok = true;
+    if (type == WIRE_START || type == WIRE_SELECT) {
+        ok = varint_put(&payload, (uint64_t)a) && varint_put(&payload, (uint64_t)b);
+    } else if (type == WIRE_MOVE) {
+        ok = put_byte(&payload, (unsigned char)a);
+    }
+    return ok && put_message(out, type, &payload);
+}
+
+void wire_buffer_free(WireBuffer* buffer) {
+    free(buffer->bytes);
+    buffer->bytes = NULL;
+    buffer->size = buffer->capacity = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Lecture (contenu non fiable : chaque lecture vérifie la fin du message)
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    const unsigned char* p;
+    const unsigned char* end;
+    bool ok;
+} WireReader;
+
+static uint64_t get_varint(WireReader* r) {
+    uint64_t v;
+    if (!varint_read_checked(&r->p, r->end, &v)) {
+        r->ok = false;
+    }
+    return v;
+}
+
+static int64_t get_signed(WireReader* r) {
+    return varint_unzigzag(get_varint(r));
+}
+
+static unsigned char get_byte(WireReader* r) {
+    if (r->p == r->end) {
+        r->ok = false;
+        return 0;
+    }
+    return *r->p++;
+}
+
+static uint64_t get_u64(WireReader* r) {
+    if (r->end - r->p < 8) {
+        r->ok = false;
+        return 0;
+    }
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v |= (uint64_t)r->p[i] << (8 * i);
+    }
+    r->p += 8;
+    return v;
+}
+
+long wire_message_size(const unsigned char* data, size_t size) {
+    if (size < 2) {
+        return 0;
+    }
+    WireReader r = {data + 1, data + (size < WIRE_HEADER_MAX ? size : WIRE_HEADER_MAX), true};
+    uint64_t length = get_varint(&r);
+    if (!r.ok) {
+        return size < WIRE_HEADER_MAX ? 0 : -1;
+    }
+    if (length > (uint64_t)0x7FFFFFFF) {
+        return -1;
+    }
+    size_t total = (size_t)(r.p - data) + (size_t)length;
+    return total <= size ? (long)total : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Empreinte et grille
+// ---------------------------------------------------------------------------
+
+static uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+//part d'une case dans l'empreinte (une case libre ne compte pas)
+static uint64_t cell_hash(uint32_t cell, int32_t chain) {
+    return chain ? mix(((uint64_t)cell << 32) | (uint32_t)chain) : 0;
+}
+
+uint64_t wire_state_hash(const WireState* state) {
+    return state->grid_hash ^ mix(((uint64_t)state->head << 32) ^ (uint32_t)state->current_chain ^ 0x9E3779B97F4A7C15ull);
+}
+
+static void state_set_chain(WireState* state, uint32_t cell, int32_t chain) {
+    state->grid_hash ^= cell_hash(cell, state->chains[cell]) ^ cell_hash(cell, chain);
+    state->chains[cell] = chain;
+}
+
+static bool state_resize(WireState* state, int size) {
+    size_t cells = (size_t)size * size;
+    if (size != state->size || !state->values) {
+        int32_t* values = realloc(state->values, 2 * (cells ? cells : 1) * sizeof(int32_t));
+        if (!values) {
+            return false;
+        }
+        state->values = values;
+        state->chains = values + cells;
+        state->size = size;
+    }
+    return true;
+}
+
+static void state_rehash(WireState* state) {
+    size_t cells = (size_t)state->size * state->size;
+    state->grid_hash = 0;
+    for (size_t c = 0; c < cells; c++) {
+        state->grid_hash ^= cell_hash((uint32_t)c, state->chains[c]);
+    }
+}
+
+void wire_state_free(WireState* state) {
+    free(state->values);
+    memset(state, 0, sizeof(*state));
+}
+
+//appliquer une réponse du serveur ; false si elle est mal formée, hors séquence
+//ou si l'empreinte ne correspond pas (une image est alors nécessaire)
+bool wire_state_apply(WireState* state, const unsigned char* message, size_t size) {
+    long total = wire_message_size(message, size);
+    if (total <= 0) {
+        return false;
+    }
+    WireReader header = {message + 1, message + total, true};
+    get_varint(&header);
+    WireReader r = {header.p, message + total, true};
+    state->status = get_byte(&r);
+    uint64_t sequence = get_varint(&r);
+
+    if (message[0] == WIRE_ACK) {
+        return r.ok && sequence == state->sequence;
+    }
+    if (message[0] == WIRE_DIFF) {
+        if (!state->values || sequence != state->sequence + 1) {
+            return false;
+        }
+        state->head = (uint32_t)get_varint(&r) - 1;
+        state->current_chain = (int)get_varint(&r);
+        state->victory = get_byte(&r) != 0;
+        uint64_t count = get_varint(&r);
+        uint64_t cells = (uint64_t)state->size * state->size;
+        int64_t cell = 0;
+        for (uint64_t i = 0; r.ok && i < count; i++) {
+            cell += get_signed(&r);
+            int32_t chain = (int32_t)get_varint(&r);
+            if (cell < 0 || (uint64_t)cell >= cells) {
+                return false;
+            }
+            state_set_chain(state, (uint32_t)cell, chain);
+        }
+    } else if (message[0] == WIRE_FULL) {
+        int level_number = (int)get_varint(&r);
+        uint64_t size = get_varint(&r);
+        // deux octets au moins par case : la taille annoncée doit tenir dans le message
+        if (!r.ok || size == 0 || size > 46340 || size * size * 2 > (uint64_t)(r.end - r.p) ||
+            !state_resize(state, (int)size)) {
+            return false;
+        }
+        state->level_number = level_number;
+        state->head = (uint32_t)get_varint(&r) - 1;
+        state->current_chain = (int)get_varint(&r);
+        state->victory = get_byte(&r) != 0;
+        size_t cells = (size_t)size * size;
+        for (size_t c = 0; c < cells; c++) {
+            state->values[c] = (int32_t)get_signed(&r);
+        }
+        for (size_t c = 0; c < cells; c++) {
+            state->chains[c] = (int32_t)get_varint(&r);
+        }
+        state_rehash(state);
+    } else {
+        return true; // type inconnu : ignoré
+    }
+    uint64_t hash = get_u64(&r);
+    state->sequence = sequence;
+    return r.ok && hash == wire_state_hash(state);
+}
+
+// ---------------------------------------------------------------------------
+// Serveur : stdin -> commandes, stdout -> réponses
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    const WireOptions* options;
+    Session session;
+    Broadcast broadcast;
+    Spectator* link;           // la connexion est le spectateur de sa propre partie
+    WireState mirror;          // ce que le client doit avoir après chaque réponse
+    WireBuffer out;
+    WireBuffer payload;
+    int since_full;
+    size_t render_size;        // octets de print_grid() pour le niveau courant, sans couleurs
+    uint64_t commands;
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t render_bytes;
+    uint64_t diffs;
+    uint64_t fulls;
+} WireServer;
+
+static bool write_full(WireServer* s, int status) {
+    WireState* m = &s->mirror;
+    WireBuffer* p = &s->payload;
+    size_t cells = (size_t)m->size * m->size;
+    p->size = 0;
+    bool ok = put_byte(p, (unsigned char)status) && varint_put(p, m->sequence) && varint_put(p, (uint64_t)m->level_number) &&
+              varint_put(p, (uint64_t)m->size) && varint_put(p, (uint64_t)m->head + 1) &&
+              varint_put(p, (uint64_t)m->current_chain) && put_byte(p, m->victory);
+    for (size_t c = 0; ok && c < cells; c++) {
+        ok = varint_put_signed(p, m->values[c]);
+    }
+    for (size_t c = 0; ok && c < cells; c++) {
+        ok = varint_put(p, (uint64_t)m->chains[c]);
+    }
+    s->since_full = 0;
+    s->fulls++;
+    return ok && put_u64(p, wire_state_hash(m)) && put_message(&s->out, WIRE_FULL, p);
+}
+
+static bool write_diff(WireServer* s, const Frame* frame, int status) {
+    WireState* m = &s->mirror;
+    WireBuffer* p = &s->payload;
+    p->size = 0;
+    bool ok = put_byte(p, (unsigned char)status) && varint_put(p, m->sequence) && varint_put(p, (uint64_t)m->head + 1) &&
+              varint_put(p, (uint64_t)m->current_chain) && put_byte(p, m->victory) && varint_put(p, frame->count);
+    int64_t previous = 0;
+    for (uint32_t i = 0; ok && i < frame->count; i++) {
+        ok = varint_put_signed(p, (int64_t)frame->cells[i].cell - previous) &&
+             varint_put(p, (uint64_t)frame->cells[i].chain);
+        previous = frame->cells[i].cell;
+    }
+    s->since_full++;
+    s->diffs++;
+    return ok && put_u64(p, wire_state_hash(m)) && put_message(&s->out, WIRE_DIFF, p);
+}
+
+//répondre par les trames produites par la commande (une image au besoin)
+static bool send_frames(WireServer* s, int status) {
+    WireState* m = &s->mirror;
+    bool ok = true;
+    Frame* frame;
+    while ((frame = spectator_poll(s->link))) {
+        if (frame->kind == FRAME_SNAPSHOT) {
+            size_t cells = (size_t)frame->size * frame->size;
+            ok = ok && state_resize(m, frame->size);
+            if (ok) {
+                memcpy(m->values, frame->values, cells * sizeof(int32_t));
+                memcpy(m->chains, frame->chains, cells * sizeof(int32_t));
+                state_rehash(m);
+            }
+        } else {
+            for (uint32_t i = 0; ok && i < frame->count; i++) {
+                state_set_chain(m, frame->cells[i].cell, frame->cells[i].chain);
+            }
+        }
+        m->sequence = frame->sequence;
+        m->level_number = frame->level_number;
+        m->head = frame->head;
+        m->current_chain = frame->current_chain;
+        m->victory = frame->victory;
+        bool periodic = s->options->snapshot_interval > 0 && s->since_full + 1 >= s->options->snapshot_interval;
+        if (frame->kind == FRAME_SNAPSHOT || periodic) {
+            ok = ok && write_full(s, status);
+        } else {
+            ok = ok && write_diff(s, frame, status);
+        }
+        frame_release(frame);
+    }
+    return ok;
+}
+
+static bool write_ack(WireServer* s, int status) {
+    WireBuffer* p = &s->payload;
+    p->size = 0;
+    return put_byte(p, (unsigned char)status) && varint_put(p, s->mirror.sequence) && put_message(&s->out, WIRE_ACK, p);
+}
+
+//taille de la grille telle que print_grid() l'afficherait, sans les codes de couleur
+static size_t render_size(const Level* level) {
+    size_t bytes = (size_t)level->size; // fins de ligne
+    for (int c = 0; c < level->size * level->size; c++) {
+        int v = level->values[c];
+        bytes += v <= 0 ? 3 : (size_t)snprintf(NULL, 0, " %d ", v);
+    }
+    return bytes;
+}
+
+//charger le niveau number (ou le niveau unique) et l'annoncer par une image
+static bool load_level(WireServer* s, int number) {
+    char filename[256];
+    if (s->options->level_file) {
+        if (number != 1) {
+            return false;
+        }
+        snprintf(filename, sizeof(filename), "%s", s->options->level_file);
+    } else {
+        snprintf(filename, sizeof(filename), "%s/level%d.txt", s->options->level_dir, number);
+    }
+    Level level;
+    char error[160];
+    if (!level_load_file(filename, &level, error, sizeof(error))) {
+        fprintf(stderr, "%s\n", error);
+        return false;
+    }
+    if (!level_validate(&level, error, sizeof(error))) {
+        fprintf(stderr, "Attention : %s\n", error);
+    }
+    Session* session = &s->session;
+    allocate_grids(&session->board, level.size, level.values);
+    s->render_size = render_size(&level);
+    level_free(&level);
+    session->chain_counter = 1;
+    session->current_chain = 0;
+    session->has_started = false;
+    session->last_x = session->last_y = 0;
+    session->start_x = session->start_y = -1;
+    session->level_number = number;
+    session_begin_level(session);
+    broadcast_level(&s->broadcast, session);
+    return true;
+}
+
+static bool is_accepted(SessionStatus status) {
+    return status == SESSION_OK || status == SESSION_VICTORY || status == SESSION_CHAIN_RESUMED;
+}
+
+//exécuter une commande et écrire sa réponse
+static bool handle_command(WireServer* s, const unsigned char* message, size_t size) {
+    static const char directions[4] = {'N', 'S', 'E', 'O'};
+    Session* session = &s->session;
+    WireReader r = {message + 1, message + size, true};
+    get_varint(&r);
+    int status = WIRE_STATUS_BAD_COMMAND;
+    s->commands++;
+    s->render_bytes += s->render_size; // le protocole texte réaffiche la grille après chaque commande
+
+    if (message[0] == WIRE_IMAGE) {
+        return write_full(s, SESSION_OK);
+    }
+    if (message[0] == WIRE_NEXT) {
+        if (!s->mirror.victory || !load_level(s, session->level_number + 1)) {
+            return write_ack(s, WIRE_STATUS_NO_LEVEL);
+        }
+        return send_frames(s, SESSION_OK);
+    }
+
+    int x = 0, y = 0, direction = 0;
+    HistoryCommand command;
+    switch (message[0]) {
+        case WIRE_START: command = HISTORY_START; x = (int)get_varint(&r); y = (int)get_varint(&r); break;
+        case WIRE_SELECT: command = HISTORY_SELECT; x = (int)get_varint(&r); y = (int)get_varint(&r); break;
+        case WIRE_MOVE: command = HISTORY_MOVE; direction = get_byte(&r); break;
+        case WIRE_UNDO: command = HISTORY_UNDO; break;
+        case WIRE_ERASE: command = HISTORY_ERASE; break;
+        case WIRE_RESTART: command = HISTORY_RESTART; break;
+        default: return write_ack(s, status);
+    }
+    if (!r.ok || direction > 3) {
+        return write_ack(s, status);
+    }
+
+    // mêmes règles que play_game() : seul un départ est possible avant la première chaîne
+    broadcast_prepare(&s->broadcast, session, command);
+    if (command == HISTORY_START) {
+        status = session->has_started ? SESSION_BAD_START : session_start(session, x, y);
+    } else if (!session->has_started) {
+        status = command == HISTORY_UNDO ? SESSION_NOTHING_TO_UNDO : SESSION_BAD_MOVE;
+    } else if (command == HISTORY_MOVE) {
+        status = session_move(session, directions[direction]);
+    } else if (command == HISTORY_UNDO) {
+        status = session_undo(session);
+    } else if (command == HISTORY_ERASE) {
+        session_erase(session);
+        status = SESSION_OK;
+    } else if (command == HISTORY_RESTART) {
+        session_restart(session);
+        session_begin_level(session);
+        status = SESSION_OK;
+    } else {
+        status = session_select(session, x, y);
+    }
+    if (!is_accepted((SessionStatus)status)) {
+        return write_ack(s, status);
+    }
+    broadcast_publish(&s->broadcast, session);
+    return send_frames(s, status);
+}
+
+typedef bool (*MessageHandler)(void* context, const unsigned char* message, size_t size);
+
+//lire fd jusqu'à la fin et passer chaque message complet à handler ; idle est appelé
+//quand tout ce qui est arrivé a été traité (avant d'attendre la suite)
+static bool pump(int fd, size_t max_message, MessageHandler handler, void (*idle)(void*), void* context, uint64_t* bytes_in) {
+    WireBuffer in = {0};
+    size_t start = 0;
+    bool ok = true;
+    while (ok) {
+        if (start > 0 && start == in.size) {
+            in.size = start = 0;
+        } else if (start > in.capacity / 2) {
+            memmove(in.bytes, in.bytes + start, in.size - start);
+            in.size -= start;
+            start = 0;
+        }
+        if (!byte_buffer_reserve(&in, WIRE_READ_CHUNK)) {
+            ok = false;
+            break;
+        }
+        long got = read(fd, in.bytes + in.size, WIRE_READ_CHUNK);
+        if (got <= 0) {
+            break;
+        }
+        in.size += (size_t)got;
+        *bytes_in += (uint64_t)got;
+        long size;
+        while (ok && (size = wire_message_size(in.bytes + start, in.size - start)) != 0) {
+            if (size < 0 || (size_t)size > max_message) {
+                ok = false; // flux désynchronisé : la suite ne peut plus être découpée
+                break;
+            }
+            ok = handler(context, in.bytes + start, (size_t)size);
+            start += (size_t)size;
+        }
+        if (idle) {
+            idle(context);
+        }
+    }
+    ok = ok && start == in.size;
+    wire_buffer_free(&in);
+    return ok;
+}
+
+static bool server_message(void* context, const unsigned char* message, size_t size) {
+    WireServer* s = context;
+    bool ok = handle_command(s, message, size);
+    if (ok && s->out.size >= WIRE_READ_CHUNK) {
+        ok = fwrite(s->out.bytes, 1, s->out.size, stdout) == s->out.size;
+        s->bytes_out += s->out.size;
+        s->out.size = 0;
+    }
+    return ok;
+}
+
+//envoyer les réponses en attente d'un seul coup quand le client n'a plus rien envoyé
+static void server_idle(void* context) {
+    WireServer* s = context;
+    fwrite(s->out.bytes, 1, s->out.size, stdout);
+    s->bytes_out += s->out.size;
+    s->out.size = 0;
+    fflush(stdout);
+}
+
+int run_wire_server(const WireOptions* options) {
+    static WireServer server;
+    WireServer* s = &server;
+    s->options = options;
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    broadcast_init(&s->broadcast, 4);
+    if (!load_level(s, 1)) {
+        return 1;
+    }
+    s->link = broadcast_join(&s->broadcast, &s->session);
+    if (!s->link || !send_frames(s, SESSION_OK)) {
+        return 1;
+    }
+    server_idle(s); // l'image du premier niveau part avant la première commande
+
+    bool ok = pump(0, WIRE_MAX_COMMAND, server_message, server_idle, s, &s->bytes_in);
+    server_idle(s);
+    if (!ok) {
+        fprintf(stderr, "Erreur : message invalide, connexion fermee\n");
+    }
+    fprintf(stderr, "%llu commande(s) : %llu octets recus, %llu envoyes (%llu differences, %llu images), "
+            "%.1f octets par commande contre %.0f pour print_grid()\n",
+            (unsigned long long)s->commands, (unsigned long long)s->bytes_in, (unsigned long long)s->bytes_out,
+            (unsigned long long)s->diffs, (unsigned long long)s->fulls,
+            s->commands ? (double)s->bytes_out / s->commands : 0.0,
+            s->commands ? (double)s->render_bytes / s->commands : 0.0);
+
+    broadcast_free(&s->broadcast);
+    wire_state_free(&s->mirror);
+    wire_buffer_free(&s->out);
+    wire_buffer_free(&s->payload);
+    free_grids(&s->session.board);
+    cell_stack_free(&s->session.moves);
+    cell_stack_free(&s->session.heads);
+    return ok ? 0 : 1;
+}
+
+// ---------------------------------------------------------------------------
+// Outils de tube : commandes texte -> binaire, réponses binaires -> texte
+// ---------------------------------------------------------------------------
+
+//traduire les commandes de play_game() (une par ligne) en messages binaires :
+//"x y" départ, N S E O, B annuler, R effacer, X recommencer, "C x y" sélection,
+//I image, P niveau suivant
+int run_wire_encode(void) {
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    WireBuffer out = {0};
+    char line[128];
+    int status = 0;
+    while (fgets(line, sizeof(line), stdin)) {
+        int x, y;
+        char c = 0;
+        bool ok;
+        if (sscanf(line, "%d %d", &x, &y) == 2) {
+            ok = wire_put_command(&out, WIRE_START, x, y);
+        } else if (sscanf(line, " %c %d %d", &c, &x, &y) == 3 && (c == 'C' || c == 'c')) {
+            ok = wire_put_command(&out, WIRE_SELECT, x, y);
+        } else if (sscanf(line, " %c", &c) == 1) {
+            const char* directions = "NSEO";
+            const char* d = strchr(directions, c >= 'a' ? c - 'a' + 'A' : c);
+            switch (c) {
+                case 'B': case 'b': ok = wire_put_command(&out, WIRE_UNDO, 0, 0); break;
+                case 'R': case 'r': ok = wire_put_command(&out, WIRE_ERASE, 0, 0); break;
+                case 'X': case 'x': ok = wire_put_command(&out, WIRE_RESTART, 0, 0); break;
+                case 'I': case 'i': ok = wire_put_command(&out, WIRE_IMAGE, 0, 0); break;
+                case 'P': case 'p': ok = wire_put_command(&out, WIRE_NEXT, 0, 0); break;
+                default:
+                    ok = d != NULL && wire_put_command(&out, WIRE_MOVE, (int)(d - directions), 0);
+                    break;
+            }
+        } else {
+            continue; // ligne vide
+        }
+        if (!ok) {
+            fprintf(stderr, "Commande inconnue : %s", line);
+            status = 1;
+        }
+        if (out.size >= WIRE_READ_CHUNK) {
+            fwrite(out.bytes, 1, out.size, stdout);
+            out.size = 0;
+        }
+    }
+    fwrite(out.bytes, 1, out.size, stdout);
+    wire_buffer_free(&out);
+    return fflush(stdout) == 0 ? status : 1;
+}
+
+static const char* status_name(int status) {
+    static const char* const names[] = {"ok", "victoire", "chaine reprise", "mouvement refuse", "depart refuse",
+                                        "selection refusee", "annulation sur un depart", "rien a annuler",
+                                        "memoire insuffisante"};
+    if (status >= 0 && status < (int)(sizeof(names) / sizeof(names[0]))) {
+        return names[status];
+    }
+    return status == WIRE_STATUS_NO_LEVEL ? "pas de niveau suivant" : "commande invalide";
+}
+
+typedef struct {
+    WireState state;
+    uint64_t messages;
+    uint64_t mismatches;
+} WireDecoder;
+
+static bool decoder_message(void* context, const unsigned char* message, size_t size) {
+    WireDecoder* d = context;
+    WireState* st = &d->state;
+    d->messages++;
+    if (!wire_state_apply(st, message, size)) {
+        d->mismatches++;
+        printf("reponse %llu : empreinte ou sequence incorrecte, image necessaire\n", (unsigned long long)d->messages);
+        return true;
+    }
+    if (message[0] == WIRE_FULL) {
+        printf("image : niveau %d, %dx%d, sequence %llu (%s)\n", st->level_number, st->size, st->size,
+               (unsigned long long)st->sequence, status_name(st->status));
+    } else if (message[0] == WIRE_DIFF) {
+        printf("sequence %llu : %s%s\n", (unsigned long long)st->sequence, status_name(st->status),
+               st->victory ? ", niveau termine" : "");
+    } else if (message[0] == WIRE_ACK) {
+        printf("refus : %s\n", status_name(st->status));
+    }
+    return true;
+}
+
+//lire les réponses du serveur, tenir la grille à jour et vérifier chaque empreinte
+int run_wire_decode(void) {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    WireDecoder decoder;
+    memset(&decoder, 0, sizeof(decoder));
+    uint64_t bytes = 0;
+    bool ok = pump(0, (size_t)-1, decoder_message, NULL, &decoder, &bytes);
+    if (!ok) {
+        printf("Erreur : flux de reponses invalide\n");
+    }
+    size_t covered = 0;
+    for (size_t c = 0; c < (size_t)decoder.state.size * decoder.state.size; c++) {
+        covered += decoder.state.chains[c] != 0;
+    }
+    printf("%llu reponse(s), %llu octets, %llu empreinte(s) incorrecte(s) ; niveau %d, %zu case(s) couverte(s)%s\n",
+           (unsigned long long)decoder.messages, (unsigned long long)bytes, (unsigned long long)decoder.mismatches,
+           decoder.state.level_number, covered, decoder.state.victory ? ", termine" : "");
+    wire_state_free(&decoder.state);
+    return ok && decoder.mismatches == 0 ? 0 : 1;
+}
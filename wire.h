@@ -0,0 +1,88 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "varint.h"
+
+// Protocole binaire d'une partie à distance. Chaque message : un octet de type, la longueur
+// du contenu en entier variable (7 bits par octet), puis le contenu ; un type inconnu est sauté.
+// Les entiers sont des entiers variables, signés en zigzag ; l'empreinte tient sur 8 octets
+// (poids faible d'abord) : le protocole ne dépend pas de l'ordre des octets de la machine.
+//
+// Commandes (client -> serveur) :
+//   'S' x y    départ          'M' d      mouvement (0 N, 1 S, 2 E, 3 O)
+//   'U'        annuler         'E'        effacer la chaîne
+//   'X'        recommencer     'C' x y    sélection d'une chaîne
+//   'I'        image complète  'P'        niveau suivant (après une victoire)
+// Réponses (serveur -> client), une par commande :
+//   'A' statut séquence                                 commande refusée, rien ne change
+//   'D' statut séquence tête+1 chaîne victoire n        cases modifiées : écart à la case
+//       (écart, chaîne)... empreinte                    précédente en zigzag, puis chaîne
+//   'F' statut séquence niveau N tête+1 chaîne          grille entière : nouveau niveau, image
+//       victoire valeurs[N*N] chaînes[N*N] empreinte    demandée, ou périodique (reprise)
+// L'empreinte couvre les chaînes de toutes les cases, la tête et la chaîne courante ; elle est
+// mise à jour case par case des deux côtés, sans reparcourir la grille. Un client dont
+// l'empreinte diffère demande une image ('I').
+
+#define WIRE_HEADER_MAX 11              // type et longueur
+#define WIRE_DEFAULT_SNAPSHOT_INTERVAL 256
+
+typedef enum {
+    WIRE_START = 'S',
+    WIRE_MOVE = 'M',
+    WIRE_UNDO = 'U',
+    WIRE_ERASE = 'E',
+    WIRE_RESTART = 'X',
+    WIRE_SELECT = 'C',
+    WIRE_IMAGE = 'I',
+    WIRE_NEXT = 'P',
+    WIRE_ACK = 'A',
+    WIRE_DIFF = 'D',
+    WIRE_FULL = 'F'
+} WireType;
+
+// Statuts propres au protocole, à la suite de ceux de SessionStatus
+#define WIRE_STATUS_NO_LEVEL 100     // niveau suivant introuvable, ou niveau non gagné
+#define WIRE_STATUS_BAD_COMMAND 101  // commande inconnue ou mal formée
+
+// Grille tenue à jour à partir des réponses (client) ou des trames envoyées (serveur)
+typedef struct {
+    int size;
+    int level_number;
+    uint64_t sequence;
+    int32_t* values;
+    int32_t* chains;
+    uint32_t head;          // NO_CELL avant le premier départ
+    int current_chain;
+    bool victory;
+    uint64_t grid_hash;     // partie de l'empreinte qui couvre les chaînes
+    int status;             // statut de la dernière réponse
+} WireState;
+
+// Écriture d'un message dans un tampon extensible
+typedef ByteBuffer WireBuffer;
+
+bool wire_put_command(WireBuffer* out, WireType type, int a, int b);
+void wire_buffer_free(WireBuffer* buffer);
+
+// Découpage d'un flux : renvoie la taille du message complet en tête de data, 0 s'il manque
+// des octets, et -1 pour un en-tête invalide
+long wire_message_size(const unsigned char* data, size_t size);
+bool wire_state_apply(WireState* state, const unsigned char* message, size_t size);
+uint64_t wire_state_hash(const WireState* state);
+void wire_state_free(WireState* state);
+
+typedef struct {
+    const char* level_file;   // niveau unique, sinon level_dir/levelN.txt à partir de 1
+    const char* level_dir;
+    int snapshot_interval;    // une image complète toutes les N réponses 'D', 0 : jamais
+} WireOptions;
+
+int run_wire_server(const WireOptions* options);
+int run_wire_encode(void);
+int run_wire_decode(void);
+
+#endif